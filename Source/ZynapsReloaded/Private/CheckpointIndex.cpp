@@ -0,0 +1,93 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "CheckpointIndex.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogCheckpointIndex);
+
+// Default constructor
+UCheckpointIndex::UCheckpointIndex() : Super()
+{
+	InitialCheckpoint = nullptr;
+	Cursor = INDEX_NONE;
+}
+
+// Builds the index from the given player starts
+void UCheckpointIndex::Init(const TArray<APlayerStart*>& PlayerStarts, APlayerStart* NewInitialCheckpoint)
+{
+	// Sort the checkpoints using the Y coordinate
+	Checkpoints = PlayerStarts;
+	Checkpoints.Sort([](const APlayerStart& PlayerStart1, const APlayerStart& PlayerStart2)
+	{
+		return PlayerStart1.GetActorLocation().Y < PlayerStart2.GetActorLocation().Y;
+	});
+
+	// Store the locations
+	CheckpointLocations.Reset(Checkpoints.Num());
+	for (APlayerStart* Checkpoint : Checkpoints)
+	{
+		CheckpointLocations.Add(Checkpoint->GetActorLocation().Y);
+	}
+
+	InitialCheckpoint = NewInitialCheckpoint;
+	Cursor = INDEX_NONE;
+	UE_LOG(LogCheckpointIndex, Verbose, TEXT("Checkpoint index built with %d checkpoints"), Checkpoints.Num());
+}
+
+// Moves the cursor to the last checkpoint passed by the camera at the given Y coordinate
+APlayerStart* UCheckpointIndex::Advance(float CameraY)
+{
+	// The camera moved back, relocate the cursor
+	if (Cursor != INDEX_NONE && CameraY <= CheckpointLocations[Cursor])
+	{
+		return Seek(CameraY);
+	}
+
+	// Advance while the camera has passed the next checkpoint. Usually this is a single comparison per frame.
+	while (Cursor + 1 < CheckpointLocations.Num() && CameraY > CheckpointLocations[Cursor + 1])
+	{
+		Cursor++;
+		UE_LOG(LogCheckpointIndex, Verbose, TEXT("Checkpoint %s crossed"), *Checkpoints[Cursor]->GetName());
+		OnCheckpointCrossed.Broadcast(Checkpoints[Cursor]);
+	}
+	return GetCurrentCheckpoint();
+}
+
+// Relocates the cursor with a binary search without notifying the checkpoints crossed
+APlayerStart* UCheckpointIndex::Seek(float CameraY)
+{
+	// Find the first checkpoint not behind the camera. The cursor is placed at the previous one.
+	int32 First = 0;
+	int32 Last = CheckpointLocations.Num();
+	while (First < Last)
+	{
+		int32 Middle = First + (Last - First) / 2;
+		if (CheckpointLocations[Middle] < CameraY)
+		{
+			First = Middle + 1;
+		}
+		else
+		{
+			Last = Middle;
+		}
+	}
+	Cursor = First - 1;
+	return GetCurrentCheckpoint();
+}
+
+// Returns the checkpoint where the player should be respawned
+APlayerStart* UCheckpointIndex::GetCurrentCheckpoint() const
+{
+	if (Cursor == INDEX_NONE)
+	{
+		return InitialCheckpoint;
+	}
+	return Checkpoints[Cursor];
+}
+
+// Returns the number of checkpoints in the index
+int32 UCheckpointIndex::GetNumCheckpoints() const
+{
+	return Checkpoints.Num();
+}
@@ -0,0 +1,371 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "CollisionManager.h"
+#include "StageGameMode.h"
+#include "StageTerrainMap.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogCollisionManager);
+
+// Layers tested against each layer, as bit masks indexed by ECollisionLayer2D
+static const uint8 CollisionLayerMasks[] =
+{
+	// Player
+	(1 << (uint8)ECollisionLayer2D::Pickup) | (1 << (uint8)ECollisionLayer2D::Enemy) |
+		(1 << (uint8)ECollisionLayer2D::EnemyProjectile),
+	// PlayerProjectile
+	(1 << (uint8)ECollisionLayer2D::Enemy),
+	// Pickup
+	(1 << (uint8)ECollisionLayer2D::Player),
+	// Enemy
+	(1 << (uint8)ECollisionLayer2D::Player) | (1 << (uint8)ECollisionLayer2D::PlayerProjectile),
+	// EnemyProjectile
+	(1 << (uint8)ECollisionLayer2D::Player)
+};
+
+// Layers tested against the terrain map, as a bit mask indexed by ECollisionLayer2D
+static const uint8 TerrainCollisionMask =
+	(1 << (uint8)ECollisionLayer2D::Player) | (1 << (uint8)ECollisionLayer2D::PlayerProjectile);
+
+// Sets default values
+ACollisionManager::ACollisionManager() : Super()
+{
+	// Tick once per frame after the actors have been moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Init grid vars
+	CellSize = DefaultSpatialHashCellSize;
+}
+
+// Called every frame
+void ACollisionManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsCollision);
+
+	Super::Tick(DeltaSeconds);
+
+	// Drop the bodies destroyed without being unregistered
+	for (int32 Index = Bodies.Num() - 1; Index >= 0; Index--)
+	{
+		if (!Bodies[Index].Actor.IsValid())
+		{
+			RemoveAt(Index);
+		}
+	}
+
+	// Broadphase: insert the bodies which can collide into the grid
+	if (Grid.GetCellSize() != CellSize)
+	{
+		Grid.SetCellSize(CellSize);
+	}
+	Grid.Reset();
+	for (int32 Index = 0; Index < Bodies.Num(); Index++)
+	{
+		FCollisionBody2D& Body = Bodies[Index];
+		Body.bActive = UpdateBodyShape(Body);
+		if (Body.bActive)
+		{
+			FBox2D Bounds(Body.SegmentStart, Body.SegmentStart);
+			Bounds += Body.SegmentEnd;
+			Grid.Insert(Index, Bounds.ExpandBy(Body.Radius));
+		}
+	}
+
+	// Narrowphase: test each body against the nearby bodies of the layers it interacts with. Every pair is
+	// tested once by only taking candidates with a higher index.
+	CurrentPairs.Reset();
+	NewPairs.Reset();
+	for (int32 Index = 0; Index < Bodies.Num(); Index++)
+	{
+		const FCollisionBody2D& Body = Bodies[Index];
+		if (!Body.bActive)
+		{
+			continue;
+		}
+
+		FBox2D Bounds(Body.SegmentStart, Body.SegmentStart);
+		Bounds += Body.SegmentEnd;
+		Candidates.Reset();
+		Grid.Query(Bounds.ExpandBy(Body.Radius), Candidates);
+		for (int32 CandidateIndex : Candidates)
+		{
+			const FCollisionBody2D& Candidate = Bodies[CandidateIndex];
+			if (CandidateIndex <= Index || !CanCollide(Body.Layer, Candidate.Layer) ||
+				!AreOverlapping(Body, Candidate))
+			{
+				continue;
+			}
+
+			// Only the pairs which weren't overlapping in the previous pass are notified
+			TPair<AActor*, AActor*> Pair = Body.Key < Candidate.Key ?
+				TPair<AActor*, AActor*>(Body.Key, Candidate.Key) : TPair<AActor*, AActor*>(Candidate.Key, Body.Key);
+			CurrentPairs.Add(Pair);
+			if (!OverlappingPairs.Contains(Pair))
+			{
+				FCollisionPair2D NewPair;
+				NewPair.First = Body;
+				NewPair.Second = Candidate;
+				NewPairs.Add(NewPair);
+			}
+		}
+	}
+	Swap(OverlappingPairs, CurrentPairs);
+
+	// Notify the new overlaps once the pass is complete, so the callbacks can safely register, unregister or
+	// destroy actors. Each callback checks that both actors are still alive.
+	for (FCollisionPair2D& NewPair : NewPairs)
+	{
+		AActor* First = NewPair.First.Actor.Get();
+		AActor* Second = NewPair.Second.Actor.Get();
+		if (First && Second && !First->IsPendingKill() && !Second->IsPendingKill())
+		{
+			NewPair.First.OnOverlap.ExecuteIfBound(Second, NewPair.Second.Shape.Get());
+		}
+
+		First = NewPair.First.Actor.Get();
+		Second = NewPair.Second.Actor.Get();
+		if (First && Second && !First->IsPendingKill() && !Second->IsPendingKill())
+		{
+			NewPair.Second.OnOverlap.ExecuteIfBound(First, NewPair.First.Shape.Get());
+		}
+	}
+	NewPairs.Reset();
+
+	CollideTerrain();
+}
+
+// Returns the collision manager of the specified world or nullptr if the game mode doesn't provide one
+ACollisionManager* ACollisionManager::GetCollisionManager(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetCollisionManager();
+}
+
+// Registers an actor using the given component as its shape
+void ACollisionManager::Register(AActor* Actor, UPrimitiveComponent* Shape, ECollisionLayer2D Layer,
+	FOnBodyOverlap OnOverlap)
+{
+	if (!Actor || !Shape)
+	{
+		UE_LOG(LogCollisionManager, Warning, TEXT("Tried to register a body without an actor or a shape"));
+		return;
+	}
+
+	FCollisionBody2D Body;
+	Body.Actor = Actor;
+	Body.Key = Actor;
+	Body.Shape = Shape;
+	Body.Layer = Layer;
+	Body.OnOverlap = OnOverlap;
+	Body.SegmentStart = Body.SegmentEnd = FVector2D::ZeroVector;
+	Body.Radius = 0.0f;
+	Body.bActive = false;
+
+	int32* ExistingIndex = BodyIndices.Find(Actor);
+	if (ExistingIndex)
+	{
+		// Already registered, just refresh the entry
+		Bodies[*ExistingIndex] = Body;
+		return;
+	}
+	BodyIndices.Add(Actor, Bodies.Add(Body));
+}
+
+// Unregisters an actor
+void ACollisionManager::Unregister(AActor* Actor)
+{
+	int32* Index = BodyIndices.Find(Actor);
+	if (Index)
+	{
+		RemoveAt(*Index);
+	}
+}
+
+// Appends to the output array the bodies which overlap a circle and can collide with the given layer
+void ACollisionManager::OverlapCircle(const FVector2D& Center, float Radius, ECollisionLayer2D Layer,
+	TArray<FCollisionOverlap2D>& OutOverlaps)
+{
+	FCollisionBody2D Circle;
+	Circle.SegmentStart = Circle.SegmentEnd = Center;
+	Circle.Radius = Radius;
+
+	// The grid holds the indices of the last pass. Bodies unregistered since then may have been moved to another
+	// index, so the candidates are checked against the current entries.
+	QueryCandidates.Reset();
+	Grid.Query(Center, Radius, QueryCandidates);
+	for (int32 CandidateIndex : QueryCandidates)
+	{
+		if (!Bodies.IsValidIndex(CandidateIndex))
+		{
+			continue;
+		}
+
+		const FCollisionBody2D& Candidate = Bodies[CandidateIndex];
+		AActor* Actor = Candidate.Actor.Get();
+		if (!Candidate.bActive || !Actor || Actor->IsPendingKill() || !Actor->GetActorEnableCollision() ||
+			!CanCollide(Layer, Candidate.Layer) || !AreOverlapping(Circle, Candidate))
+		{
+			continue;
+		}
+
+		FCollisionOverlap2D Overlap;
+		Overlap.Actor = Actor;
+		Overlap.Shape = Candidate.Shape.Get();
+		Overlap.Layer = Candidate.Layer;
+		OutOverlaps.Add(Overlap);
+	}
+}
+
+// Notifies a registered actor that it began overlapping with an object found by a query
+void ACollisionManager::NotifyOverlap(AActor* Actor, AActor* OtherActor, UPrimitiveComponent* OtherComp)
+{
+	int32* Index = BodyIndices.Find(Actor);
+	if (Index)
+	{
+		// Copy the delegate, since the callback may unregister the actor
+		FOnBodyOverlap OnOverlap = Bodies[*Index].OnOverlap;
+		OnOverlap.ExecuteIfBound(OtherActor, OtherComp);
+	}
+}
+
+// Returns the number of registered bodies
+int32 ACollisionManager::GetNumRegistered() const
+{
+	return Bodies.Num();
+}
+
+// Returns whether bodies of the given layers are tested against each other
+bool ACollisionManager::CanCollide(ECollisionLayer2D LayerA, ECollisionLayer2D LayerB)
+{
+	return (CollisionLayerMasks[(uint8)LayerA] & (1 << (uint8)LayerB)) != 0;
+}
+
+// Returns whether bodies of the given layer are tested against the terrain map of the stage
+bool ACollisionManager::CollidesWithTerrain(ECollisionLayer2D Layer)
+{
+	return (TerrainCollisionMask & (1 << (uint8)Layer)) != 0;
+}
+
+// Tests the active bodies against the terrain map of the stage and notifies the new overlaps
+void ACollisionManager::CollideTerrain()
+{
+	UStageTerrainMap* TerrainMap = UStageTerrainMap::GetStageTerrainMap(GetWorld());
+	if (!TerrainMap)
+	{
+		return;
+	}
+
+	// Only the bodies which weren't overlapping the scenery in the previous pass are notified
+	CurrentTerrainContacts.Reset();
+	for (const FCollisionBody2D& Body : Bodies)
+	{
+		if (Body.bActive && CollidesWithTerrain(Body.Layer) &&
+			TerrainMap->OverlapsCapsule(Body.SegmentStart, Body.SegmentEnd, Body.Radius))
+		{
+			CurrentTerrainContacts.Add(Body.Key);
+			if (!TerrainContacts.Contains(Body.Key))
+			{
+				NewTerrainContacts.Add(Body);
+			}
+		}
+	}
+	Swap(TerrainContacts, CurrentTerrainContacts);
+
+	// The scenery has no actor of its own, so the world settings of the stage stand for it
+	AActor* Terrain = GetWorld()->GetWorldSettings();
+	for (FCollisionBody2D& Body : NewTerrainContacts)
+	{
+		AActor* Actor = Body.Actor.Get();
+		if (Actor && !Actor->IsPendingKill())
+		{
+			Body.OnOverlap.ExecuteIfBound(Terrain, nullptr);
+		}
+	}
+	NewTerrainContacts.Reset();
+}
+
+// Updates the shape of a body in the gameplay plane. Returns false if the body can't collide.
+bool ACollisionManager::UpdateBodyShape(FCollisionBody2D& Body)
+{
+	AActor* Actor = Body.Actor.Get();
+	UPrimitiveComponent* Shape = Body.Shape.Get();
+	if (!Actor || !Shape || !Actor->GetActorEnableCollision() || !Shape->IsCollisionEnabled())
+	{
+		return false;
+	}
+
+	// Project the shape onto the YZ plane
+	UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Shape);
+	USphereComponent* Sphere = Cast<USphereComponent>(Shape);
+	if (Capsule)
+	{
+		const FVector Center = Capsule->GetComponentLocation();
+		const FVector HalfSegment = Capsule->GetUpVector() * Capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+		Body.SegmentStart = FVector2D(Center.Y - HalfSegment.Y, Center.Z - HalfSegment.Z);
+		Body.SegmentEnd = FVector2D(Center.Y + HalfSegment.Y, Center.Z + HalfSegment.Z);
+		Body.Radius = Capsule->GetScaledCapsuleRadius();
+	}
+	else if (Sphere)
+	{
+		const FVector Center = Sphere->GetComponentLocation();
+		Body.SegmentStart = Body.SegmentEnd = FVector2D(Center.Y, Center.Z);
+		Body.Radius = Sphere->GetScaledSphereRadius();
+	}
+	else
+	{
+		const FBoxSphereBounds& Bounds = Shape->Bounds;
+		Body.SegmentStart = Body.SegmentEnd = FVector2D(Bounds.Origin.Y, Bounds.Origin.Z);
+		Body.Radius = Bounds.SphereRadius;
+	}
+	return true;
+}
+
+// Checks whether two bodies overlap
+bool ACollisionManager::AreOverlapping(const FCollisionBody2D& BodyA, const FCollisionBody2D& BodyB)
+{
+	const float RadiusSum = BodyA.Radius + BodyB.Radius;
+
+	// Circle against circle
+	if (BodyA.SegmentStart == BodyA.SegmentEnd && BodyB.SegmentStart == BodyB.SegmentEnd)
+	{
+		return FVector2D::DistSquared(BodyA.SegmentStart, BodyB.SegmentStart) <= RadiusSum * RadiusSum;
+	}
+
+	// Capsules are checked using the distance between their segments
+	FVector ClosestA;
+	FVector ClosestB;
+	FMath::SegmentDistToSegmentSafe(
+		FVector(0.0f, BodyA.SegmentStart.X, BodyA.SegmentStart.Y),
+		FVector(0.0f, BodyA.SegmentEnd.X, BodyA.SegmentEnd.Y),
+		FVector(0.0f, BodyB.SegmentStart.X, BodyB.SegmentStart.Y),
+		FVector(0.0f, BodyB.SegmentEnd.X, BodyB.SegmentEnd.Y),
+		ClosestA, ClosestB);
+	return FVector::DistSquared(ClosestA, ClosestB) <= RadiusSum * RadiusSum;
+}
+
+// Removes the entry at the given index keeping the index lookup consistent
+void ACollisionManager::RemoveAt(int32 Index)
+{
+	BodyIndices.Remove(Bodies[Index].Key);
+
+	// Fill the gap with the last entry and update its index
+	int32 LastIndex = Bodies.Num() - 1;
+	if (Index != LastIndex)
+	{
+		BodyIndices.Add(Bodies[LastIndex].Key, Index);
+	}
+	Bodies.RemoveAtSwap(Index, 1, false);
+}
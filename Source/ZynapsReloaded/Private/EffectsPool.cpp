@@ -0,0 +1,182 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "EffectsPool.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogEffectsPool);
+
+// Sets default values
+AEffectsPool::AEffectsPool() : Super()
+{
+	// The pool is notified when the effects finish, so it doesn't need to tick
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+// Called when the actor is removed from the level
+void AEffectsPool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the usage counters to help sizing the budgets
+	for (const TPair<UParticleSystem*, FEffectsPoolEntry>& Pair : Entries)
+	{
+		const FEffectsPoolStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogEffectsPool, Verbose,
+			TEXT("Pool for %s: capacity %d, budget %d, high-water mark %d, hits %d, misses %d, steals %d"),
+			*GetNameSafe(Pair.Key), Stats.Capacity, Stats.Budget, Stats.HighWaterMark, Stats.Hits, Stats.Misses,
+			Stats.Steals);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Returns the effects pool of the specified world or nullptr if the game mode doesn't provide one
+AEffectsPool* AEffectsPool::GetEffectsPool(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetEffectsPool();
+}
+
+// Creates components for the given particle system until the pool holds at least the specified capacity
+void AEffectsPool::Prewarm(UParticleSystem* Template, int32 Capacity, int32 Budget)
+{
+	if (!Template)
+	{
+		UE_LOG(LogEffectsPool, Warning, TEXT("Tried to pre-warm the pool without a particle system"));
+		return;
+	}
+
+	FEffectsPoolEntry& Entry = Entries.FindOrAdd(Template);
+	Entry.Stats.Capacity = FMath::Max(Entry.Stats.Capacity, Capacity);
+	Entry.Stats.Budget = FMath::Max3(Entry.Stats.Budget, Budget, Entry.Stats.Capacity);
+	while (Entry.FreeComponents.Num() + Entry.ActiveComponents.Num() < Entry.Stats.Capacity)
+	{
+		UParticleSystemComponent* Component = CreateComponent(Template);
+		if (!Component)
+		{
+			UE_LOG(LogEffectsPool, Error, TEXT("Failed to create a component for %s"), *Template->GetName());
+			return;
+		}
+		Entry.FreeComponents.Add(Component);
+	}
+	UE_LOG(LogEffectsPool, Verbose, TEXT("Pool for %s pre-warmed with %d components"), *Template->GetName(),
+		Entry.Stats.Capacity);
+}
+
+// Plays the given particle system at the given transform using a pooled component
+UParticleSystemComponent* AEffectsPool::SpawnEffect(UParticleSystem* Template, const FTransform& Transform)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsEffects);
+
+	if (!Template)
+	{
+		UE_LOG(LogEffectsPool, Warning, TEXT("Tried to spawn an effect without a particle system"));
+		return nullptr;
+	}
+
+	// Take a free component, create a new one while the budget allows it or restart the oldest effect
+	FEffectsPoolEntry* Entry = Entries.Find(Template);
+	if (!Entry)
+	{
+		Prewarm(Template, DefaultEffectsPoolCapacity, DefaultEffectsPoolBudget);
+		Entry = Entries.Find(Template);
+	}
+	UParticleSystemComponent* Component = nullptr;
+	while (!Component && Entry->FreeComponents.Num() > 0)
+	{
+		// Skip components destroyed by other means while they were in the pool
+		Component = Entry->FreeComponents.Pop(false);
+		if (Component && Component->IsPendingKill())
+		{
+			Component = nullptr;
+		}
+	}
+	if (Component)
+	{
+		Entry->Stats.Hits++;
+	}
+	else if (Entry->ActiveComponents.Num() < Entry->Stats.Budget || Entry->ActiveComponents.Num() == 0)
+	{
+		Entry->Stats.Misses++;
+		Component = CreateComponent(Template);
+		if (!Component)
+		{
+			UE_LOG(LogEffectsPool, Error, TEXT("Failed to create a component for %s"), *Template->GetName());
+			return nullptr;
+		}
+		UE_LOG(LogEffectsPool, Verbose, TEXT("Pool for %s exhausted, %d effects playing"), *Template->GetName(),
+			Entry->ActiveComponents.Num() + 1);
+	}
+	else
+	{
+		Entry->Stats.Steals++;
+		Component = Entry->ActiveComponents[0];
+		Entry->ActiveComponents.RemoveAt(0, 1, false);
+	}
+
+	// Reset the effect and play it at the new location. The component is tracked as active afterwards, so a
+	// finish notification raised by the reset is ignored.
+	Component->SetWorldTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	Component->SetHiddenInGame(false);
+	Component->Activate(true);
+	Entry->ActiveComponents.Add(Component);
+	Entry->Stats.InUse = Entry->ActiveComponents.Num();
+	Entry->Stats.HighWaterMark = FMath::Max(Entry->Stats.HighWaterMark, Entry->Stats.InUse);
+	return Component;
+}
+
+// Returns the usage counters for the given particle system
+FEffectsPoolStats AEffectsPool::GetStats(UParticleSystem* Template) const
+{
+	const FEffectsPoolEntry* Entry = Template ? Entries.Find(Template) : nullptr;
+	return Entry ? Entry->Stats : FEffectsPoolStats();
+}
+
+// Creates a new component owned by the pool. It is returned inactive.
+UParticleSystemComponent* AEffectsPool::CreateComponent(UParticleSystem* Template)
+{
+	// Same setup as UGameplayStatics::SpawnEmitterAtLocation, but the component is kept after the effect ends
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(this);
+	if (!Component)
+	{
+		return nullptr;
+	}
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->bAllowAnyoneToDestroyMe = false;
+	Component->SecondsBeforeInactive = 0.0f;
+	Component->SetAbsolute(true, true, true);
+	Component->SetTemplate(Template);
+	Component->OnSystemFinished.AddDynamic(this, &AEffectsPool::EffectFinished);
+	Component->RegisterComponentWithWorld(GetWorld());
+	return Component;
+}
+
+// Called when a pooled component finishes its effect
+void AEffectsPool::EffectFinished(UParticleSystemComponent* Component)
+{
+	FEffectsPoolEntry* Entry = Component ? Entries.Find(Component->Template) : nullptr;
+	if (!Entry)
+	{
+		return;
+	}
+
+	// Only the components playing an effect go back to the free list
+	if (Entry->ActiveComponents.Remove(Component) > 0)
+	{
+		Component->SetHiddenInGame(true);
+		Entry->FreeComponents.Add(Component);
+		Entry->Stats.InUse = Entry->ActiveComponents.Num();
+	}
+}
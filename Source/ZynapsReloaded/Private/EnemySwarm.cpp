@@ -0,0 +1,602 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "EnemySwarm.h"
+#include "EffectsPool.h"
+#include "ProjectionUtil.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsWorldSettings.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogEnemySwarm);
+
+// Sets default values
+AEnemySwarm::AEnemySwarm() : Super()
+{
+	// Tick after the collision manager, so the queries use the bodies of the current frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Assets streamed in by the stage asset preloader. The mesh is a placeholder to be replaced in a blueprint.
+	EnemyMesh = FSoftObjectPath(TEXT("StaticMesh'/Engine/BasicShapes/Sphere.Sphere'"));
+	ExplosionTemplate = FSoftObjectPath(TEXT("ParticleSystem'/Game/Models/Explosion/ExplosionSystem.ExplosionSystem'"));
+	ExplosionPartSystem = nullptr;
+
+	// Init enemy vars
+	EnemyRotation = FRotator::ZeroRotator;
+	EnemyScale = FVector(0.8f);
+	EnemyRadius = 40.0f;
+	EnemyHitPoints = 1;
+	EnemyScore = 100;
+	ProjectileDamage = 1;
+	Capacity = DefaultEnemySwarmCapacity;
+	SpawnMargin = 200.0f;
+	CullMargin = 400.0f;
+	ExplosionPoolCapacity = 8;
+	ExplosionPoolBudget = 16;
+
+	// Init wave vars
+	NextEnemyId = 1;
+	NextWave = 0;
+	bRewindWaves = false;
+}
+
+// Called when the game starts or when spawned
+void AEnemySwarm::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Get the waves of the stage
+	AZynapsWorldSettings* WorldSettings = AZynapsWorldSettings::GetZynapsWorldSettings(GetWorld());
+	if (WorldSettings)
+	{
+		Waves = WorldSettings->EnemyWaves;
+	}
+	Waves.Sort([](const FEnemyWave& A, const FEnemyWave& B)
+	{
+		return A.TriggerY < B.TriggerY;
+	});
+	UE_LOG(LogEnemySwarm, Verbose, TEXT("%d enemy waves found in the stage"), Waves.Num());
+
+	// Allocate room for the enemies and their instances, so the swarm doesn't allocate while playing
+	EnemyIds.Reserve(Capacity);
+	EnemyIndices.Reserve(Capacity);
+	PositionsY.Reserve(Capacity);
+	PositionsZ.Reserve(Capacity);
+	VelocitiesY.Reserve(Capacity);
+	VelocitiesZ.Reserve(Capacity);
+	HitPoints.Reserve(Capacity);
+	PatternIds.Reserve(Capacity);
+	Ages.Reserve(Capacity);
+	BaseZ.Reserve(Capacity);
+	Amplitudes.Reserve(Capacity);
+	AngularFrequencies.Reserve(Capacity);
+	ReserveInstances(Capacity);
+
+	// The overlaps with the player and the projectiles are taken from the pass of the collision manager
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (CollisionManager)
+	{
+		AddTickPrerequisiteActor(CollisionManager);
+	}
+	else
+	{
+		UE_LOG(LogEnemySwarm, Warning, TEXT("No collision manager available. The enemies won't collide"));
+	}
+}
+
+// Called when the actor is removed from the level
+void AEnemySwarm::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the counters to help sizing the capacity
+	UE_LOG(LogEnemySwarm, Verbose,
+		TEXT("Enemy swarm: capacity %d, high-water mark %d, spawned %d, destroyed %d, escaped %d"), Capacity,
+		Stats.HighWaterMark, Stats.Spawned, Stats.Destroyed, Stats.Escaped);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void AEnemySwarm::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsEnemies);
+
+	Super::Tick(DeltaSeconds);
+
+	// Get the viewport bounds
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
+	AZynapsWorldSettings* WorldSettings = WorldContext ? WorldContext->GetWorldSettings() : nullptr;
+	AZynapsGameState* GameState = WorldContext ? WorldContext->GetGameState() : nullptr;
+	if (!PlayerController || !WorldSettings || !GameState)
+	{
+		return;
+	}
+	FVector TopLeftBound;
+	FVector BottomRightBound;
+	if (!UProjectionUtil::GetCachedViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
+	{
+		UE_LOG(LogEnemySwarm, Error, TEXT("Failed to calculate the viewport bounds"));
+		return;
+	}
+
+	// Skip the waves left behind by the camera, i.e. after respawning at a checkpoint
+	if (bRewindWaves)
+	{
+		NextWave = 0;
+		while (NextWave < Waves.Num() && Waves[NextWave].TriggerY <= BottomRightBound.Y)
+		{
+			NextWave++;
+		}
+		bRewindWaves = false;
+	}
+
+	// New waves only enter the screen while playing
+	if (GameState->GetCurrentState() == EStageState::Playing)
+	{
+		SpawnWaves(BottomRightBound.Y);
+	}
+
+	// The chasing enemies follow the player or keep to the middle of the screen if there is none
+	APlayerPawn* PlayerPawn = WorldContext->GetPlayerPawn();
+	const float PlayerZ = PlayerPawn ? PlayerPawn->GetActorLocation().Z : (TopLeftBound.Z + BottomRightBound.Z) / 2;
+	MoveEnemies(DeltaSeconds, WorldSettings->ScrollSpeed, PlayerZ);
+	CollideEnemies();
+
+	// The enemies are spawned beyond the right edge, so they are only removed beyond the other edges
+	const FBox2D CullBounds(FVector2D(TopLeftBound.Y - CullMargin, BottomRightBound.Z - CullMargin),
+		FVector2D(BIG_NUMBER, TopLeftBound.Z + CullMargin));
+	RemoveEnemies(CullBounds);
+	UpdateInstances();
+}
+
+// Returns the enemy swarm of the specified world or nullptr if the game mode doesn't provide one
+AEnemySwarm* AEnemySwarm::GetEnemySwarm(UWorld* World)
+{
+	AStageGameMode* GameMode = GetStageGameMode(World);
+	return GameMode ? GameMode->GetEnemySwarm() : nullptr;
+}
+
+// Returns the soft references to the assets of the swarm
+void AEnemySwarm::GetPreloadAssets(TArray<FSoftObjectPath>& Assets) const
+{
+	Super::GetPreloadAssets(Assets);
+	Assets.Add(ExplosionTemplate.ToSoftObjectPath());
+}
+
+// Removes all the enemies and rewinds the waves to the current camera location
+void AEnemySwarm::ClearEnemies()
+{
+	EnemyIds.Reset();
+	EnemyIndices.Reset();
+	PositionsY.Reset();
+	PositionsZ.Reset();
+	VelocitiesY.Reset();
+	VelocitiesZ.Reset();
+	HitPoints.Reset();
+	PatternIds.Reset();
+	Ages.Reset();
+	BaseZ.Reset();
+	Amplitudes.Reset();
+	AngularFrequencies.Reset();
+	Stats.LiveEnemies = 0;
+	SET_DWORD_STAT(STAT_ZynapsLiveEnemies, 0);
+
+	// The camera may be moved before the next tick, so the waves are rewound then
+	bRewindWaves = true;
+	UpdateInstances();
+}
+
+// Returns the number of enemies, including the ones destroyed during the current frame
+int32 AEnemySwarm::GetNumEnemies() const
+{
+	return PositionsY.Num();
+}
+
+// Returns the activity of the swarm during the stage
+FEnemySwarmStats AEnemySwarm::GetStats() const
+{
+	return Stats;
+}
+
+// Appends to the output array the live enemies which overlap a circle
+void AEnemySwarm::QueryEnemies(const FVector2D& Center, float Radius, TArray<int32>& OutEnemies) const
+{
+	// Query the grid into the output array and keep only the enemies which actually overlap the circle
+	const int32 FirstCandidate = OutEnemies.Num();
+	Grid.Query(Center, Radius, OutEnemies);
+	const float RadiusSum = Radius + EnemyRadius;
+	int32 NumFound = FirstCandidate;
+	for (int32 Index = FirstCandidate; Index < OutEnemies.Num(); Index++)
+	{
+		const int32 Enemy = OutEnemies[Index];
+		const float DeltaY = PositionsY[Enemy] - Center.X;
+		const float DeltaZ = PositionsZ[Enemy] - Center.Y;
+		if (HitPoints[Enemy] > 0 && DeltaY * DeltaY + DeltaZ * DeltaZ <= RadiusSum * RadiusSum)
+		{
+			OutEnemies[NumFound++] = Enemy;
+		}
+	}
+	OutEnemies.SetNum(NumFound, false);
+}
+
+// Appends to the output array the live enemies which overlap a box
+void AEnemySwarm::QueryEnemies(const FBox2D& Bounds, TArray<int32>& OutEnemies) const
+{
+	// Query the grid into the output array and keep only the enemies which actually overlap the box
+	const int32 FirstCandidate = OutEnemies.Num();
+	Grid.Query(Bounds, OutEnemies);
+	int32 NumFound = FirstCandidate;
+	for (int32 Index = FirstCandidate; Index < OutEnemies.Num(); Index++)
+	{
+		const int32 Enemy = OutEnemies[Index];
+		const float DeltaY = PositionsY[Enemy] - FMath::Clamp(PositionsY[Enemy], Bounds.Min.X, Bounds.Max.X);
+		const float DeltaZ = PositionsZ[Enemy] - FMath::Clamp(PositionsZ[Enemy], Bounds.Min.Y, Bounds.Max.Y);
+		if (HitPoints[Enemy] > 0 && DeltaY * DeltaY + DeltaZ * DeltaZ <= EnemyRadius * EnemyRadius)
+		{
+			OutEnemies[NumFound++] = Enemy;
+		}
+	}
+	OutEnemies.SetNum(NumFound, false);
+}
+
+// Finds the nearest live enemy to each location within the given distance
+void AEnemySwarm::FindNearestEnemies(const TArray<FVector2D>& Locations, float MaxDistance,
+	TArray<int32>& OutEnemies) const
+{
+	OutEnemies.SetNumUninitialized(Locations.Num(), false);
+	for (int32 Index = 0; Index < Locations.Num(); Index++)
+	{
+		const FVector2D& Location = Locations[Index];
+		OutEnemies[Index] = INDEX_NONE;
+
+		// Search rings of growing radius, so a close enemy is found without visiting the cells of the whole
+		// distance. An enemy found within a ring is the nearest one, since any other enemy in the next rings is
+		// further away.
+		float BestDistSquared = MaxDistance * MaxDistance;
+		for (float Radius = FMath::Min(Grid.GetCellSize(), MaxDistance); OutEnemies[Index] == INDEX_NONE;
+			Radius = FMath::Min(Radius * 2.0f, MaxDistance))
+		{
+			NearestCandidates.Reset();
+			Grid.Query(Location, Radius, NearestCandidates);
+			for (int32 Enemy : NearestCandidates)
+			{
+				const float DistSquared = FVector2D::DistSquared(Location, GetEnemyLocation(Enemy));
+				if (HitPoints[Enemy] > 0 && DistSquared <= Radius * Radius && DistSquared <= BestDistSquared)
+				{
+					BestDistSquared = DistSquared;
+					OutEnemies[Index] = Enemy;
+				}
+			}
+			if (Radius >= MaxDistance)
+			{
+				break;
+			}
+		}
+	}
+}
+
+// Finds the first live enemy touched by each segment swept with the given radius
+void AEnemySwarm::SweepEnemies(const TArray<FVector2D>& Starts, const TArray<FVector2D>& Ends, float Radius,
+	TArray<int32>& OutEnemies, TArray<float>& OutFractions) const
+{
+	OutEnemies.SetNumUninitialized(Starts.Num(), false);
+	OutFractions.SetNumUninitialized(Starts.Num(), false);
+	const float RadiusSum = Radius + EnemyRadius;
+	for (int32 Index = 0; Index < Starts.Num(); Index++)
+	{
+		const FVector2D& Start = Starts[Index];
+		const FVector2D Delta = Ends[Index] - Start;
+		OutEnemies[Index] = INDEX_NONE;
+		OutFractions[Index] = 1.0f;
+
+		// The grid returns the enemies around the box of the segment. The first contact of each one is the first
+		// root of the distance from the moving point to its center being the sum of the radii.
+		FBox2D Bounds(ForceInit);
+		Bounds += Start;
+		Bounds += Ends[Index];
+		NearestCandidates.Reset();
+		Grid.Query(Bounds.ExpandBy(Radius), NearestCandidates);
+		const float A = Delta.SizeSquared();
+		for (int32 Enemy : NearestCandidates)
+		{
+			if (HitPoints[Enemy] <= 0)
+			{
+				continue;
+			}
+
+			const FVector2D Offset = Start - GetEnemyLocation(Enemy);
+			const float C = Offset.SizeSquared() - RadiusSum * RadiusSum;
+			float Fraction = 0.0f;
+			if (C > 0.0f)
+			{
+				const float B = FVector2D::DotProduct(Offset, Delta);
+				const float Discriminant = B * B - A * C;
+				if (B >= 0.0f || Discriminant < 0.0f || A < SMALL_NUMBER)
+				{
+					continue;
+				}
+				Fraction = (-B - FMath::Sqrt(Discriminant)) / A;
+			}
+			if (Fraction <= OutFractions[Index])
+			{
+				OutEnemies[Index] = Enemy;
+				OutFractions[Index] = Fraction;
+			}
+		}
+	}
+}
+
+// Returns the location of an enemy in the gameplay plane
+FVector2D AEnemySwarm::GetEnemyLocation(int32 Enemy) const
+{
+	return FVector2D(PositionsY[Enemy], PositionsZ[Enemy]);
+}
+
+// Returns the identifier of an enemy
+uint32 AEnemySwarm::GetEnemyId(int32 Enemy) const
+{
+	return EnemyIds[Enemy];
+}
+
+// Returns the index of the enemy with the given identifier or INDEX_NONE if it is not alive
+int32 AEnemySwarm::FindEnemy(uint32 EnemyId) const
+{
+	const int32* Enemy = EnemyIndices.Find(EnemyId);
+	return Enemy && HitPoints[*Enemy] > 0 ? *Enemy : INDEX_NONE;
+}
+
+// Returns whether an enemy is still alive
+bool AEnemySwarm::IsEnemyAlive(int32 Enemy) const
+{
+	return HitPoints.IsValidIndex(Enemy) && HitPoints[Enemy] > 0;
+}
+
+// Damages an enemy, destroying it when it runs out of hit points. Returns whether it was destroyed.
+bool AEnemySwarm::DamageEnemy(int32 Enemy, int32 Damage)
+{
+	if (!IsEnemyAlive(Enemy))
+	{
+		return false;
+	}
+
+	HitPoints[Enemy] -= Damage;
+	if (HitPoints[Enemy] > 0)
+	{
+		return false;
+	}
+
+	// The enemy is kept until the next removal, so the indices stay valid during the frame
+	HitPoints[Enemy] = 0;
+	Stats.Destroyed++;
+
+	// Score the enemy
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	AZynapsPlayerState* PlayerState = WorldContext ? WorldContext->GetPlayerState() : nullptr;
+	if (PlayerState)
+	{
+		PlayerState->IncreaseGameScore(EnemyScore);
+	}
+
+	// Play the explosion
+	if (ExplosionPartSystem)
+	{
+		const FTransform Transform(FVector(0.0f, PositionsY[Enemy], PositionsZ[Enemy]));
+		AEffectsPool* EffectsPool = AEffectsPool::GetEffectsPool(GetWorld());
+		if (EffectsPool)
+		{
+			EffectsPool->SpawnEffect(ExplosionPartSystem, Transform);
+		}
+		else
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionPartSystem, Transform, true);
+		}
+	}
+	return true;
+}
+
+// Returns the mesh of the enemies
+TSoftObjectPtr<UStaticMesh> AEnemySwarm::GetInstanceMesh() const
+{
+	return EnemyMesh;
+}
+
+// Called when the assets of the swarm are loaded
+void AEnemySwarm::AssetsLoaded()
+{
+	Super::AssetsLoaded();
+
+	ExplosionPartSystem = ExplosionTemplate.Get();
+	if (!ExplosionPartSystem)
+	{
+		UE_LOG(LogEnemySwarm, Error, TEXT("The asset %s was not found"), *ExplosionTemplate.ToString());
+	}
+
+	// Pre-warm the explosions so destroying the enemies doesn't create particle system components
+	AEffectsPool* EffectsPool = AEffectsPool::GetEffectsPool(GetWorld());
+	if (EffectsPool && ExplosionPartSystem)
+	{
+		EffectsPool->Prewarm(ExplosionPartSystem, ExplosionPoolCapacity, ExplosionPoolBudget);
+	}
+}
+
+// Spawns the waves reached by the right edge of the viewport
+void AEnemySwarm::SpawnWaves(float ViewMaxY)
+{
+	while (NextWave < Waves.Num() && Waves[NextWave].TriggerY <= ViewMaxY)
+	{
+		const FEnemyWave& Wave = Waves[NextWave];
+		for (int32 Index = 0; Index < Wave.Count; Index++)
+		{
+			AddEnemy(Wave, ViewMaxY + SpawnMargin + Index * Wave.Spacing);
+		}
+		UE_LOG(LogEnemySwarm, Verbose, TEXT("Wave %d spawned with %d enemies"), NextWave, Wave.Count);
+		NextWave++;
+	}
+}
+
+// Adds an enemy of a wave
+void AEnemySwarm::AddEnemy(const FEnemyWave& Wave, float Y)
+{
+	EnemyIndices.Add(NextEnemyId, EnemyIds.Add(NextEnemyId));
+	NextEnemyId = NextEnemyId == MAX_uint32 ? 1 : NextEnemyId + 1;
+	PositionsY.Add(Y);
+	PositionsZ.Add(Wave.SpawnZ);
+	VelocitiesY.Add(Wave.Velocity.X);
+	VelocitiesZ.Add(Wave.Velocity.Y);
+	HitPoints.Add(EnemyHitPoints);
+	PatternIds.Add(Wave.Pattern);
+	Ages.Add(0.0f);
+	BaseZ.Add(Wave.SpawnZ);
+	Amplitudes.Add(Wave.Amplitude);
+	AngularFrequencies.Add(2.0f * PI * Wave.Frequency);
+
+	Stats.Spawned++;
+	Stats.LiveEnemies = PositionsY.Num();
+	Stats.HighWaterMark = FMath::Max(Stats.HighWaterMark, Stats.LiveEnemies);
+}
+
+// Moves the enemies along their patterns
+void AEnemySwarm::MoveEnemies(float DeltaSeconds, float ScrollSpeed, float PlayerZ)
+{
+	const int32 NumEnemies = PositionsY.Num();
+	float* RESTRICT Y = PositionsY.GetData();
+	float* RESTRICT Z = PositionsZ.GetData();
+	const float* RESTRICT VelocityY = VelocitiesY.GetData();
+	const float* RESTRICT VelocityZ = VelocitiesZ.GetData();
+	float* RESTRICT Age = Ages.GetData();
+	float* RESTRICT Base = BaseZ.GetData();
+	const float* RESTRICT Amplitude = Amplitudes.GetData();
+	const float* RESTRICT AngularFrequency = AngularFrequencies.GetData();
+	const EEnemyPattern* RESTRICT Pattern = PatternIds.GetData();
+
+	// The horizontal movement is the same for every pattern: the enemies are carried along by the scroll
+	for (int32 Index = 0; Index < NumEnemies; Index++)
+	{
+		Y[Index] += (ScrollSpeed + VelocityY[Index]) * DeltaSeconds;
+		Base[Index] += VelocityZ[Index] * DeltaSeconds;
+		Age[Index] += DeltaSeconds;
+	}
+
+	// The vertical movement depends on the pattern
+	for (int32 Index = 0; Index < NumEnemies; Index++)
+	{
+		switch (Pattern[Index])
+		{
+		case EEnemyPattern::Straight:
+			Z[Index] = Base[Index];
+			break;
+		case EEnemyPattern::SineWave:
+			Z[Index] = Base[Index] + Amplitude[Index] * FMath::Sin(AngularFrequency[Index] * Age[Index]);
+			break;
+		case EEnemyPattern::Chase:
+		{
+			const float MaxStep = Amplitude[Index] * DeltaSeconds;
+			Z[Index] += FMath::Clamp(PlayerZ - Z[Index], -MaxStep, MaxStep) + VelocityZ[Index] * DeltaSeconds;
+			break;
+		}
+		}
+	}
+}
+
+// Checks the overlaps of the enemies with the player and the player projectiles
+void AEnemySwarm::CollideEnemies()
+{
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (!CollisionManager)
+	{
+		return;
+	}
+
+	for (int32 Enemy = 0; Enemy < PositionsY.Num(); Enemy++)
+	{
+		if (HitPoints[Enemy] <= 0)
+		{
+			continue;
+		}
+
+		Overlaps.Reset();
+		CollisionManager->OverlapCircle(GetEnemyLocation(Enemy), EnemyRadius, ECollisionLayer2D::Enemy, Overlaps);
+		for (const FCollisionOverlap2D& Overlap : Overlaps)
+		{
+			// The projectiles beyond the one which destroys the enemy keep flying
+			if (HitPoints[Enemy] <= 0)
+			{
+				break;
+			}
+			if (Overlap.Actor->IsPendingKill())
+			{
+				continue;
+			}
+
+			// Crashing into the player destroys the enemy regardless of its hit points
+			CollisionManager->NotifyOverlap(Overlap.Actor, this, InstancesComponent);
+			DamageEnemy(Enemy, Overlap.Layer == ECollisionLayer2D::Player ? HitPoints[Enemy] : ProjectileDamage);
+		}
+	}
+}
+
+// Removes the destroyed enemies and the ones which left the screen
+void AEnemySwarm::RemoveEnemies(const FBox2D& CullBounds)
+{
+	for (int32 Enemy = PositionsY.Num() - 1; Enemy >= 0; Enemy--)
+	{
+		if (HitPoints[Enemy] <= 0)
+		{
+			RemoveAtSwap(Enemy);
+		}
+		else if (!CullBounds.IsInside(GetEnemyLocation(Enemy)))
+		{
+			Stats.Escaped++;
+			RemoveAtSwap(Enemy);
+		}
+	}
+	Stats.LiveEnemies = PositionsY.Num();
+	SET_DWORD_STAT(STAT_ZynapsLiveEnemies, Stats.LiveEnemies);
+}
+
+// Removes an enemy, filling the gap with the last one
+void AEnemySwarm::RemoveAtSwap(int32 Enemy)
+{
+	// Keep the index lookup consistent with the enemy moved into the gap
+	EnemyIndices.Remove(EnemyIds[Enemy]);
+	const int32 LastEnemy = EnemyIds.Num() - 1;
+	if (Enemy != LastEnemy)
+	{
+		EnemyIndices.Add(EnemyIds[LastEnemy], Enemy);
+	}
+
+	EnemyIds.RemoveAtSwap(Enemy, 1, false);
+	PositionsY.RemoveAtSwap(Enemy, 1, false);
+	PositionsZ.RemoveAtSwap(Enemy, 1, false);
+	VelocitiesY.RemoveAtSwap(Enemy, 1, false);
+	VelocitiesZ.RemoveAtSwap(Enemy, 1, false);
+	HitPoints.RemoveAtSwap(Enemy, 1, false);
+	PatternIds.RemoveAtSwap(Enemy, 1, false);
+	Ages.RemoveAtSwap(Enemy, 1, false);
+	BaseZ.RemoveAtSwap(Enemy, 1, false);
+	Amplitudes.RemoveAtSwap(Enemy, 1, false);
+	AngularFrequencies.RemoveAtSwap(Enemy, 1, false);
+}
+
+// Updates the instances to match the enemies and rebuilds the grid
+void AEnemySwarm::UpdateInstances()
+{
+	// Each instance shows the enemy with the same index
+	const FQuat Rotation = EnemyRotation.Quaternion();
+	const int32 NumEnemies = PositionsY.Num();
+	for (int32 Enemy = 0; Enemy < NumEnemies; Enemy++)
+	{
+		SetInstance(Enemy, FTransform(Rotation, FVector(0.0f, PositionsY[Enemy], PositionsZ[Enemy]), EnemyScale));
+	}
+	SetNumShown(NumEnemies);
+
+	// Rebuild the grid used by the queries of the other systems
+	Grid.Reset();
+	for (int32 Index = 0; Index < NumEnemies; Index++)
+	{
+		Grid.Insert(Index, GetEnemyLocation(Index), EnemyRadius);
+	}
+}
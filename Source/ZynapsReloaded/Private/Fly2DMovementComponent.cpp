@@ -3,6 +3,8 @@
 #include "ZynapsReloaded.h"
 #include "Fly2DMovementComponent.h"
 #include "ProjectionUtil.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsController.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogFly2DMovementComponent);
@@ -30,6 +32,16 @@ UFly2DMovementComponent::UFly2DMovementComponent() : Super()
 	RotationSpeed = 250.0f;
 	RotationRecoverySpeed = 200.0f;
 	CurrentRotation = 0.0f;
+
+	// Init fixed timestep vars
+	bUseFixedTimestep = false;
+	FixedStepRate = 60.0f;
+	MaxSubsteps = 5;
+	bInterpolateMovement = true;
+	TimeAccumulator = 0.0f;
+	bHasSimulatedState = false;
+	PreviousLocation = SimulatedLocation = LastRenderedLocation = FVector::ZeroVector;
+	PreviousRotation = 0.0f;
 }
 
 // Called when the game starts
@@ -51,8 +63,11 @@ void UFly2DMovementComponent::TickComponent(float DeltaSeconds, ELevelTick TickT
 // Called from TickComponent() to calculate and apply movement to the updated component based on user input
 void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsPlayerMovement);
+
 	// Get the player controller
-	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
 	if (!PlayerController)
 	{
 		UE_LOG(LogFly2DMovementComponent, Error, TEXT("Failed to retrieve the player controller"));
@@ -77,6 +92,90 @@ void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 	float MaxAcceleration = InitialAcceleration + 
 		InitialAcceleration * (SpeedUpLevelIncrement * SpeedUpLevel);
 
+	// Get the actor's origin and extent
+	FVector ActorOrigin;
+	FVector ActorExtent;
+	GetOwner()->GetActorBounds(true, ActorOrigin, ActorExtent);
+
+	// Calculate the viewport bounds
+	FVector TopLeftBound;
+	FVector BottomRightBound;
+	if (!UProjectionUtil::GetCachedViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
+	{
+		UE_LOG(LogFly2DMovementComponent, Error, TEXT("Failed to calculate the viewport bounds"));
+		return;
+	}
+	FMovementLimits2D MovementLimits;
+	MovementLimits.MaxZ = TopLeftBound.Z - ActorExtent.Z - LimitMarginUp;
+	MovementLimits.MinZ = BottomRightBound.Z + ActorExtent.Z + LimitMarginDown;
+	MovementLimits.MinY = TopLeftBound.Y + ActorExtent.Y + LimitMarginLeft;
+	MovementLimits.MaxY = BottomRightBound.Y - ActorExtent.Y - LimitMarginRight;
+
+	if (!bUseFixedTimestep)
+	{
+		// Simulate a single step with the frame time
+		FVector NextLocation = ComponentToUpdate->GetComponentLocation();
+		StepActorMovement(DeltaSeconds, MaxMovementSpeed, MaxAcceleration, MovementLimits, NextLocation);
+		ComponentToUpdate->SetWorldLocation(NextLocation);
+		ComponentToUpdate->SetRelativeRotation(FRotator(CurrentRotation, 180.0f, -90.0f));
+		bHasSimulatedState = false;
+	}
+	else
+	{
+		// Carry over any offset applied to the component by others since the last tick (i.e. the scroll), so
+		// the simulated states stay in the same space as the rendered location
+		FVector RenderedLocation = ComponentToUpdate->GetComponentLocation();
+		if (bHasSimulatedState)
+		{
+			FVector ExternalOffset = RenderedLocation - LastRenderedLocation;
+			PreviousLocation += ExternalOffset;
+			SimulatedLocation += ExternalOffset;
+		}
+		else
+		{
+			PreviousLocation = SimulatedLocation = RenderedLocation;
+			PreviousRotation = CurrentRotation;
+			TimeAccumulator = 0.0f;
+			bHasSimulatedState = true;
+		}
+
+		// Run as many fixed steps as needed to consume the frame time
+		float StepSeconds = 1.0f / FMath::Max(FixedStepRate, 1.0f);
+		TimeAccumulator += DeltaSeconds;
+		int32 Substeps = 0;
+		while (TimeAccumulator >= StepSeconds && Substeps < MaxSubsteps)
+		{
+			PreviousLocation = SimulatedLocation;
+			PreviousRotation = CurrentRotation;
+			StepActorMovement(StepSeconds, MaxMovementSpeed, MaxAcceleration, MovementLimits, SimulatedLocation);
+			TimeAccumulator -= StepSeconds;
+			Substeps++;
+		}
+
+		// Drop the time that could not be simulated after a hitch instead of trying to catch up later
+		if (TimeAccumulator >= StepSeconds)
+		{
+			UE_LOG(LogFly2DMovementComponent, Verbose, TEXT("Dropping %f seconds of movement simulation"),
+				TimeAccumulator - FMath::Fmod(TimeAccumulator, StepSeconds));
+			TimeAccumulator = FMath::Fmod(TimeAccumulator, StepSeconds);
+		}
+
+		// Render the state between the last two simulated states
+		float Alpha = bInterpolateMovement ? TimeAccumulator / StepSeconds : 1.0f;
+		LastRenderedLocation = FMath::Lerp(PreviousLocation, SimulatedLocation, Alpha);
+		ComponentToUpdate->SetWorldLocation(LastRenderedLocation);
+		ComponentToUpdate->SetRelativeRotation(
+			FRotator(FMath::Lerp(PreviousRotation, CurrentRotation, Alpha), 180.0f, -90.0f));
+	}
+
+	// Clear movement flags
+	bMoveUp = bMoveDown = bMoveLeft = bMoveRight = false;
+}
+
+// Integrates the speed and rotation over the given time and moves the given location within the limits
+void UFly2DMovementComponent::StepActorMovement(float StepSeconds, float MaxMovementSpeed, float MaxAcceleration,
+	const FMovementLimits2D& MovementLimits, FVector& Location)
+{
 	// Init rotation
 	float RotationToApply = 0.0f;
 
@@ -84,7 +183,7 @@ void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 	if (bMoveUp && !bMoveDown)
 	{
 		// Accelerate up
-		CurrentSpeed.Y += MaxAcceleration * DeltaSeconds;
+		CurrentSpeed.Y += MaxAcceleration * StepSeconds;
 		if (CurrentSpeed.Y > MaxMovementSpeed) CurrentSpeed.Y = MaxMovementSpeed;
 
 		// Set rotation to apply
@@ -93,7 +192,7 @@ void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 	else if (bMoveDown && !bMoveUp)
 	{
 		// Accelerate down
-		CurrentSpeed.Y -= MaxAcceleration * DeltaSeconds;
+		CurrentSpeed.Y -= MaxAcceleration * StepSeconds;
 		if (CurrentSpeed.Y < -MaxMovementSpeed) CurrentSpeed.Y = -MaxMovementSpeed;
 
 		// Set rotation to apply
@@ -106,12 +205,12 @@ void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 		{
 			if (CurrentSpeed.Y > 0.0f)
 			{
-				CurrentSpeed.Y -= MaxAcceleration * DeltaSeconds;
+				CurrentSpeed.Y -= MaxAcceleration * StepSeconds;
 				if (CurrentSpeed.Y < 0.0f) CurrentSpeed.Y = 0.0f;
 			}
 			else
 			{
-				CurrentSpeed.Y += MaxAcceleration * DeltaSeconds;
+				CurrentSpeed.Y += MaxAcceleration * StepSeconds;
 				if (CurrentSpeed.Y > 0.0f) CurrentSpeed.Y = 0.0f;
 			}
 		}
@@ -121,13 +220,13 @@ void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 	if (bMoveLeft && !bMoveRight)
 	{
 		// Accelerate left
-		CurrentSpeed.X -= MaxAcceleration * DeltaSeconds;
+		CurrentSpeed.X -= MaxAcceleration * StepSeconds;
 		if (CurrentSpeed.X < -MaxMovementSpeed) CurrentSpeed.X = -MaxMovementSpeed;
 	}
 	else if (bMoveRight && !bMoveLeft)
 	{
 		// Accelerate right
-		CurrentSpeed.X += MaxAcceleration * DeltaSeconds;
+		CurrentSpeed.X += MaxAcceleration * StepSeconds;
 		if (CurrentSpeed.X > MaxMovementSpeed) CurrentSpeed.X = MaxMovementSpeed;
 	}
 	else
@@ -137,65 +236,41 @@ void UFly2DMovementComponent::ApplyActorMovement(float DeltaSeconds)
 		{
 			if (CurrentSpeed.X > 0.0f)
 			{
-				CurrentSpeed.X -= MaxAcceleration * DeltaSeconds;
+				CurrentSpeed.X -= MaxAcceleration * StepSeconds;
 				if (CurrentSpeed.X < 0.0f) CurrentSpeed.X = 0.0f;
 			}
 			else
 			{
-				CurrentSpeed.X += MaxAcceleration * DeltaSeconds;
+				CurrentSpeed.X += MaxAcceleration * StepSeconds;
 				if (CurrentSpeed.X > 0.0f) CurrentSpeed.X = 0.0f;
 			}
 		}
 	}
 
-	// Apply the actor rotation
-	ApplyActorRotation(ComponentToUpdate, RotationToApply, DeltaSeconds);
-
-	// Get the actor's origin and extent
-	FVector ActorOrigin;
-	FVector ActorExtent;
-	GetOwner()->GetActorBounds(true, ActorOrigin, ActorExtent);
-
-	// Calculate the viewport bounds
-	FVector TopLeftBound;
-	FVector BottomRightBound;
-	if (!UProjectionUtil::CalculateViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
-	{
-		UE_LOG(LogFly2DMovementComponent, Error, TEXT("Failed to calculate the viewport bounds"));
-		return;
-	}
-	float MaxZ = TopLeftBound.Z - ActorExtent.Z - LimitMarginUp;
-	float MinZ = BottomRightBound.Z + ActorExtent.Z + LimitMarginDown;
-	float MinY = TopLeftBound.Y + ActorExtent.Y + LimitMarginLeft;
-	float MaxY = BottomRightBound.Y - ActorExtent.Y - LimitMarginRight;
-
-	// Calculate the next position to occupy
-	FVector NextLocation = ComponentToUpdate->GetComponentLocation();
-	NextLocation.Z += CurrentSpeed.Y;
-	NextLocation.Y += CurrentSpeed.X;
-	NextLocation.Z = FMath::Clamp(NextLocation.Z, MinZ, MaxZ);
-	NextLocation.Y = FMath::Clamp(NextLocation.Y, MinY, MaxY);
+	// Update the actor rotation
+	UpdateActorRotation(RotationToApply, StepSeconds);
 
-	// Move the actor to the next position
-	ComponentToUpdate->SetWorldLocation(NextLocation);
+	// Calculate the next position to occupy. Speeds are expressed in units per frame at the reference frame
+	// rate, so they are scaled by the elapsed time.
+	float FrameScale = StepSeconds * MovementReferenceFrameRate;
+	Location.Z += CurrentSpeed.Y * FrameScale;
+	Location.Y += CurrentSpeed.X * FrameScale;
+	Location.Z = FMath::Clamp(Location.Z, MovementLimits.MinZ, MovementLimits.MaxZ);
+	Location.Y = FMath::Clamp(Location.Y, MovementLimits.MinY, MovementLimits.MaxY);
 
 	// Reset speed to zero if the actor is touching the screen bounds
-	if (NextLocation.Z >= MaxZ || NextLocation.Z <= MinZ)
+	if (Location.Z >= MovementLimits.MaxZ || Location.Z <= MovementLimits.MinZ)
 	{
 		CurrentSpeed.Y = 0.0f;
 	}
-	if (NextLocation.Y >= MaxY || NextLocation.Y <= MinY)
+	if (Location.Y >= MovementLimits.MaxY || Location.Y <= MovementLimits.MinY)
 	{
 		CurrentSpeed.X = 0.0f;
 	}
-
-	// Clear movement flags
-	bMoveUp = bMoveDown = bMoveLeft = bMoveRight = false;
 }
 
-// Calculates and applies rotation to the updated component when moving up and down
-void UFly2DMovementComponent::ApplyActorRotation(USceneComponent* ComponentToUpdate, float RotationToApply, 
-	float DeltaSeconds)
+// Calculates the rotation of the updated component when moving up and down
+void UFly2DMovementComponent::UpdateActorRotation(float RotationToApply, float DeltaSeconds)
 {
 	if (RotationToApply != 0.0f)
 	{
@@ -217,7 +292,6 @@ void UFly2DMovementComponent::ApplyActorRotation(USceneComponent* ComponentToUpd
 				CurrentRotation = -MaxRotation;
 			}
 		}
-		RotationToApply = 0.0f;
 	}
 	else
 	{
@@ -245,7 +319,6 @@ void UFly2DMovementComponent::ApplyActorRotation(USceneComponent* ComponentToUpd
 			}
 		}
 	}
-	ComponentToUpdate->SetRelativeRotation(FRotator(CurrentRotation, 180.0f, -90.0f));
 }
 
 // Called to move the actor up
@@ -276,6 +349,7 @@ void UFly2DMovementComponent::MoveRight(float Val)
 void UFly2DMovementComponent::StopMovement()
 {
 	CurrentSpeed = FVector2D::ZeroVector;
+	bHasSimulatedState = false;
 }
 
 // Returns the owner component to update. If an updated component was not set, returns the root component
@@ -293,15 +367,6 @@ USceneComponent* UFly2DMovementComponent::GetSafeUpdatedComponent() const
 // Returns the player state
 AZynapsPlayerState* UFly2DMovementComponent::GetZynapsPlayerState() const
 {
-	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
-	if (!PlayerController)
-	{
-		return nullptr;
-	}
-
-	if (!PlayerController->PlayerState)
-	{
-		return nullptr;
-	}
-	return Cast<AZynapsPlayerState>(PlayerController->PlayerState);
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetPlayerState() : nullptr;
 }
@@ -3,6 +3,13 @@
 #include "ZynapsReloaded.h"
 #include "FuelCapsule.h"
 #include "ProjectionUtil.h"
+#include "ScreenCullingManager.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsController.h"
+#include "CollisionManager.h"
+#include "PerformanceUtil.h"
+#include "StageAssetPreloader.h"
+#include "Components/SplineComponent.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogFuelCapsule);
@@ -21,6 +28,22 @@ AFuelCapsule::AFuelCapsule() : Super()
 
 	// Set up the mesh component
 	MeshComponent = CreateMeshComponent(CapsuleComponent);
+	CapsuleMesh = FSoftObjectPath(TEXT("StaticMesh'/Game/Models/FuelCapsule/FuelCapsule.FuelCapsule'"));
+
+	// Init culling vars
+	bCulledByManager = false;
+
+	// Init motion vars
+	MotionMode = EFuelCapsuleMotion::Physics;
+	DriftVelocity = FVector::ZeroVector;
+	WaveAxis = FVector(0.0f, 0.0f, 1.0f);
+	WaveAmplitude = 0.0f;
+	WaveFrequency = 1.0f;
+	MotionPathActor = nullptr;
+	PathSpeed = 0.0f;
+	bLoopPath = false;
+	MotionOrigin = FVector::ZeroVector;
+	MotionTime = 0.0f;
 }
 
 // Creates the capsule component used for collision detection
@@ -53,37 +76,91 @@ UCapsuleComponent* AFuelCapsule::CreateCapsuleComponent(USceneComponent* Parent)
 	return Component;
 }
 
-// Creates the mesh component which models the ship
+// Creates the mesh component which models the fuel capsule
 UStaticMeshComponent* AFuelCapsule::CreateMeshComponent(USceneComponent* Parent)
 {
 	UStaticMeshComponent* Component = CreateDefaultSubobject<UStaticMeshComponent>(
 		TEXT("MeshComponent"));
-	static ConstructorHelpers::FObjectFinder<UStaticMesh> MeshObj(
-		TEXT("StaticMesh'/Game/Models/FuelCapsule/FuelCapsule.FuelCapsule'"));
-	if (MeshObj.Succeeded())
-	{
-		Component->SetStaticMesh(MeshObj.Object);
-		Component->SetRelativeRotation(FRotator(0.0f, 0.0f, 90.0f));
-		Component->SetRelativeScale3D(FVector(0.5f, 0.5f, 0.5f));
-		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		Component->SetSimulatePhysics(false);
-		Component->SetupAttachment(Parent);
-	}
-	else
-	{
-		UE_LOG(LogFuelCapsule, Error,
-			TEXT("The asset StaticMesh'/Game/Models/FuelCapsule/FuelCapsule.FuelCapsule'"));
-		Component = nullptr;
-	}
+	Component->SetRelativeRotation(FRotator(0.0f, 0.0f, 90.0f));
+	Component->SetRelativeScale3D(FVector(0.5f, 0.5f, 0.5f));
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetSimulatePhysics(false);
+	Component->SetupAttachment(Parent);
 
 	return Component;
 }
 
+// Called when the mesh of the fuel capsule is loaded
+void AFuelCapsule::AssetsLoaded()
+{
+	// Blueprints may set their own mesh on the component
+	if (!MeshComponent->GetStaticMesh())
+	{
+		MeshComponent->SetStaticMesh(CapsuleMesh.Get());
+		if (!CapsuleMesh.Get())
+		{
+			UE_LOG(LogFuelCapsule, Error, TEXT("The asset %s was not found"), *CapsuleMesh.ToString());
+		}
+	}
+}
+
 // Called when the game starts or when spawned
 void AFuelCapsule::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// Update the performance counters
+	UPerformanceUtil::RecordSpawn();
+	UPerformanceUtil::AddLiveFuelCapsules(1);
+
+	// Set the mesh once it is loaded. It is usually preloaded while the stage prepares.
+	TArray<FSoftObjectPath> Assets;
+	Assets.Add(CapsuleMesh.ToSoftObjectPath());
+	AStageAssetPreloader::RequestAssets(GetWorld(), Assets,
+		FSimpleDelegate::CreateUObject(this, &AFuelCapsule::AssetsLoaded));
+
+	// Set up the physics or the kinematic motion
+	ApplyMotionMode();
+
+	// Let the culling manager check the visibility. The fuel capsule only needs to tick if there is none or
+	// if it moves kinematically.
+	AScreenCullingManager* CullingManager = AScreenCullingManager::GetScreenCullingManager(GetWorld());
+	if (CullingManager)
+	{
+		CullingManager->Register(this, FOnActorOffScreen::CreateUObject(this, &AFuelCapsule::OffScreen));
+		bCulledByManager = true;
+	}
+	SetActorTickEnabled(NeedsTick());
+
+	// Let the collision manager detect the overlaps, so the physics engine doesn't need to generate them
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (CollisionManager)
+	{
+		CollisionManager->Register(this, CapsuleComponent, ECollisionLayer2D::Pickup,
+			FOnBodyOverlap::CreateUObject(this, &AFuelCapsule::BodyOverlap));
+		CapsuleComponent->SetGenerateOverlapEvents(false);
+		CapsuleComponent->SetNotifyRigidBodyCollision(false);
+	}
+}
+
+// Called when the actor is removed from the level
+void AFuelCapsule::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AScreenCullingManager* CullingManager = AScreenCullingManager::GetScreenCullingManager(GetWorld());
+	if (CullingManager)
+	{
+		CullingManager->Unregister(this);
+	}
+
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (CollisionManager)
+	{
+		CollisionManager->Unregister(this);
+	}
+
+	UPerformanceUtil::AddLiveFuelCapsules(-1);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -91,18 +168,137 @@ void AFuelCapsule::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
+	// Move the fuel capsule if the physics engine doesn't
+	if (MotionMode != EFuelCapsuleMotion::Physics)
+	{
+		UpdateKinematicMotion(DeltaSeconds);
+	}
+
 	// Destroy the fuel capsule if it is not visible anymore
-	if (!IsVisibleOnScreen())
+	if (!bCulledByManager && !IsVisibleOnScreen())
 	{
 		Destroy();
 	}
 }
 
+// Changes the motion mode. The motion restarts from the current location.
+void AFuelCapsule::SetMotionMode(EFuelCapsuleMotion NewMotionMode)
+{
+	MotionMode = NewMotionMode;
+	if (HasActorBegunPlay())
+	{
+		ApplyMotionMode();
+		SetActorTickEnabled(NeedsTick());
+	}
+}
+
+// Enables the rigid body simulation or the query-only collision depending on the motion mode
+void AFuelCapsule::ApplyMotionMode()
+{
+	MotionOrigin = GetActorLocation();
+	MotionTime = 0.0f;
+	MotionPath = nullptr;
+
+	if (MotionMode == EFuelCapsuleMotion::Physics)
+	{
+		CapsuleComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		CapsuleComponent->SetSimulatePhysics(true);
+		CapsuleComponent->WakeRigidBody();
+		return;
+	}
+
+	// Kinematic modes only need the capsule for overlap queries
+	CapsuleComponent->SetSimulatePhysics(false);
+	CapsuleComponent->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+
+	if (MotionMode == EFuelCapsuleMotion::Spline)
+	{
+		USplineComponent* Spline = MotionPathActor ?
+			MotionPathActor->FindComponentByClass<USplineComponent>() : nullptr;
+		if (!Spline)
+		{
+			UE_LOG(LogFuelCapsule, Warning, TEXT("No spline found for the fuel capsule %s. It will drift instead"),
+				*GetName());
+			MotionMode = EFuelCapsuleMotion::Velocity;
+			return;
+		}
+		MotionPath = Spline;
+	}
+}
+
+// Moves the fuel capsule according to the kinematic motion mode
+void AFuelCapsule::UpdateKinematicMotion(float DeltaSeconds)
+{
+	// Locations are calculated from the elapsed time instead of accumulating offsets, so they don't drift
+	MotionTime += DeltaSeconds;
+	FVector Location;
+	switch (MotionMode)
+	{
+	case EFuelCapsuleMotion::SineWave:
+		Location = MotionOrigin + DriftVelocity * MotionTime +
+			WaveAxis.GetSafeNormal() * WaveAmplitude * FMath::Sin(2.0f * PI * WaveFrequency * MotionTime);
+		break;
+	case EFuelCapsuleMotion::Spline:
+		Location = GetPathLocation(MotionTime);
+		break;
+	default:
+		Location = MotionOrigin + DriftVelocity * MotionTime;
+		break;
+	}
+	SetActorLocation(Location);
+}
+
+// Returns the location along the motion path after the given time
+FVector AFuelCapsule::GetPathLocation(float Time) const
+{
+	USplineComponent* Spline = MotionPath.Get();
+	if (!Spline)
+	{
+		return GetActorLocation();
+	}
+
+	const float Length = Spline->GetSplineLength();
+	float Distance = PathSpeed * Time;
+	if (bLoopPath && Length > 0.0f)
+	{
+		Distance = FMath::Fmod(Distance, Length);
+	}
+	else if (Distance > Length)
+	{
+		// Keep moving along the end tangent
+		const FVector Direction = Spline->GetDirectionAtDistanceAlongSpline(Length, ESplineCoordinateSpace::World);
+		return Spline->GetLocationAtDistanceAlongSpline(Length, ESplineCoordinateSpace::World) +
+			Direction * (Distance - Length);
+	}
+	return Spline->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+}
+
+// Returns whether the fuel capsule needs to tick
+bool AFuelCapsule::NeedsTick() const
+{
+	return !bCulledByManager || MotionMode != EFuelCapsuleMotion::Physics;
+}
+
+// Called by the culling manager when the fuel capsule leaves the screen
+void AFuelCapsule::OffScreen(AActor* Actor)
+{
+	Destroy();
+}
+
+// Called by the collision manager when the fuel capsule begins overlapping with another actor
+void AFuelCapsule::BodyOverlap(AActor* OtherActor, UPrimitiveComponent* OtherComp)
+{
+	BeginOverlap(CapsuleComponent, OtherActor, OtherComp, 0, false, FHitResult());
+}
+
 // Checks that the projectile is within the viewport limits
 bool AFuelCapsule::IsVisibleOnScreen() const
 {
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsVisibilityChecks);
+
 	// Get the player controller
-	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
 	if (!PlayerController)
 	{
 		UE_LOG(LogFuelCapsule, Error, TEXT("Failed to retrieve the player controller"));
@@ -0,0 +1,212 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "GameplayAudioManager.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogGameplayAudioManager);
+
+// Sets default values
+AGameplayAudioManager::AGameplayAudioManager() : Super()
+{
+	// The manager doesn't need to tick
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+// Called when the actor is removed from the level
+void AGameplayAudioManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the usage counters to help tuning the concurrency settings
+	for (const TPair<USoundBase*, FSoundCueEntry>& Pair : Entries)
+	{
+		const FSoundCueStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogGameplayAudioManager, Verbose,
+			TEXT("Sound %s: voices %d, plays %d, steals %d, throttled %d, dropped %d"),
+			*GetNameSafe(Pair.Key), Stats.Voices, Stats.Plays, Stats.Steals, Stats.Throttled, Stats.Dropped);
+	}
+	StopAll();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Returns the audio manager of the specified world or nullptr if the game mode doesn't provide one
+AGameplayAudioManager* AGameplayAudioManager::GetGameplayAudioManager(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetGameplayAudioManager();
+}
+
+// Allocates the voices of a sound cue and sets its concurrency settings
+void AGameplayAudioManager::Prewarm(USoundBase* Sound, const FSoundCueSettings& Settings)
+{
+	if (!Sound)
+	{
+		UE_LOG(LogGameplayAudioManager, Warning, TEXT("Tried to pre-warm the voices without a sound"));
+		return;
+	}
+
+	FSoundCueEntry& Entry = Entries.FindOrAdd(Sound);
+	const int32 MaxVoices = FMath::Max(Settings.MaxVoices, Entry.Voices.Num());
+	Entry.Settings = Settings;
+	Entry.Settings.MaxVoices = FMath::Max(MaxVoices, 1);
+	while (Entry.Voices.Num() < Entry.Settings.MaxVoices)
+	{
+		UAudioComponent* Voice = CreateVoice(Sound);
+		if (!Voice)
+		{
+			UE_LOG(LogGameplayAudioManager, Error, TEXT("Failed to create a voice for the sound %s"),
+				*Sound->GetName());
+			break;
+		}
+		Entry.Voices.Add(Voice);
+		Entry.VoiceStartTimes.Add(-BIG_NUMBER);
+	}
+	Entry.Settings.MaxVoices = Entry.Voices.Num();
+	Entry.Stats.Voices = Entry.Voices.Num();
+}
+
+// Plays a sound on one of its voices
+bool AGameplayAudioManager::Play(USoundBase* Sound)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsAudio);
+
+	if (!Sound)
+	{
+		return false;
+	}
+
+	FSoundCueEntry* Entry = Entries.Find(Sound);
+	if (!Entry)
+	{
+		Prewarm(Sound, FSoundCueSettings());
+		Entry = Entries.Find(Sound);
+	}
+	if (Entry->Voices.Num() == 0)
+	{
+		return false;
+	}
+
+	// Ignore the requests coming too soon after the previous one
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now - Entry->LastPlayTime < Entry->Settings.RetriggerInterval)
+	{
+		Entry->Stats.Throttled++;
+		return false;
+	}
+
+	// Take a free voice, or the one which started first if all of them are busy
+	int32 VoiceIndex = INDEX_NONE;
+	int32 OldestIndex = 0;
+	for (int32 Index = 0; Index < Entry->Voices.Num(); Index++)
+	{
+		UAudioComponent* Voice = Entry->Voices[Index];
+		if (!Voice || !Voice->IsPlaying())
+		{
+			VoiceIndex = Index;
+			break;
+		}
+		if (Entry->VoiceStartTimes[Index] < Entry->VoiceStartTimes[OldestIndex])
+		{
+			OldestIndex = Index;
+		}
+	}
+	if (VoiceIndex == INDEX_NONE)
+	{
+		if (!Entry->Settings.bStealOldestVoice)
+		{
+			Entry->Stats.Dropped++;
+			return false;
+		}
+		VoiceIndex = OldestIndex;
+		Entry->Voices[VoiceIndex]->Stop();
+		Entry->Stats.Steals++;
+	}
+
+	// Voices destroyed by other means are created again
+	UAudioComponent*& Voice = Entry->Voices[VoiceIndex];
+	if (!Voice || Voice->IsPendingKill())
+	{
+		Voice = CreateVoice(Sound);
+		if (!Voice)
+		{
+			UE_LOG(LogGameplayAudioManager, Error, TEXT("Failed to create a voice for the sound %s"),
+				*Sound->GetName());
+			return false;
+		}
+	}
+
+	Voice->Play();
+	Entry->VoiceStartTimes[VoiceIndex] = Now;
+	Entry->LastPlayTime = Now;
+	Entry->Stats.Plays++;
+	return true;
+}
+
+// Stops all the voices
+void AGameplayAudioManager::StopAll()
+{
+	for (TPair<USoundBase*, FSoundCueEntry>& Pair : Entries)
+	{
+		for (UAudioComponent* Voice : Pair.Value.Voices)
+		{
+			if (Voice)
+			{
+				Voice->Stop();
+			}
+		}
+	}
+}
+
+// Returns the usage counters of a sound cue
+FSoundCueStats AGameplayAudioManager::GetStats(USoundBase* Sound) const
+{
+	const FSoundCueEntry* Entry = Sound ? Entries.Find(Sound) : nullptr;
+	return Entry ? Entry->Stats : FSoundCueStats();
+}
+
+// Returns the number of voices playing
+int32 AGameplayAudioManager::GetNumActiveVoices() const
+{
+	int32 Result = 0;
+	for (const TPair<USoundBase*, FSoundCueEntry>& Pair : Entries)
+	{
+		for (const UAudioComponent* Voice : Pair.Value.Voices)
+		{
+			if (Voice && Voice->IsPlaying())
+			{
+				Result++;
+			}
+		}
+	}
+	return Result;
+}
+
+// Creates a voice for a sound cue
+UAudioComponent* AGameplayAudioManager::CreateVoice(USoundBase* Sound)
+{
+	// Same setup as UGameplayStatics::PlaySound2D, but the component is kept after the sound finishes
+	UAudioComponent* Voice = NewObject<UAudioComponent>(this);
+	if (!Voice)
+	{
+		return nullptr;
+	}
+	Voice->SetSound(Sound);
+	Voice->bAutoActivate = false;
+	Voice->bAutoDestroy = false;
+	Voice->bAllowSpatialization = false;
+	Voice->bIgnoreForFlushing = true;
+	Voice->RegisterComponent();
+	return Voice;
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "GarbageCollectionScheduler.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogGarbageCollectionScheduler);
+
+// Console variable which defers the garbage collection while playing
+static TAutoConsoleVariable<int32> CVarGCDeferWhilePlaying(
+	TEXT("Zynaps.GC.DeferWhilePlaying"),
+	1,
+	TEXT("Defers the garbage collection while the stage is in the Playing state.\n")
+	TEXT("0: the engine collects whenever it needs, 1: deferred"),
+	ECVF_Default);
+
+// Console variable which limits how long the garbage collection can be deferred
+static TAutoConsoleVariable<float> CVarGCMaxDeferTime(
+	TEXT("Zynaps.GC.MaxDeferTime"),
+	120.0f,
+	TEXT("Maximum time in seconds since the last garbage collection before it is allowed while playing."),
+	ECVF_Default);
+
+// Console variable which sets the time budget of the incremental purge
+static TAutoConsoleVariable<float> CVarGCPurgeBudgetMs(
+	TEXT("Zynaps.GC.PurgeBudgetMs"),
+	2.0f,
+	TEXT("Time in milliseconds per frame spent purging the collected objects outside the Playing state."),
+	ECVF_Default);
+
+// Sets default values
+AGarbageCollectionScheduler::AGarbageCollectionScheduler() : Super()
+{
+	// Tick at the end of the frame, right before the engine considers collecting garbage
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bTickEvenWhenPaused = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	// Init collection vars
+	bCollectionRequested = false;
+	bCollectingWhilePlaying = false;
+	CollectionStartTime = 0.0;
+	TimeSinceLastCollection = 0.0f;
+}
+
+// Called when the game starts or when spawned
+void AGarbageCollectionScheduler::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this,
+		&AGarbageCollectionScheduler::PreGarbageCollect);
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this,
+		&AGarbageCollectionScheduler::PostGarbageCollect);
+}
+
+// Called when the actor is removed from the level
+void AGarbageCollectionScheduler::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+	UE_LOG(LogGarbageCollectionScheduler, Log,
+		TEXT("Garbage collections: %d (%d while playing), max pause %.2f ms (%.2f ms while playing)"),
+		Stats.Collections, Stats.CollectionsWhilePlaying, Stats.MaxPauseMs, Stats.MaxPauseWhilePlayingMs);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void AGarbageCollectionScheduler::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	TimeSinceLastCollection += FApp::GetDeltaTime();
+	if (!GEngine)
+	{
+		return;
+	}
+
+	if (IsPlaying())
+	{
+		// Keep the collection out of the action unless it was requested or deferred for too long
+		if (!bCollectionRequested && CVarGCDeferWhilePlaying.GetValueOnGameThread() != 0 &&
+			TimeSinceLastCollection < CVarGCMaxDeferTime.GetValueOnGameThread())
+		{
+			GEngine->DelayGarbageCollection();
+		}
+	}
+	else if (IsIncrementalPurgePending())
+	{
+		// There is no action, so the purge can take a larger slice of the frame than the engine gives it
+		const float BudgetSeconds = FMath::Max(CVarGCPurgeBudgetMs.GetValueOnGameThread(), 0.0f) / 1000.0f;
+		IncrementalPurgeGarbage(true, BudgetSeconds);
+	}
+}
+
+// Returns the garbage collection scheduler of the specified world or nullptr if the game mode doesn't provide one
+AGarbageCollectionScheduler* AGarbageCollectionScheduler::GetGarbageCollectionScheduler(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetGarbageCollectionScheduler();
+}
+
+// Requests a garbage collection pass on the next frame
+void AGarbageCollectionScheduler::RequestCollection()
+{
+	if (!GEngine)
+	{
+		return;
+	}
+
+	// The objects are purged incrementally afterwards, so the pass itself only marks the unreachable objects
+	bCollectionRequested = true;
+	GEngine->ForceGarbageCollection(false);
+}
+
+// Returns the garbage collection passes observed during the stage
+FGarbageCollectionStats AGarbageCollectionScheduler::GetStats() const
+{
+	return Stats;
+}
+
+// Returns whether the stage is in the Playing state
+bool AGarbageCollectionScheduler::IsPlaying() const
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	AZynapsGameState* GameState = WorldContext ? WorldContext->GetGameState() : nullptr;
+	return GameState && GameState->GetCurrentState() == EStageState::Playing;
+}
+
+// Called before a garbage collection pass
+void AGarbageCollectionScheduler::PreGarbageCollect()
+{
+	CollectionStartTime = FPlatformTime::Seconds();
+	bCollectingWhilePlaying = IsPlaying();
+}
+
+// Called after a garbage collection pass
+void AGarbageCollectionScheduler::PostGarbageCollect()
+{
+	const float PauseMs = (float)((FPlatformTime::Seconds() - CollectionStartTime) * 1000.0);
+	Stats.Collections++;
+	Stats.LastPauseMs = PauseMs;
+	Stats.MaxPauseMs = FMath::Max(Stats.MaxPauseMs, PauseMs);
+	if (bCollectingWhilePlaying)
+	{
+		Stats.CollectionsWhilePlaying++;
+		Stats.MaxPauseWhilePlayingMs = FMath::Max(Stats.MaxPauseWhilePlayingMs, PauseMs);
+		INC_DWORD_STAT(STAT_ZynapsGCWhilePlaying);
+	}
+	SET_FLOAT_STAT(STAT_ZynapsGCPause, PauseMs);
+	UE_LOG(LogGarbageCollectionScheduler, Verbose, TEXT("Garbage collected in %.2f ms%s"), PauseMs,
+		bCollectingWhilePlaying ? TEXT(" while playing") : TEXT(""));
+
+	bCollectionRequested = false;
+	TimeSinceLastCollection = 0.0f;
+}
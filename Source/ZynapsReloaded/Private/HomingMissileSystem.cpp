@@ -0,0 +1,316 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "HomingMissileSystem.h"
+#include "EnemySwarm.h"
+#include "ProjectionUtil.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogHomingMissileSystem);
+
+// Sets default values
+AHomingMissileSystem::AHomingMissileSystem() : Super()
+{
+	// Tick after the enemy swarm, so the queries use the enemies of the current frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Assets streamed in by the stage asset preloader. The mesh is a placeholder pointing along its Z axis.
+	MissileMesh = FSoftObjectPath(TEXT("StaticMesh'/Engine/BasicShapes/Cone.Cone'"));
+	MissileRotation = FRotator(-90.0f, 0.0f, 0.0f);
+	MissileScale = FVector(0.15f, 0.15f, 0.3f);
+
+	// Init missile vars
+	MissileRadius = 20.0f;
+	Speed = 1800.0f;
+	TurnRate = 8.0f;
+	AcquisitionDistance = 2000.0f;
+	ReacquisitionInterval = 0.25f;
+	Lifetime = 4.0f;
+	Damage = 1;
+	Capacity = DefaultHomingMissileCapacity;
+	CullMargin = 200.0f;
+}
+
+// Called when the game starts or when spawned
+void AHomingMissileSystem::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Allocate room for the missiles and their instances, so the system doesn't allocate while playing
+	PositionsY.Reserve(Capacity);
+	PositionsZ.Reserve(Capacity);
+	VelocitiesY.Reserve(Capacity);
+	VelocitiesZ.Reserve(Capacity);
+	TargetIds.Reserve(Capacity);
+	AcquisitionTimers.Reserve(Capacity);
+	Ages.Reserve(Capacity);
+	Exploded.Reserve(Capacity);
+	ReserveInstances(Capacity);
+
+	// The targets are taken from the enemies of the current frame
+	AEnemySwarm* EnemySwarm = AEnemySwarm::GetEnemySwarm(GetWorld());
+	if (EnemySwarm)
+	{
+		AddTickPrerequisiteActor(EnemySwarm);
+	}
+	else
+	{
+		UE_LOG(LogHomingMissileSystem, Warning, TEXT("No enemy swarm available. The missiles won't find targets"));
+	}
+}
+
+// Called when the actor is removed from the level
+void AHomingMissileSystem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the counters to help sizing the capacity
+	UE_LOG(LogHomingMissileSystem, Verbose,
+		TEXT("%s: capacity %d, high-water mark %d, launched %d, hits %d, acquisitions %d"), *GetName(), Capacity,
+		Stats.HighWaterMark, Stats.Launched, Stats.Hits, Stats.Acquisitions);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void AHomingMissileSystem::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsMissiles);
+
+	Super::Tick(DeltaSeconds);
+
+	if (PositionsY.Num() == 0 && GetNumShown() == 0)
+	{
+		return;
+	}
+
+	// Get the viewport bounds
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
+	if (!PlayerController)
+	{
+		return;
+	}
+	FVector TopLeftBound;
+	FVector BottomRightBound;
+	if (!UProjectionUtil::GetCachedViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
+	{
+		UE_LOG(LogHomingMissileSystem, Error, TEXT("Failed to calculate the viewport bounds"));
+		return;
+	}
+
+	AEnemySwarm* EnemySwarm = AEnemySwarm::GetEnemySwarm(GetWorld());
+	AcquireTargets(DeltaSeconds, EnemySwarm);
+	SteerMissiles(DeltaSeconds, EnemySwarm);
+	HitEnemies(EnemySwarm);
+
+	const FBox2D CullBounds(FVector2D(TopLeftBound.Y - CullMargin, BottomRightBound.Z - CullMargin),
+		FVector2D(BottomRightBound.Y + CullMargin, TopLeftBound.Z + CullMargin));
+	RemoveMissiles(CullBounds);
+	UpdateInstances();
+}
+
+// Returns the homing missile system of the specified world or nullptr if the game mode doesn't provide one
+AHomingMissileSystem* AHomingMissileSystem::GetHomingMissileSystem(UWorld* World)
+{
+	AStageGameMode* GameMode = GetStageGameMode(World);
+	return GameMode ? GameMode->GetHomingMissileSystem() : nullptr;
+}
+
+// Launches a missile from the given location in the given direction of the gameplay plane
+void AHomingMissileSystem::LaunchMissile(const FVector& Location, const FVector2D& Direction)
+{
+	const FVector2D Velocity = Direction.GetSafeNormal() * Speed;
+	PositionsY.Add(Location.Y);
+	PositionsZ.Add(Location.Z);
+	VelocitiesY.Add(Velocity.X);
+	VelocitiesZ.Add(Velocity.Y);
+	TargetIds.Add(0);
+	AcquisitionTimers.Add(0.0f);
+	Ages.Add(0.0f);
+	Exploded.Add(false);
+
+	Stats.Launched++;
+	Stats.LiveMissiles = PositionsY.Num();
+	INC_DWORD_STAT(STAT_ZynapsLiveMissiles);
+	Stats.HighWaterMark = FMath::Max(Stats.HighWaterMark, Stats.LiveMissiles);
+}
+
+// Removes all the missiles
+void AHomingMissileSystem::ClearMissiles()
+{
+	DEC_DWORD_STAT_BY(STAT_ZynapsLiveMissiles, PositionsY.Num());
+	PositionsY.Reset();
+	PositionsZ.Reset();
+	VelocitiesY.Reset();
+	VelocitiesZ.Reset();
+	TargetIds.Reset();
+	AcquisitionTimers.Reset();
+	Ages.Reset();
+	Exploded.Reset();
+	Stats.LiveMissiles = 0;
+	UpdateInstances();
+}
+
+// Returns the activity of the missiles during the stage
+FHomingMissileStats AHomingMissileSystem::GetStats() const
+{
+	return Stats;
+}
+
+// Returns the mesh of the missiles
+TSoftObjectPtr<UStaticMesh> AHomingMissileSystem::GetInstanceMesh() const
+{
+	return MissileMesh;
+}
+
+// Finds new targets for the missiles due for an acquisition in a single batch
+void AHomingMissileSystem::AcquireTargets(float DeltaSeconds, AEnemySwarm* EnemySwarm)
+{
+	if (!EnemySwarm)
+	{
+		return;
+	}
+
+	// Gather the missiles whose interval has passed or whose target is gone
+	AcquiringMissiles.Reset();
+	AcquisitionLocations.Reset();
+	for (int32 Missile = 0; Missile < PositionsY.Num(); Missile++)
+	{
+		AcquisitionTimers[Missile] -= DeltaSeconds;
+		if (AcquisitionTimers[Missile] <= 0.0f ||
+			(TargetIds[Missile] != 0 && EnemySwarm->FindEnemy(TargetIds[Missile]) == INDEX_NONE))
+		{
+			AcquiringMissiles.Add(Missile);
+			AcquisitionLocations.Add(FVector2D(PositionsY[Missile], PositionsZ[Missile]));
+		}
+	}
+	if (AcquiringMissiles.Num() == 0)
+	{
+		return;
+	}
+
+	// A missile which finds nothing keeps flying straight until its next acquisition
+	EnemySwarm->FindNearestEnemies(AcquisitionLocations, AcquisitionDistance, AcquiredEnemies);
+	for (int32 Index = 0; Index < AcquiringMissiles.Num(); Index++)
+	{
+		const int32 Missile = AcquiringMissiles[Index];
+		const int32 Enemy = AcquiredEnemies[Index];
+		TargetIds[Missile] = Enemy != INDEX_NONE ? EnemySwarm->GetEnemyId(Enemy) : 0;
+		AcquisitionTimers[Missile] = ReacquisitionInterval;
+	}
+	Stats.Acquisitions += AcquiringMissiles.Num();
+}
+
+// Turns the missiles towards their targets and moves them
+void AHomingMissileSystem::SteerMissiles(float DeltaSeconds, AEnemySwarm* EnemySwarm)
+{
+	const int32 NumMissiles = PositionsY.Num();
+
+	// Resolve the location of the targets. The missiles without a target get no steering.
+	TargetsY.SetNumUninitialized(NumMissiles, false);
+	TargetsZ.SetNumUninitialized(NumMissiles, false);
+	SteeringWeights.SetNumUninitialized(NumMissiles, false);
+	for (int32 Missile = 0; Missile < NumMissiles; Missile++)
+	{
+		const int32 Enemy = EnemySwarm ? EnemySwarm->FindEnemy(TargetIds[Missile]) : INDEX_NONE;
+		const FVector2D Target = Enemy != INDEX_NONE ? EnemySwarm->GetEnemyLocation(Enemy) :
+			FVector2D(PositionsY[Missile], PositionsZ[Missile]);
+		TargetsY[Missile] = Target.X;
+		TargetsZ[Missile] = Target.Y;
+		SteeringWeights[Missile] = Enemy != INDEX_NONE ? 1.0f : 0.0f;
+	}
+
+	// Blend the velocity towards the direction of the target and keep the speed constant. The loop has no
+	// branches, so the compiler can vectorize it.
+	const float Blend = FMath::Min(TurnRate * DeltaSeconds, 1.0f);
+	float* RESTRICT Y = PositionsY.GetData();
+	float* RESTRICT Z = PositionsZ.GetData();
+	float* RESTRICT VelocityY = VelocitiesY.GetData();
+	float* RESTRICT VelocityZ = VelocitiesZ.GetData();
+	float* RESTRICT Age = Ages.GetData();
+	const float* RESTRICT TargetY = TargetsY.GetData();
+	const float* RESTRICT TargetZ = TargetsZ.GetData();
+	const float* RESTRICT Weight = SteeringWeights.GetData();
+	for (int32 Missile = 0; Missile < NumMissiles; Missile++)
+	{
+		const float DeltaY = TargetY[Missile] - Y[Missile];
+		const float DeltaZ = TargetZ[Missile] - Z[Missile];
+		const float DesiredScale = Speed * FMath::InvSqrt(DeltaY * DeltaY + DeltaZ * DeltaZ + KINDA_SMALL_NUMBER);
+		const float MissileBlend = Blend * Weight[Missile];
+		const float NewVelocityY = VelocityY[Missile] + (DeltaY * DesiredScale - VelocityY[Missile]) * MissileBlend;
+		const float NewVelocityZ = VelocityZ[Missile] + (DeltaZ * DesiredScale - VelocityZ[Missile]) * MissileBlend;
+		const float SpeedScale = Speed * FMath::InvSqrt(NewVelocityY * NewVelocityY + NewVelocityZ * NewVelocityZ +
+			KINDA_SMALL_NUMBER);
+		VelocityY[Missile] = NewVelocityY * SpeedScale;
+		VelocityZ[Missile] = NewVelocityZ * SpeedScale;
+		Y[Missile] += VelocityY[Missile] * DeltaSeconds;
+		Z[Missile] += VelocityZ[Missile] * DeltaSeconds;
+		Age[Missile] += DeltaSeconds;
+	}
+}
+
+// Damages the enemies hit by the missiles
+void AHomingMissileSystem::HitEnemies(AEnemySwarm* EnemySwarm)
+{
+	if (!EnemySwarm)
+	{
+		return;
+	}
+
+	for (int32 Missile = 0; Missile < PositionsY.Num(); Missile++)
+	{
+		HitCandidates.Reset();
+		EnemySwarm->QueryEnemies(FVector2D(PositionsY[Missile], PositionsZ[Missile]), MissileRadius, HitCandidates);
+		if (HitCandidates.Num() > 0)
+		{
+			EnemySwarm->DamageEnemy(HitCandidates[0], Damage);
+			Exploded[Missile] = true;
+			Stats.Hits++;
+		}
+	}
+}
+
+// Removes the missiles which hit an enemy, expired or left the screen
+void AHomingMissileSystem::RemoveMissiles(const FBox2D& CullBounds)
+{
+	for (int32 Missile = PositionsY.Num() - 1; Missile >= 0; Missile--)
+	{
+		if (Exploded[Missile] || Ages[Missile] > Lifetime ||
+			!CullBounds.IsInside(FVector2D(PositionsY[Missile], PositionsZ[Missile])))
+		{
+			RemoveAtSwap(Missile);
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_ZynapsLiveMissiles, Stats.LiveMissiles - PositionsY.Num());
+	Stats.LiveMissiles = PositionsY.Num();
+}
+
+// Removes a missile, filling the gap with the last one
+void AHomingMissileSystem::RemoveAtSwap(int32 Missile)
+{
+	PositionsY.RemoveAtSwap(Missile, 1, false);
+	PositionsZ.RemoveAtSwap(Missile, 1, false);
+	VelocitiesY.RemoveAtSwap(Missile, 1, false);
+	VelocitiesZ.RemoveAtSwap(Missile, 1, false);
+	TargetIds.RemoveAtSwap(Missile, 1, false);
+	AcquisitionTimers.RemoveAtSwap(Missile, 1, false);
+	Ages.RemoveAtSwap(Missile, 1, false);
+	Exploded.RemoveAtSwap(Missile, 1, false);
+}
+
+// Updates the instances to match the missiles
+void AHomingMissileSystem::UpdateInstances()
+{
+	const FQuat MeshRotation = MissileRotation.Quaternion();
+	const int32 NumMissiles = PositionsY.Num();
+	for (int32 Missile = 0; Missile < NumMissiles; Missile++)
+	{
+		const FQuat Heading = FRotationMatrix::MakeFromX(FVector(0.0f, VelocitiesY[Missile], VelocitiesZ[Missile]))
+			.ToQuat();
+		SetInstance(Missile, FTransform(Heading * MeshRotation, FVector(0.0f, PositionsY[Missile],
+			PositionsZ[Missile]), MissileScale));
+	}
+	SetNumShown(NumMissiles);
+}
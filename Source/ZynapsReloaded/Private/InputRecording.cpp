@@ -0,0 +1,212 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "InputRecording.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogInputRecording);
+
+// Writes an unsigned integer using 7 bits per byte. The high bit marks that more bytes follow.
+static void WriteVarInt(FArchive& Archive, uint32 Value)
+{
+	do
+	{
+		uint8 Byte = Value & 0x7F;
+		Value >>= 7;
+		if (Value != 0)
+		{
+			Byte |= 0x80;
+		}
+		Archive << Byte;
+	}
+	while (Value != 0);
+}
+
+// Reads an unsigned integer written with WriteVarInt
+static uint32 ReadVarInt(FArchive& Archive)
+{
+	uint32 Value = 0;
+	for (int32 Shift = 0; Shift < 32 && !Archive.IsError(); Shift += 7)
+	{
+		uint8 Byte = 0;
+		Archive << Byte;
+		Value |= (uint32)(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+	return Value;
+}
+
+// Creates an empty recording
+FInputRecording::FInputRecording()
+{
+	Reset(FString(), 0, 0.0f);
+}
+
+// Clears the recording and sets its header
+void FInputRecording::Reset(const FString& InStageName, int32 InSeed, float InTickRate)
+{
+	StageName = InStageName;
+	Seed = InSeed;
+	TickRate = InTickRate;
+	NumTicks = 0;
+	Events.Reset();
+}
+
+// Adds the input mask of the next tick
+void FInputRecording::AddTick(uint8 InputMask)
+{
+	// Only the changes are kept. The first tick is always kept, so the mask of any tick can be found.
+	if (Events.Num() == 0 || Events.Last().InputMask != InputMask)
+	{
+		FInputRecordingEvent Event;
+		Event.Tick = NumTicks;
+		Event.InputMask = InputMask;
+		Events.Add(Event);
+	}
+	NumTicks++;
+}
+
+// Returns the input mask of a tick
+uint8 FInputRecording::GetInputMask(uint32 Tick, int32& Cursor) const
+{
+	if (Events.Num() == 0)
+	{
+		return 0;
+	}
+
+	// Go back to the start if the ticks are not read in order
+	Cursor = FMath::Clamp(Cursor, 0, Events.Num() - 1);
+	if (Events[Cursor].Tick > Tick)
+	{
+		Cursor = 0;
+	}
+	while (Cursor + 1 < Events.Num() && Events[Cursor + 1].Tick <= Tick)
+	{
+		Cursor++;
+	}
+	return Events[Cursor].Tick <= Tick ? Events[Cursor].InputMask : 0;
+}
+
+// Returns the number of recorded ticks
+uint32 FInputRecording::GetNumTicks() const
+{
+	return NumTicks;
+}
+
+// Returns the number of input changes
+int32 FInputRecording::GetNumEvents() const
+{
+	return Events.Num();
+}
+
+// Returns the name of the recorded stage
+const FString& FInputRecording::GetStageName() const
+{
+	return StageName;
+}
+
+// Returns the random seed used during the recording
+int32 FInputRecording::GetSeed() const
+{
+	return Seed;
+}
+
+// Returns the fixed tick rate used during the recording, or 0 if the time step was variable
+float FInputRecording::GetTickRate() const
+{
+	return TickRate;
+}
+
+// Saves the recording to a file. Returns false on error.
+bool FInputRecording::SaveToFile(const FString& FileName)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	if (!Serialize(Writer))
+	{
+		return false;
+	}
+	return FFileHelper::SaveArrayToFile(Data, *FileName);
+}
+
+// Loads the recording from a file. Returns false on error.
+bool FInputRecording::LoadFromFile(const FString& FileName)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *FileName))
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("Failed to read the input recording %s"), *FileName);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	if (!Serialize(Reader))
+	{
+		UE_LOG(LogInputRecording, Error, TEXT("The file %s is not a valid input recording"), *FileName);
+		Reset(FString(), 0, 0.0f);
+		return false;
+	}
+	return true;
+}
+
+// Returns the full path of a recording
+FString FInputRecording::GetRecordingPath(const FString& Name)
+{
+	FString FileName = Name;
+	if (FPaths::GetExtension(FileName).IsEmpty())
+	{
+		FileName += InputRecordingExtension;
+	}
+	if (FPaths::GetPath(FileName).IsEmpty())
+	{
+		FileName = FPaths::ProjectSavedDir() / TEXT("InputRecordings") / FileName;
+	}
+	return FileName;
+}
+
+// Serializes the recording
+bool FInputRecording::Serialize(FArchive& Archive)
+{
+	// Header
+	uint32 Magic = InputRecordingMagic;
+	uint32 Version = InputRecordingVersion;
+	Archive << Magic << Version;
+	if (Magic != InputRecordingMagic || Version != InputRecordingVersion)
+	{
+		return false;
+	}
+	Archive << StageName << Seed << TickRate << NumTicks;
+
+	// Input changes, delta-encoded
+	int32 NumEvents = Events.Num();
+	Archive << NumEvents;
+	if (Archive.IsLoading())
+	{
+		if (NumEvents < 0 || NumEvents > Archive.TotalSize())
+		{
+			return false;
+		}
+		Events.SetNumUninitialized(NumEvents);
+	}
+
+	uint32 PreviousTick = 0;
+	for (FInputRecordingEvent& Event : Events)
+	{
+		if (Archive.IsLoading())
+		{
+			Event.Tick = PreviousTick + ReadVarInt(Archive);
+		}
+		else
+		{
+			WriteVarInt(Archive, Event.Tick - PreviousTick);
+		}
+		Archive << Event.InputMask;
+		PreviousTick = Event.Tick;
+	}
+	return !Archive.IsError();
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "InputTiming.h"
+
+// Registers a press of the button at the given time
+void FInputTiming::Press(uint8 ButtonBit, double Time)
+{
+	FButtonTiming& Button = Buttons[GetButtonIndex(ButtonBit)];
+	if (Button.bHeld)
+	{
+		return;
+	}
+	Button.PreviousPressTime = Button.PressTime;
+	Button.PressTime = Time;
+	Button.bHeld = true;
+}
+
+// Registers a release of the button at the given time
+void FInputTiming::Release(uint8 ButtonBit, double Time)
+{
+	FButtonTiming& Button = Buttons[GetButtonIndex(ButtonBit)];
+	if (!Button.bHeld)
+	{
+		return;
+	}
+	Button.ReleaseTime = FMath::Max(Time, Button.PressTime);
+	Button.bHeld = false;
+}
+
+// Forgets all the presses and releases
+void FInputTiming::Reset()
+{
+	for (FButtonTiming& Button : Buttons)
+	{
+		Button = FButtonTiming();
+	}
+}
+
+// Returns whether the button is held down
+bool FInputTiming::IsHeld(uint8 ButtonBit) const
+{
+	return Buttons[GetButtonIndex(ButtonBit)].bHeld;
+}
+
+// Returns how long the button has been held at the given time, or 0 if it is not held
+double FInputTiming::GetHoldDuration(uint8 ButtonBit, double Now) const
+{
+	const FButtonTiming& Button = Buttons[GetButtonIndex(ButtonBit)];
+	return Button.bHeld ? FMath::Max(Now - Button.PressTime, 0.0) : 0.0;
+}
+
+// Returns how long the button was held the last time it was released, or 0 if it was never released
+double FInputTiming::GetLastHoldDuration(uint8 ButtonBit) const
+{
+	const FButtonTiming& Button = Buttons[GetButtonIndex(ButtonBit)];
+	return Button.ReleaseTime >= 0.0 && Button.ReleaseTime >= Button.PressTime ?
+		Button.ReleaseTime - Button.PressTime : 0.0;
+}
+
+// Returns whether the last press came within the given time window after the previous one
+bool FInputTiming::IsDoubleTap(uint8 ButtonBit, double Window) const
+{
+	const FButtonTiming& Button = Buttons[GetButtonIndex(ButtonBit)];
+	return Button.PreviousPressTime >= 0.0 && Button.PressTime - Button.PreviousPressTime <= Window;
+}
+
+// Returns the charge level between 0 and 1 of a button held at the given time
+float FInputTiming::GetChargeLevel(uint8 ButtonBit, double Now, double FullChargeTime) const
+{
+	if (FullChargeTime <= 0.0)
+	{
+		return IsHeld(ButtonBit) ? 1.0f : 0.0f;
+	}
+	return (float)FMath::Clamp(GetHoldDuration(ButtonBit, Now) / FullChargeTime, 0.0, 1.0);
+}
+
+// Returns the timing of a button
+const FButtonTiming& FInputTiming::GetButtonTiming(uint8 ButtonBit) const
+{
+	return Buttons[GetButtonIndex(ButtonBit)];
+}
+
+// Returns the index of a button from its bit
+int32 FInputTiming::GetButtonIndex(uint8 ButtonBit)
+{
+	check(ButtonBit != 0);
+	return (int32)FMath::FloorLog2(ButtonBit);
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "InstancedBatchSystem.h"
+#include "StageAssetPreloader.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogInstancedBatchSystem);
+
+// Transform of the instances which don't show an element
+static const FTransform HiddenInstanceTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+// Sets default values
+AInstancedBatchSystem::AInstancedBatchSystem() : Super()
+{
+	// Set up the instances component. The systems check the collisions themselves, so the instances have no bodies.
+	InstancesComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("InstancesComponent"));
+	InstancesComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InstancesComponent->SetGenerateOverlapEvents(false);
+	InstancesComponent->SetMobility(EComponentMobility::Movable);
+	InstancesComponent->CastShadow = false;
+	RootComponent = InstancesComponent;
+
+	NumShownInstances = 0;
+}
+
+// Called when the game starts or when spawned
+void AInstancedBatchSystem::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Set up the components once the assets are loaded. They are usually preloaded while the stage prepares.
+	TArray<FSoftObjectPath> Assets;
+	GetPreloadAssets(Assets);
+	AStageAssetPreloader::RequestAssets(GetWorld(), Assets,
+		FSimpleDelegate::CreateUObject(this, &AInstancedBatchSystem::AssetsLoaded));
+}
+
+// Returns the soft references to the assets of the system
+void AInstancedBatchSystem::GetPreloadAssets(TArray<FSoftObjectPath>& Assets) const
+{
+	const TSoftObjectPtr<UStaticMesh> InstanceMesh = GetInstanceMesh();
+	if (!InstanceMesh.IsNull())
+	{
+		Assets.Add(InstanceMesh.ToSoftObjectPath());
+	}
+}
+
+// Returns the stage game mode of the specified world or nullptr if there is none
+AStageGameMode* AInstancedBatchSystem::GetStageGameMode(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	return WorldContext ? WorldContext->GetStageGameMode() : nullptr;
+}
+
+// Returns the mesh of the instances
+TSoftObjectPtr<UStaticMesh> AInstancedBatchSystem::GetInstanceMesh() const
+{
+	return TSoftObjectPtr<UStaticMesh>();
+}
+
+// Called when the assets of the system are loaded
+void AInstancedBatchSystem::AssetsLoaded()
+{
+	// Blueprints may set their own mesh on the component
+	const TSoftObjectPtr<UStaticMesh> InstanceMesh = GetInstanceMesh();
+	if (!InstancesComponent->GetStaticMesh() && !InstanceMesh.IsNull())
+	{
+		InstancesComponent->SetStaticMesh(InstanceMesh.Get());
+		if (!InstanceMesh.Get())
+		{
+			UE_LOG(LogInstancedBatchSystem, Error, TEXT("The asset %s was not found"), *InstanceMesh.ToString());
+		}
+	}
+}
+
+// Adds hidden instances until the component holds the given number
+void AInstancedBatchSystem::ReserveInstances(int32 NumInstances)
+{
+	while (InstancesComponent->GetInstanceCount() < NumInstances)
+	{
+		InstancesComponent->AddInstanceWorldSpace(HiddenInstanceTransform);
+	}
+}
+
+// Places the instance of the element with the given index
+void AInstancedBatchSystem::SetInstance(int32 Index, const FTransform& Transform)
+{
+	ReserveInstances(Index + 1);
+	InstancesComponent->UpdateInstanceTransform(Index, Transform, true, false, true);
+}
+
+// Sets the number of elements shown after their instances were placed
+void AInstancedBatchSystem::SetNumShown(int32 NumShown)
+{
+	// The instances of the elements removed since the last update are collapsed instead of removed, so the
+	// instance buffer keeps its size
+	for (int32 Index = NumShown; Index < NumShownInstances; Index++)
+	{
+		InstancesComponent->UpdateInstanceTransform(Index, HiddenInstanceTransform, true, false, true);
+	}
+
+	// Mark the render state dirty once for the whole update
+	if (NumShown > 0 || NumShownInstances > 0)
+	{
+		InstancesComponent->MarkRenderStateDirty();
+	}
+	NumShownInstances = NumShown;
+}
+
+// Returns the number of elements shown in the last update
+int32 AInstancedBatchSystem::GetNumShown() const
+{
+	return NumShownInstances;
+}
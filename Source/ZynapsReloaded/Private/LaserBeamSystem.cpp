@@ -0,0 +1,271 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "LaserBeamSystem.h"
+#include "EnemySwarm.h"
+#include "ProjectionUtil.h"
+#include "StageDistanceField.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogLaserBeamSystem);
+
+// Sets default values
+ALaserBeamSystem::ALaserBeamSystem() : Super()
+{
+	// Tick after the enemy swarm, so the sweeps use the enemies of the current frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Assets streamed in by the stage asset preloader. The mesh is a placeholder stretched along its X axis.
+	BeamMesh = FSoftObjectPath(TEXT("StaticMesh'/Engine/BasicShapes/Cube.Cube'"));
+	BeamMeshSize = 100.0f;
+
+	// Init beam vars
+	Speed = 4000.0f;
+	BeamRadius = 10.0f;
+	LengthPerLaserPower = 120.0f;
+	DamagePerLaserPower = 1;
+	Capacity = DefaultLaserBeamCapacity;
+	CullMargin = 200.0f;
+}
+
+// Called when the game starts or when spawned
+void ALaserBeamSystem::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Allocate room for the beams and their instances, so the system doesn't allocate while playing
+	HeadsY.Reserve(Capacity);
+	HeadsZ.Reserve(Capacity);
+	DirectionsY.Reserve(Capacity);
+	DirectionsZ.Reserve(Capacity);
+	Travelled.Reserve(Capacity);
+	Lengths.Reserve(Capacity);
+	Damages.Reserve(Capacity);
+	Stopped.Reserve(Capacity);
+	ReserveInstances(Capacity);
+
+	// The beams hit the enemies of the current frame
+	AEnemySwarm* EnemySwarm = AEnemySwarm::GetEnemySwarm(GetWorld());
+	if (EnemySwarm)
+	{
+		AddTickPrerequisiteActor(EnemySwarm);
+	}
+	else
+	{
+		UE_LOG(LogLaserBeamSystem, Warning, TEXT("No enemy swarm available. The beams won't hit enemies"));
+	}
+}
+
+// Called when the actor is removed from the level
+void ALaserBeamSystem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the counters to help sizing the capacity
+	UE_LOG(LogLaserBeamSystem, Verbose,
+		TEXT("Laser beams: capacity %d, high-water mark %d, fired %d, enemy hits %d, terrain hits %d"), Capacity,
+		Stats.HighWaterMark, Stats.Fired, Stats.EnemyHits, Stats.TerrainHits);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void ALaserBeamSystem::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsLaserBeams);
+
+	Super::Tick(DeltaSeconds);
+
+	if (HeadsY.Num() == 0 && GetNumShown() == 0)
+	{
+		return;
+	}
+
+	// Get the viewport bounds
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
+	if (!PlayerController)
+	{
+		return;
+	}
+	FVector TopLeftBound;
+	FVector BottomRightBound;
+	if (!UProjectionUtil::GetCachedViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
+	{
+		UE_LOG(LogLaserBeamSystem, Error, TEXT("Failed to calculate the viewport bounds"));
+		return;
+	}
+
+	MoveBeams(DeltaSeconds);
+	HitTargets(AEnemySwarm::GetEnemySwarm(GetWorld()));
+
+	const FBox2D CullBounds(FVector2D(TopLeftBound.Y - CullMargin, BottomRightBound.Z - CullMargin),
+		FVector2D(BottomRightBound.Y + CullMargin, TopLeftBound.Z + CullMargin));
+	RemoveBeams(CullBounds);
+	UpdateInstances();
+}
+
+// Returns the laser beam system of the specified world or nullptr if the game mode doesn't provide one
+ALaserBeamSystem* ALaserBeamSystem::GetLaserBeamSystem(UWorld* World)
+{
+	AStageGameMode* GameMode = GetStageGameMode(World);
+	return GameMode ? GameMode->GetLaserBeamSystem() : nullptr;
+}
+
+// Fires a beam of the given laser power from the given location in the given direction of the gameplay plane
+void ALaserBeamSystem::FireBeam(const FVector& Location, const FVector2D& Direction, uint8 LaserPower,
+	float ElapsedSeconds)
+{
+	// The head starts at the cannon, so the first sweep covers the travel since the moment of the shot
+	const FVector2D UnitDirection = Direction.GetSafeNormal();
+	HeadsY.Add(Location.Y);
+	HeadsZ.Add(Location.Z);
+	DirectionsY.Add(UnitDirection.X);
+	DirectionsZ.Add(UnitDirection.Y);
+	Travelled.Add(0.0f);
+	Lengths.Add(LengthPerLaserPower * FMath::Max<uint8>(LaserPower, 1));
+	Damages.Add(DamagePerLaserPower * FMath::Max<uint8>(LaserPower, 1));
+	Stopped.Add(false);
+	if (ElapsedSeconds > 0.0f)
+	{
+		const int32 Beam = HeadsY.Num() - 1;
+		HeadsY[Beam] += UnitDirection.X * Speed * ElapsedSeconds;
+		HeadsZ[Beam] += UnitDirection.Y * Speed * ElapsedSeconds;
+		Travelled[Beam] = Speed * ElapsedSeconds;
+	}
+
+	Stats.Fired++;
+	Stats.HighWaterMark = FMath::Max(Stats.HighWaterMark, HeadsY.Num());
+}
+
+// Removes all the beams
+void ALaserBeamSystem::ClearBeams()
+{
+	HeadsY.Reset();
+	HeadsZ.Reset();
+	DirectionsY.Reset();
+	DirectionsZ.Reset();
+	Travelled.Reset();
+	Lengths.Reset();
+	Damages.Reset();
+	Stopped.Reset();
+	UpdateInstances();
+}
+
+// Returns the activity of the beams during the stage
+FLaserBeamStats ALaserBeamSystem::GetStats() const
+{
+	return Stats;
+}
+
+// Returns the mesh of the beams
+TSoftObjectPtr<UStaticMesh> ALaserBeamSystem::GetInstanceMesh() const
+{
+	return BeamMesh;
+}
+
+// Moves the beams and gathers the segments swept since the previous frame
+void ALaserBeamSystem::MoveBeams(float DeltaSeconds)
+{
+	const int32 NumBeams = HeadsY.Num();
+	SweepStarts.SetNumUninitialized(NumBeams, false);
+	SweepEnds.SetNumUninitialized(NumBeams, false);
+	const float Step = Speed * DeltaSeconds;
+	for (int32 Beam = 0; Beam < NumBeams; Beam++)
+	{
+		// The beam covered everything from its old tail to its new head
+		SweepStarts[Beam] = GetTail(Beam);
+		HeadsY[Beam] += DirectionsY[Beam] * Step;
+		HeadsZ[Beam] += DirectionsZ[Beam] * Step;
+		Travelled[Beam] += Step;
+		SweepEnds[Beam] = FVector2D(HeadsY[Beam], HeadsZ[Beam]);
+	}
+}
+
+// Tests the swept segments against the enemies and the scenery, stopping the beams at the first contact
+void ALaserBeamSystem::HitTargets(AEnemySwarm* EnemySwarm)
+{
+	const int32 NumBeams = HeadsY.Num();
+	if (NumBeams == 0)
+	{
+		return;
+	}
+
+	// All the segments are swept against the enemy grid in one batch
+	if (EnemySwarm)
+	{
+		EnemySwarm->SweepEnemies(SweepStarts, SweepEnds, BeamRadius, SweptEnemies, SweptFractions);
+	}
+	else
+	{
+		SweptEnemies.Init(INDEX_NONE, NumBeams);
+		SweptFractions.Init(1.0f, NumBeams);
+	}
+
+	// An enemy only takes the hit if the beam reaches it before the scenery
+	AStageGameMode* GameMode = GetStageGameMode(GetWorld());
+	const UStageDistanceField* DistanceField = GameMode ? GameMode->GetStageDistanceField() : nullptr;
+	for (int32 Beam = 0; Beam < NumBeams; Beam++)
+	{
+		float TerrainFraction = 1.0f;
+		const bool bTerrainHit = DistanceField &&
+			DistanceField->SweepSegment(SweepStarts[Beam], SweepEnds[Beam], BeamRadius, TerrainFraction);
+		const int32 Enemy = SweptEnemies[Beam];
+		if (Enemy != INDEX_NONE && (!bTerrainHit || SweptFractions[Beam] <= TerrainFraction))
+		{
+			EnemySwarm->DamageEnemy(Enemy, Damages[Beam]);
+			Stopped[Beam] = true;
+			Stats.EnemyHits++;
+		}
+		else if (bTerrainHit)
+		{
+			Stopped[Beam] = true;
+			Stats.TerrainHits++;
+		}
+	}
+}
+
+// Removes the beams which hit something or left the screen
+void ALaserBeamSystem::RemoveBeams(const FBox2D& CullBounds)
+{
+	for (int32 Beam = HeadsY.Num() - 1; Beam >= 0; Beam--)
+	{
+		if (Stopped[Beam] || !CullBounds.IsInside(GetTail(Beam)))
+		{
+			HeadsY.RemoveAtSwap(Beam, 1, false);
+			HeadsZ.RemoveAtSwap(Beam, 1, false);
+			DirectionsY.RemoveAtSwap(Beam, 1, false);
+			DirectionsZ.RemoveAtSwap(Beam, 1, false);
+			Travelled.RemoveAtSwap(Beam, 1, false);
+			Lengths.RemoveAtSwap(Beam, 1, false);
+			Damages.RemoveAtSwap(Beam, 1, false);
+			Stopped.RemoveAtSwap(Beam, 1, false);
+		}
+	}
+}
+
+// Updates the instances to match the beams
+void ALaserBeamSystem::UpdateInstances()
+{
+	const float InvMeshSize = 1.0f / BeamMeshSize;
+	const int32 NumBeams = HeadsY.Num();
+	for (int32 Beam = 0; Beam < NumBeams; Beam++)
+	{
+		const FVector2D Head(HeadsY[Beam], HeadsZ[Beam]);
+		const FVector2D Tail = GetTail(Beam);
+		const FVector2D Center = (Head + Tail) / 2;
+		const FQuat Heading = FRotationMatrix::MakeFromX(FVector(0.0f, DirectionsY[Beam], DirectionsZ[Beam])).ToQuat();
+		const FVector Scale(FVector2D::Distance(Head, Tail) * InvMeshSize, 2.0f * BeamRadius * InvMeshSize,
+			2.0f * BeamRadius * InvMeshSize);
+		SetInstance(Beam, FTransform(Heading, FVector(0.0f, Center.X, Center.Y), Scale));
+	}
+	SetNumShown(NumBeams);
+}
+
+// Returns the tail of a beam, which grows from the cannon until the beam reaches its length
+FVector2D ALaserBeamSystem::GetTail(int32 Beam) const
+{
+	const float Length = FMath::Min(Lengths[Beam], Travelled[Beam]);
+	return FVector2D(HeadsY[Beam] - DirectionsY[Beam] * Length, HeadsZ[Beam] - DirectionsZ[Beam] * Length);
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "PerformanceUtil.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogPerformanceUtil);
+
+// Console variable which shows the performance overlay
+static TAutoConsoleVariable<int32> CVarPerfOverlay(
+	TEXT("Zynaps.PerfOverlay"),
+	0,
+	TEXT("Shows the performance overlay of the gameplay module.\n")
+	TEXT("0: hidden, 1: visible"),
+	ECVF_Default);
+
+// Counters shared by all the worlds. Only the game thread updates them.
+static int32 LiveProjectiles = 0;
+static int32 LiveFuelCapsules = 0;
+
+// Spawns counted since SpawnWindowStart, and the rate measured over the last complete window
+static int32 SpawnsInWindow = 0;
+static double SpawnWindowStart = 0.0;
+static float SpawnsPerSecond = 0.0f;
+
+// Closes the spawn window once a second has elapsed
+static void UpdateSpawnWindow()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = Now - SpawnWindowStart;
+	if (Elapsed >= 1.0)
+	{
+		// Windows without any spawn are counted too, so the rate drops to zero
+		SpawnsPerSecond = SpawnWindowStart > 0.0 ? (float)(SpawnsInWindow / Elapsed) : 0.0f;
+		SpawnsInWindow = 0;
+		SpawnWindowStart = Now;
+	}
+}
+
+// Adds the given amount to the number of live projectiles
+void UPerformanceUtil::AddLiveProjectiles(int32 Delta)
+{
+	LiveProjectiles = FMath::Max(LiveProjectiles + Delta, 0);
+	SET_DWORD_STAT(STAT_ZynapsLiveProjectiles, LiveProjectiles);
+}
+
+// Adds the given amount to the number of live fuel capsules
+void UPerformanceUtil::AddLiveFuelCapsules(int32 Delta)
+{
+	LiveFuelCapsules = FMath::Max(LiveFuelCapsules + Delta, 0);
+	SET_DWORD_STAT(STAT_ZynapsLiveFuelCapsules, LiveFuelCapsules);
+}
+
+// Records that a gameplay actor was spawned
+void UPerformanceUtil::RecordSpawn()
+{
+	UpdateSpawnWindow();
+	SpawnsInWindow++;
+	INC_DWORD_STAT(STAT_ZynapsSpawns);
+}
+
+// Returns a snapshot of the performance counters
+FZynapsPerformanceStats UPerformanceUtil::GetPerformanceStats()
+{
+	UpdateSpawnWindow();
+
+	FZynapsPerformanceStats Stats;
+	Stats.FrameTime = (float)(FApp::GetDeltaTime() * 1000.0);
+	Stats.GameThreadTime = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	Stats.FramesPerSecond = FApp::GetDeltaTime() > 0.0 ? (float)(1.0 / FApp::GetDeltaTime()) : 0.0f;
+	Stats.LiveProjectiles = LiveProjectiles;
+	Stats.LiveFuelCapsules = LiveFuelCapsules;
+	Stats.SpawnsPerSecond = SpawnsPerSecond;
+	return Stats;
+}
+
+// Returns true if the performance overlay is enabled with the console variable Zynaps.PerfOverlay
+bool UPerformanceUtil::IsPerformanceOverlayEnabled()
+{
+	return CVarPerfOverlay.GetValueOnGameThread() != 0;
+}
+
+// Draws the performance overlay if it is enabled
+void UPerformanceUtil::DrawPerformanceOverlay(UCanvas* Canvas, APlayerController* PlayerController)
+{
+	if (!Canvas || !IsPerformanceOverlayEnabled())
+	{
+		return;
+	}
+
+	UFont* Font = GEngine->GetSmallFont();
+	if (!Font)
+	{
+		UE_LOG(LogPerformanceUtil, Error, TEXT("Failed to retrieve the font for the performance overlay"));
+		return;
+	}
+
+	const FZynapsPerformanceStats Stats = GetPerformanceStats();
+	const FString Lines[] =
+	{
+		FString::Printf(TEXT("Frame: %.2f ms (%.0f fps)"), Stats.FrameTime, Stats.FramesPerSecond),
+		FString::Printf(TEXT("Game thread: %.2f ms"), Stats.GameThreadTime),
+		FString::Printf(TEXT("Projectiles: %d"), Stats.LiveProjectiles),
+		FString::Printf(TEXT("Fuel capsules: %d"), Stats.LiveFuelCapsules),
+		FString::Printf(TEXT("Spawns/s: %.1f"), Stats.SpawnsPerSecond)
+	};
+
+	// Draw the lines at the top left corner of the canvas
+	const float LineHeight = Font->GetMaxCharHeight();
+	float Y = 48.0f;
+	Canvas->SetDrawColor(FColor::Yellow);
+	for (const FString& Line : Lines)
+	{
+		Canvas->DrawText(Font, Line, 16.0f, Y);
+		Y += LineHeight;
+	}
+}
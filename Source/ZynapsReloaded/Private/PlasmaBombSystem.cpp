@@ -0,0 +1,205 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "PlasmaBombSystem.h"
+#include "EnemySwarm.h"
+#include "StageGameMode.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogPlasmaBombSystem);
+
+// Sets default values
+APlasmaBombSystem::APlasmaBombSystem() : Super()
+{
+	// Tick after the enemy swarm, so the query uses the enemies of the current frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Assets streamed in by the stage asset preloader. The mesh is a placeholder.
+	BlastMesh = FSoftObjectPath(TEXT("StaticMesh'/Engine/BasicShapes/Sphere.Sphere'"));
+	BlastMeshRadius = 50.0f;
+
+	// Init bomb vars
+	MaxRadius = 1200.0f;
+	ExpansionTime = 0.6f;
+	Damage = 10;
+	Capacity = DefaultPlasmaBombCapacity;
+}
+
+// Called when the game starts or when spawned
+void APlasmaBombSystem::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Allocate room for the bombs and their instances, so the system doesn't allocate while playing
+	PositionsY.Reserve(Capacity);
+	PositionsZ.Reserve(Capacity);
+	Radii.Reserve(Capacity);
+	Ages.Reserve(Capacity);
+	DamagedEnemies.Reserve(Capacity);
+	ReserveInstances(Capacity);
+
+	// The blasts hit the enemies of the current frame
+	AEnemySwarm* EnemySwarm = AEnemySwarm::GetEnemySwarm(GetWorld());
+	if (EnemySwarm)
+	{
+		AddTickPrerequisiteActor(EnemySwarm);
+	}
+	else
+	{
+		UE_LOG(LogPlasmaBombSystem, Warning, TEXT("No enemy swarm available. The bombs won't hit anything"));
+	}
+}
+
+// Called when the actor is removed from the level
+void APlasmaBombSystem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the counters to help tuning the blasts
+	UE_LOG(LogPlasmaBombSystem, Verbose, TEXT("Plasma bombs: detonated %d, hits %d, queries %d"), Stats.Detonated,
+		Stats.Hits, Stats.Queries);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void APlasmaBombSystem::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsPlasmaBombs);
+
+	Super::Tick(DeltaSeconds);
+
+	if (PositionsY.Num() == 0 && GetNumShown() == 0)
+	{
+		return;
+	}
+
+	ExpandBlasts(DeltaSeconds);
+	HitEnemies(AEnemySwarm::GetEnemySwarm(GetWorld()));
+	RemoveBombs();
+	UpdateInstances();
+}
+
+// Returns the plasma bomb system of the specified world or nullptr if the game mode doesn't provide one
+APlasmaBombSystem* APlasmaBombSystem::GetPlasmaBombSystem(UWorld* World)
+{
+	AStageGameMode* GameMode = GetStageGameMode(World);
+	return GameMode ? GameMode->GetPlasmaBombSystem() : nullptr;
+}
+
+// Detonates a bomb at the given location
+void APlasmaBombSystem::DetonateBomb(const FVector& Location)
+{
+	PositionsY.Add(Location.Y);
+	PositionsZ.Add(Location.Z);
+	Radii.Add(0.0f);
+	Ages.Add(0.0f);
+	DamagedEnemies.AddDefaulted();
+	Stats.Detonated++;
+}
+
+// Removes all the bombs
+void APlasmaBombSystem::ClearBombs()
+{
+	PositionsY.Reset();
+	PositionsZ.Reset();
+	Radii.Reset();
+	Ages.Reset();
+	DamagedEnemies.Reset();
+	UpdateInstances();
+}
+
+// Returns the activity of the bombs during the stage
+FPlasmaBombStats APlasmaBombSystem::GetStats() const
+{
+	return Stats;
+}
+
+// Returns the mesh of the blasts
+TSoftObjectPtr<UStaticMesh> APlasmaBombSystem::GetInstanceMesh() const
+{
+	return BlastMesh;
+}
+
+// Expands the blasts
+void APlasmaBombSystem::ExpandBlasts(float DeltaSeconds)
+{
+	const float InvExpansionTime = 1.0f / ExpansionTime;
+	for (int32 Bomb = 0; Bomb < PositionsY.Num(); Bomb++)
+	{
+		Ages[Bomb] += DeltaSeconds;
+		Radii[Bomb] = MaxRadius * FMath::Min(Ages[Bomb] * InvExpansionTime, 1.0f);
+	}
+}
+
+// Damages the enemies reached by the blasts with a single region query
+void APlasmaBombSystem::HitEnemies(AEnemySwarm* EnemySwarm)
+{
+	if (!EnemySwarm || PositionsY.Num() == 0)
+	{
+		return;
+	}
+
+	// A single query covers the bounds of all the blasts
+	FBox2D Bounds(ForceInit);
+	for (int32 Bomb = 0; Bomb < PositionsY.Num(); Bomb++)
+	{
+		const FVector2D Center(PositionsY[Bomb], PositionsZ[Bomb]);
+		const FVector2D Extent(Radii[Bomb], Radii[Bomb]);
+		Bounds += Center - Extent;
+		Bounds += Center + Extent;
+	}
+	Candidates.Reset();
+	EnemySwarm->QueryEnemies(Bounds, Candidates);
+	Stats.Queries++;
+
+	// Each bomb damages the candidates within its blast which it didn't reach before
+	for (int32 Bomb = 0; Bomb < PositionsY.Num(); Bomb++)
+	{
+		const float RadiusSum = Radii[Bomb] + EnemySwarm->EnemyRadius;
+		for (const int32 Enemy : Candidates)
+		{
+			const FVector2D Delta = EnemySwarm->GetEnemyLocation(Enemy) - FVector2D(PositionsY[Bomb], PositionsZ[Bomb]);
+			if (Delta.SizeSquared() > RadiusSum * RadiusSum || !EnemySwarm->IsEnemyAlive(Enemy))
+			{
+				continue;
+			}
+
+			bool bAlreadyDamaged = false;
+			DamagedEnemies[Bomb].Add(EnemySwarm->GetEnemyId(Enemy), &bAlreadyDamaged);
+			if (!bAlreadyDamaged)
+			{
+				EnemySwarm->DamageEnemy(Enemy, Damage);
+				Stats.Hits++;
+			}
+		}
+	}
+}
+
+// Removes the blasts which finished expanding
+void APlasmaBombSystem::RemoveBombs()
+{
+	for (int32 Bomb = PositionsY.Num() - 1; Bomb >= 0; Bomb--)
+	{
+		if (Ages[Bomb] >= ExpansionTime)
+		{
+			PositionsY.RemoveAtSwap(Bomb, 1, false);
+			PositionsZ.RemoveAtSwap(Bomb, 1, false);
+			Radii.RemoveAtSwap(Bomb, 1, false);
+			Ages.RemoveAtSwap(Bomb, 1, false);
+			DamagedEnemies.RemoveAtSwap(Bomb, 1, false);
+		}
+	}
+}
+
+// Updates the instances to match the blasts
+void APlasmaBombSystem::UpdateInstances()
+{
+	const float InvMeshRadius = 1.0f / BlastMeshRadius;
+	const int32 NumBombs = PositionsY.Num();
+	for (int32 Bomb = 0; Bomb < NumBombs; Bomb++)
+	{
+		SetInstance(Bomb, FTransform(FQuat::Identity, FVector(0.0f, PositionsY[Bomb], PositionsZ[Bomb]),
+			FVector(Radii[Bomb] * InvMeshRadius)));
+	}
+	SetNumShown(NumBombs);
+}
@@ -5,6 +5,18 @@
 #include "ProjectionUtil.h"
 #include "ZynapsWorldSettings.h"
 #include "FuelCapsule.h"
+#include "ProjectilePool.h"
+#include "ZynapsWorldContext.h"
+#include "CollisionManager.h"
+#include "PerformanceUtil.h"
+#include "GameplayAudioManager.h"
+#include "EffectsPool.h"
+#include "StageAssetPreloader.h"
+#include "HomingMissileSystem.h"
+#include "SeekerMissileSystem.h"
+#include "PlasmaBombSystem.h"
+#include "LaserBeamSystem.h"
+#include "StageTerrainMap.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogPlayerPawn);
@@ -24,6 +36,13 @@ APlayerPawn::APlayerPawn() : Super()
 	// Set up the mesh component
 	MeshComponent = CreateMeshComponent(CapsuleComponent);
 
+	// Assets streamed in by the stage asset preloader. They are applied to the components once loaded.
+	ShipMesh = FSoftObjectPath(TEXT("StaticMesh'/Game/Models/Ship/zynaps_ship.zynaps_ship'"));
+	EngineThrustTemplate = FSoftObjectPath(
+		TEXT("ParticleSystem'/Game/Models/ThrustParticle/EngineThrustSystem.EngineThrustSystem'"));
+	ExplosionTemplate = FSoftObjectPath(TEXT("ParticleSystem'/Game/Models/Explosion/ExplosionSystem.ExplosionSystem'"));
+	DynMaterial = nullptr;
+
 	// Set up the engine thrust particle system
 	EngineThrustSocketName = TEXT("EngineThrust");
 	EnginePartSystemComponent = CreateEngineThrustParticleSystem(MeshComponent, EngineThrustSocketName);
@@ -31,18 +50,48 @@ APlayerPawn::APlayerPawn() : Super()
 	// Set up the movement component
 	MovementComponent = CreateMovementComponent();
 
-	// Set up the explosion particle system
-	ExplosionPartSystem = CreateExplosionParticleSystem();
+	// Set up the explosion particle system. It is taken from ExplosionTemplate once loaded unless one is set.
+	ExplosionPartSystem = nullptr;
+	ExplosionPoolCapacity = 1;
+	ExplosionPoolBudget = 2;
 
 	// Sets this pawn to be controlled by the lowest-numbered player
 	AutoPossessPlayer = EAutoReceiveInput::Player0;
 
 	// Init shooting vars
 	ProjectileClass = APlayerProjectile::StaticClass();
+	ProjectilePoolCapacity = DefaultProjectilePoolCapacity;
 	LeftCannonSocketName = FName("LeftCannon");
 	RightCannonSocketName = FName("RightCannon");
 	TopCannonSocketName = FName("TopCannon");
 	NextCannon = RightCannon;
+
+	// Init missile vars
+	HomingMissileInterval = 0.5f;
+	HomingMissileSpread = 0.5f;
+	NextHomingMissileTime = 0.0;
+	SeekerMissileInterval = 0.8f;
+	NextSeekerMissileTime = 0.0;
+
+	// Init plasma bomb vars
+	PlasmaBombInterval = 1.5f;
+	PlasmaBombDistance = 600.0f;
+	NextPlasmaBombTime = 0.0;
+
+	// Init sound concurrency vars. Shots steal the oldest voice and are throttled so rapid fire doesn't stack
+	// the same sound, while power-up sounds are never cut.
+	FireSoundSettings = FSoundCueSettings(4, 0.04f, true);
+	ExplosionSoundSettings = FSoundCueSettings(2, 0.0f, true);
+	ShiftPowerUpSoundSettings = FSoundCueSettings(2, 0.05f, false);
+	ActivatePowerUpSoundSettings = FSoundCueSettings(1, 0.0f, false);
+
+	// Init automatic fire vars
+	bAutoFire = true;
+	AutoFireRate = DefaultAutoFireRate;
+	AutoFireRatePerLaserPower = DefaultAutoFireRatePerLaserPower;
+	MaxAutoFireShotsPerFrame = DefaultMaxAutoFireShotsPerFrame;
+	bAutoFiring = false;
+	NextAutoFireTime = 0.0;
 }
 
 // Creates the capsule component used for collision detection
@@ -83,24 +132,12 @@ UStaticMeshComponent* APlayerPawn::CreateMeshComponent(USceneComponent* Parent)
 {
 	UStaticMeshComponent* Component = CreateDefaultSubobject<UStaticMeshComponent>(
 		TEXT("MeshComponent"));
-	static ConstructorHelpers::FObjectFinder<UStaticMesh> MeshObj(
-		TEXT("StaticMesh'/Game/Models/Ship/zynaps_ship.zynaps_ship'"));
-	if (MeshObj.Succeeded())
-	{
-		Component->SetStaticMesh(MeshObj.Object);
-		Component->SetRelativeLocation(FVector(0.0f, -3.5f, -7.0f));
-		Component->SetRelativeRotation(FRotator(0.0f, 0.0f, 90.0f));
-		Component->SetRelativeScale3D(FVector(1.0f / 12.0f, 0.1f, 0.1f));
-		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		Component->SetSimulatePhysics(false);
-		Component->SetupAttachment(Parent);
-	}
-	else
-	{
-		UE_LOG(LogPlayerPawn, Error, 
-			TEXT("The asset StaticMesh'/Game/Models/Ship/zynaps_ship.zynaps_ship' was not found"));
-		Component = nullptr;
-	}
+	Component->SetRelativeLocation(FVector(0.0f, -3.5f, -7.0f));
+	Component->SetRelativeRotation(FRotator(0.0f, 0.0f, 90.0f));
+	Component->SetRelativeScale3D(FVector(1.0f / 12.0f, 0.1f, 0.1f));
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetSimulatePhysics(false);
+	Component->SetupAttachment(Parent);
 
 	return Component;
 }
@@ -110,23 +147,11 @@ UParticleSystemComponent* APlayerPawn::CreateEngineThrustParticleSystem(USceneCo
 {
 	UParticleSystemComponent* Component = 
 		CreateDefaultSubobject<UParticleSystemComponent>(TEXT("EnginePartSystemComponent"));
-	static ConstructorHelpers::FObjectFinder<UParticleSystem> PartSystem(
-		TEXT("ParticleSystem'/Game/Models/ThrustParticle/EngineThrustSystem.EngineThrustSystem'"));
-	if (PartSystem.Succeeded())
-	{
-		Component->SetTemplate(PartSystem.Object);
-		Component->SetRelativeScale3D(FVector(1.5f, 0.5f, 1.5f));
-		Component->bAutoActivate = true;
-		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		Component->SetSimulatePhysics(false);
-		Component->SetupAttachment(Parent, SocketName);
-	}
-	else
-	{
-		UE_LOG(LogPlayerPawn, Error,
-			TEXT("The asset ParticleSystem'/Game/Models/ThrustParticle/EngineThrustSystem.EngineThrustSystem' was not found"));
-		Component = nullptr;
-	}
+	Component->SetRelativeScale3D(FVector(1.5f, 0.5f, 1.5f));
+	Component->bAutoActivate = true;
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetSimulatePhysics(false);
+	Component->SetupAttachment(Parent, SocketName);
 
 	return Component;
 }
@@ -139,55 +164,149 @@ UFly2DMovementComponent* APlayerPawn::CreateMovementComponent()
 	return Component;
 }
 
-// Creates the explosion particle system
-UParticleSystem* APlayerPawn::CreateExplosionParticleSystem()
+// Returns the soft references to the assets of the pawn
+void APlayerPawn::GetPreloadAssets(TArray<FSoftObjectPath>& Assets) const
+{
+	Assets.Add(ShipMesh.ToSoftObjectPath());
+	Assets.Add(EngineThrustTemplate.ToSoftObjectPath());
+	Assets.Add(ExplosionTemplate.ToSoftObjectPath());
+}
+
+// Called when the game starts or when spawned
+void APlayerPawn::BeginPlay()
 {
-	UParticleSystem* Result;
-	static ConstructorHelpers::FObjectFinder<UParticleSystem> PartSystem(
-		TEXT("ParticleSystem'/Game/Models/Explosion/ExplosionSystem.ExplosionSystem'"));
-	if (PartSystem.Succeeded())
+	Super::BeginPlay();
+
+	// Init the player state
+	AZynapsPlayerState* State = GetZynapsPlayerState();
+	if (!State)
+	{
+		UE_LOG(LogPlayerPawn, Error, TEXT("Failed to retrieve the player state"));
+		return;
+	}
+	State->SetCurrentState(EPlayerState::Playing);
+
+	// Set up the components once the assets are loaded. They are usually preloaded while the stage prepares.
+	TArray<FSoftObjectPath> Assets;
+	GetPreloadAssets(Assets);
+	AStageAssetPreloader::RequestAssets(GetWorld(), Assets,
+		FSimpleDelegate::CreateUObject(this, &APlayerPawn::AssetsLoaded));
+
+	// Pre-warm the projectile pool so firing doesn't need to spawn actors
+	AProjectilePool* ProjectilePool = AProjectilePool::GetProjectilePool(GetWorld());
+	if (ProjectilePool)
 	{
-		Result = PartSystem.Object;
+		ProjectilePool->Prewarm(ProjectileClass, ProjectilePoolCapacity);
 	}
 	else
 	{
-		UE_LOG(LogPlayerPawn, Error,
-			TEXT("The asset ParticleSystem'/Game/Models/Explosion/ExplosionSystem.ExplosionSystem' was not found"));
-		Result = nullptr;
+		UE_LOG(LogPlayerPawn, Warning, TEXT("No projectile pool available. Projectiles will be spawned on demand"));
 	}
 
-	return Result;
+	// Allocate the voices of the ship sounds so playing them doesn't create audio components
+	AGameplayAudioManager* AudioManager = AGameplayAudioManager::GetGameplayAudioManager(GetWorld());
+	if (AudioManager)
+	{
+		const TPair<USoundBase*, FSoundCueSettings> Cues[] = {
+			TPair<USoundBase*, FSoundCueSettings>(FireSound, FireSoundSettings),
+			TPair<USoundBase*, FSoundCueSettings>(ExplosionSound, ExplosionSoundSettings),
+			TPair<USoundBase*, FSoundCueSettings>(ShiftPowerUpSound, ShiftPowerUpSoundSettings),
+			TPair<USoundBase*, FSoundCueSettings>(ActivatePowerUpSound, ActivatePowerUpSoundSettings)
+		};
+		for (const TPair<USoundBase*, FSoundCueSettings>& Cue : Cues)
+		{
+			if (Cue.Key)
+			{
+				AudioManager->Prewarm(Cue.Key, Cue.Value);
+			}
+		}
+	}
+	else
+	{
+		UE_LOG(LogPlayerPawn, Warning, TEXT("No gameplay audio manager available. Sounds will be played on demand"));
+	}
+
+	// Let the collision manager detect the overlaps with the gameplay actors. The capsule keeps generating
+	// overlap events only for the stage geometry, unless the stage has a baked terrain map which the manager
+	// tests instead.
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (CollisionManager)
+	{
+		CollisionManager->Register(this, CapsuleComponent, ECollisionLayer2D::Player,
+			FOnBodyOverlap::CreateUObject(this, &APlayerPawn::BodyOverlap));
+		CapsuleComponent->SetCollisionResponseToChannel(ECollisionChannel::ECC_PhysicsBody,
+			ECollisionResponse::ECR_Ignore);
+		if (UStageTerrainMap::GetStageTerrainMap(GetWorld()))
+		{
+			CapsuleComponent->SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic,
+				ECollisionResponse::ECR_Ignore);
+		}
+	}
 }
 
-// Called after component initialization
-void APlayerPawn::PostInitializeComponents()
+// Called when the assets of the pawn are loaded
+void APlayerPawn::AssetsLoaded()
 {
-	Super::PostInitializeComponents();
+	// Blueprints may set their own assets on the components
+	if (!MeshComponent->GetStaticMesh())
+	{
+		MeshComponent->SetStaticMesh(ShipMesh.Get());
+		if (!ShipMesh.Get())
+		{
+			UE_LOG(LogPlayerPawn, Error, TEXT("The asset %s was not found"), *ShipMesh.ToString());
+		}
+	}
+	if (!EnginePartSystemComponent->Template)
+	{
+		EnginePartSystemComponent->SetTemplate(EngineThrustTemplate.Get());
+		if (EngineThrustTemplate.Get())
+		{
+			EnginePartSystemComponent->Activate(true);
+		}
+		else
+		{
+			UE_LOG(LogPlayerPawn, Error, TEXT("The asset %s was not found"), *EngineThrustTemplate.ToString());
+		}
+	}
+	if (!ExplosionPartSystem)
+	{
+		ExplosionPartSystem = ExplosionTemplate.Get();
+		if (!ExplosionPartSystem)
+		{
+			UE_LOG(LogPlayerPawn, Error, TEXT("The asset %s was not found"), *ExplosionTemplate.ToString());
+		}
+	}
 
 	// Convert the first material of the mesh in a dynamic instance in order to change its color
 	// during the power-up activation mode
 	DynMaterial = MeshComponent->CreateAndSetMaterialInstanceDynamic(0);
-	if (!DynMaterial)
+	if (DynMaterial)
+	{
+		DynMaterial->SetScalarParameterValue(FName("HighlightAlpha"), 0.0f);
+	}
+	else
 	{
 		UE_LOG(LogPlayerPawn, Error, TEXT("The dynamic material instance could not be created"));
-		return;
 	}
-	DynMaterial->SetScalarParameterValue(FName("HighlightAlpha"), 0.0f);
+
+	// Pre-warm the explosion so the ship destruction doesn't create a particle system component
+	AEffectsPool* EffectsPool = AEffectsPool::GetEffectsPool(GetWorld());
+	if (EffectsPool && ExplosionPartSystem)
+	{
+		EffectsPool->Prewarm(ExplosionPartSystem, ExplosionPoolCapacity, ExplosionPoolBudget);
+	}
 }
 
-// Called when the game starts or when spawned
-void APlayerPawn::BeginPlay()
+// Called when the actor is removed from the level
+void APlayerPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::BeginPlay();
-
-	// Init the player state
-	AZynapsPlayerState* State = GetZynapsPlayerState();
-	if (!State)
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (CollisionManager)
 	{
-		UE_LOG(LogPlayerPawn, Error, TEXT("Failed to retrieve the player state"));
-		return;
+		CollisionManager->Unregister(this);
 	}
-	State->SetCurrentState(EPlayerState::Playing);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -237,6 +356,18 @@ void APlayerPawn::Tick(float DeltaSeconds)
 		return;
 	}
 
+	// Keep firing while the fire button is held
+	if (bAutoFiring)
+	{
+		UpdateAutoFire();
+	}
+
+	// The highlight effect needs the ship mesh to be loaded
+	if (!DynMaterial)
+	{
+		return;
+	}
+
 	// If the player is in power-up activation mode, perform the corresponding effect
 	FName ParamName("HighlightGlow");
 	if (ZynapsPlayerState->GetPowerUpActivationMode())
@@ -271,7 +402,8 @@ AZynapsPlayerState* APlayerPawn::GetZynapsPlayerState() const
 // Returns the game state
 AZynapsGameState* APlayerPawn::GetZynapsGameState() const
 {
-	return GetWorld()->GetGameState<AZynapsGameState>();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetGameState() : nullptr;
 }
 
 // Called to move the player up
@@ -298,21 +430,129 @@ void APlayerPawn::MoveRight(float Val)
 	MovementComponent->MoveRight(Val);
 }
 
-// Called to fire
+// Called to fire a single shot
 void APlayerPawn::Fire()
 {
-	// Get the transforms for the cannons
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsFire);
+
+	// Only the transform of the cannon being shot is needed
+	FireCannon(GetSocketTransform(GetCannonSocketName(NextCannon)), 0.0f);
+}
+
+// Called when the fire button is pressed
+void APlayerPawn::StartFire(float ElapsedSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsFire);
+
+	ElapsedSeconds = FMath::Max(ElapsedSeconds, 0.0f);
+	FireCannon(GetSocketTransform(GetCannonSocketName(NextCannon)), ElapsedSeconds);
+
+	// Schedule the next shots from the moment of the press
+	bAutoFiring = bAutoFire;
+	NextAutoFireTime = (double)GetWorld()->GetTimeSeconds() - ElapsedSeconds + GetAutoFireInterval();
+}
+
+// Called when the fire button is released to stop the automatic fire
+void APlayerPawn::StopFire()
+{
+	bAutoFiring = false;
+}
+
+// Returns the time between two shots of the automatic fire with the current laser power
+float APlayerPawn::GetAutoFireInterval() const
+{
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	const uint8 LaserPower = ZynapsPlayerState ? ZynapsPlayerState->GetLaserPower() : 0;
+	const float Rate = AutoFireRate + AutoFireRatePerLaserPower * LaserPower;
+	return 1.0f / FMath::Max(Rate, 0.1f);
+}
+
+// Fires the automatic shots due since the previous frame
+void APlayerPawn::UpdateAutoFire()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (NextAutoFireTime > Now)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsFire);
+
+	// The cannons are looked up once per frame, however many shots are due. Each shot is fired at its exact
+	// time within the frame, so the projectiles stay evenly spaced whatever the frame rate.
 	FTransform CannonTransforms[3] = {
 		GetSocketTransform(RightCannonSocketName),
 		GetSocketTransform(LeftCannonSocketName),
 		GetSocketTransform(TopCannonSocketName)
 	};
+	const double Interval = GetAutoFireInterval();
+	int32 NumShots = 0;
+	while (NextAutoFireTime <= Now && NumShots < MaxAutoFireShotsPerFrame)
+	{
+		FireCannon(CannonTransforms[NextCannon], (float)(Now - NextAutoFireTime));
+		NextAutoFireTime += Interval;
+		NumShots++;
+	}
+
+	// After a long hitch, drop the shots which couldn't be fired instead of releasing them later in a burst
+	if (NextAutoFireTime <= Now)
+	{
+		NextAutoFireTime = Now + Interval;
+	}
+}
+
+// Returns the name of the socket of a cannon
+FName APlayerPawn::GetCannonSocketName(uint8 Cannon) const
+{
+	switch (Cannon)
+	{
+	case LeftCannon:
+		return LeftCannonSocketName;
+	case TopCannon:
+		return TopCannonSocketName;
+	default:
+		return RightCannonSocketName;
+	}
+}
 
-	// Shot the cannon and play the corresponding sound
-	GetWorld()->SpawnActor<APlayerProjectile>(ProjectileClass, CannonTransforms[NextCannon]);
+// Shoots the next cannon from the given transform
+void APlayerPawn::FireCannon(const FTransform& CannonTransform, float ElapsedSeconds)
+{
+	// Shot the cannon and play the corresponding sound. With laser power the shot is a beam of the laser system,
+	// otherwise it is a projectile.
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	const uint8 LaserPower = ZynapsPlayerState ? ZynapsPlayerState->GetLaserPower() : 0;
+	ALaserBeamSystem* LaserBeamSystem = LaserPower > 0 ? ALaserBeamSystem::GetLaserBeamSystem(GetWorld()) : nullptr;
+	if (LaserBeamSystem)
+	{
+		const FVector Direction = CannonTransform.GetUnitAxis(EAxis::X);
+		LaserBeamSystem->FireBeam(CannonTransform.GetLocation(), FVector2D(Direction.Y, Direction.Z), LaserPower,
+			ElapsedSeconds);
+	}
+	else
+	{
+		APlayerProjectile* Projectile = nullptr;
+		AProjectilePool* ProjectilePool = AProjectilePool::GetProjectilePool(GetWorld());
+		if (ProjectilePool)
+		{
+			Projectile = ProjectilePool->Acquire(ProjectileClass, CannonTransform);
+		}
+		else
+		{
+			Projectile = GetWorld()->SpawnActor<APlayerProjectile>(ProjectileClass, CannonTransform);
+			UPerformanceUtil::RecordSpawn();
+		}
+		if (Projectile)
+		{
+			Projectile->AdvanceSinceLaunch(ElapsedSeconds);
+		}
+	}
+	LaunchHomingMissiles();
+	LaunchSeekerMissiles();
+	DetonatePlasmaBomb();
 	if (FireSound)
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), FireSound);
+		PlayGameplaySound(FireSound);
 	}
 	else
 	{
@@ -362,6 +602,12 @@ void APlayerPawn::EndOverlap_Implementation(class UPrimitiveComponent* HitComp,
 {
 }
 
+// Called by the collision manager when the player begins overlapping with another actor
+void APlayerPawn::BodyOverlap(AActor* OtherActor, UPrimitiveComponent* OtherComp)
+{
+	BeginOverlap(CapsuleComponent, OtherActor, OtherComp, 0, false, FHitResult());
+}
+
 // Returns the transform of a socket
 FTransform APlayerPawn::GetSocketTransform(FName SocketName) const
 {
@@ -373,6 +619,18 @@ FTransform APlayerPawn::GetSocketTransform(FName SocketName) const
 	return Result;
 }
 
+// Plays a gameplay sound through the audio manager
+bool APlayerPawn::PlayGameplaySound(USoundBase* Sound)
+{
+	AGameplayAudioManager* AudioManager = AGameplayAudioManager::GetGameplayAudioManager(GetWorld());
+	if (AudioManager)
+	{
+		return AudioManager->Play(Sound);
+	}
+	UGameplayStatics::PlaySound2D(GetWorld(), Sound);
+	return true;
+}
+
 // Called when a fuel capsule is collected
 void APlayerPawn::FuelCapsuleCollected(AZynapsPlayerState* ZynapsPlayerState, AFuelCapsule* FuelCapsule)
 {
@@ -381,7 +639,7 @@ void APlayerPawn::FuelCapsuleCollected(AZynapsPlayerState* ZynapsPlayerState, AF
 		ZynapsPlayerState->ActivateSelectedPowerUp();
 		if (ActivatePowerUpSound)
 		{
-			UGameplayStatics::PlaySound2D(GetWorld(), ActivatePowerUpSound);
+			PlayGameplaySound(ActivatePowerUpSound);
 		}
 		else
 		{
@@ -393,7 +651,7 @@ void APlayerPawn::FuelCapsuleCollected(AZynapsPlayerState* ZynapsPlayerState, AF
 		ZynapsPlayerState->ShiftSelectedPowerUp();
 		if (ShiftPowerUpSound)
 		{
-			UGameplayStatics::PlaySound2D(GetWorld(), ShiftPowerUpSound);
+			PlayGameplaySound(ShiftPowerUpSound);
 		}
 		else
 		{
@@ -411,7 +669,15 @@ void APlayerPawn::PlayerPawnDestroyed(AZynapsPlayerState* ZynapsPlayerState)
 	{
 		FTransform Transform(FRotator(0.0f, 0.0f, 0.0f), CapsuleComponent->GetComponentLocation(),
 			FVector(7.5f, 7.5f, 7.5f));
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionPartSystem, Transform, true);
+		AEffectsPool* EffectsPool = AEffectsPool::GetEffectsPool(GetWorld());
+		if (EffectsPool)
+		{
+			EffectsPool->SpawnEffect(ExplosionPartSystem, Transform);
+		}
+		else
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionPartSystem, Transform, true);
+		}
 	}
 	else
 	{
@@ -421,7 +687,7 @@ void APlayerPawn::PlayerPawnDestroyed(AZynapsPlayerState* ZynapsPlayerState)
 	// Play a sound
 	if (ExplosionSound)
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), ExplosionSound);
+		PlayGameplaySound(ExplosionSound);
 	}
 	else
 	{
@@ -450,3 +716,72 @@ void APlayerPawn::PlayerPawnDestroyed(AZynapsPlayerState* ZynapsPlayerState)
 	ZynapsPlayerState->SetCurrentState(EPlayerState::Destroyed);
 	Destroy();
 }
+
+// Launches a pair of homing missiles if the power-up is active and the launch interval has passed
+void APlayerPawn::LaunchHomingMissiles()
+{
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	const double CurrentTime = (double)GetWorld()->GetTimeSeconds();
+	if (!ZynapsPlayerState || !ZynapsPlayerState->GetHomingMissiles() || CurrentTime < NextHomingMissileTime)
+	{
+		return;
+	}
+
+	AHomingMissileSystem* HomingMissileSystem = AHomingMissileSystem::GetHomingMissileSystem(GetWorld());
+	if (!HomingMissileSystem)
+	{
+		UE_LOG(LogPlayerPawn, Warning, TEXT("No homing missile system available"));
+		return;
+	}
+
+	// One missile is launched upwards and the other one downwards
+	const FVector Location = GetActorLocation();
+	HomingMissileSystem->LaunchMissile(Location, FVector2D(1.0f, HomingMissileSpread));
+	HomingMissileSystem->LaunchMissile(Location, FVector2D(1.0f, -HomingMissileSpread));
+	NextHomingMissileTime = CurrentTime + HomingMissileInterval;
+}
+
+// Launches a pair of seeker missiles if the power-up is active and the launch interval has passed
+void APlayerPawn::LaunchSeekerMissiles()
+{
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	const double CurrentTime = (double)GetWorld()->GetTimeSeconds();
+	if (!ZynapsPlayerState || !ZynapsPlayerState->GetSeekerMissiles() || CurrentTime < NextSeekerMissileTime)
+	{
+		return;
+	}
+
+	ASeekerMissileSystem* SeekerMissileSystem = ASeekerMissileSystem::GetSeekerMissileSystem(GetWorld());
+	if (!SeekerMissileSystem)
+	{
+		UE_LOG(LogPlayerPawn, Warning, TEXT("No seeker missile system available"));
+		return;
+	}
+
+	// One missile is launched towards the ceiling and the other one towards the floor, where they follow the terrain
+	const FVector Location = GetActorLocation();
+	SeekerMissileSystem->LaunchMissile(Location, FVector2D(0.0f, 1.0f));
+	SeekerMissileSystem->LaunchMissile(Location, FVector2D(0.0f, -1.0f));
+	NextSeekerMissileTime = CurrentTime + SeekerMissileInterval;
+}
+
+// Detonates a plasma bomb ahead of the ship if the power-up is active and the bomb interval has passed
+void APlayerPawn::DetonatePlasmaBomb()
+{
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	const double CurrentTime = (double)GetWorld()->GetTimeSeconds();
+	if (!ZynapsPlayerState || !ZynapsPlayerState->GetPlasmaBombs() || CurrentTime < NextPlasmaBombTime)
+	{
+		return;
+	}
+
+	APlasmaBombSystem* PlasmaBombSystem = APlasmaBombSystem::GetPlasmaBombSystem(GetWorld());
+	if (!PlasmaBombSystem)
+	{
+		UE_LOG(LogPlayerPawn, Warning, TEXT("No plasma bomb system available"));
+		return;
+	}
+
+	PlasmaBombSystem->DetonateBomb(GetActorLocation() + FVector(0.0f, PlasmaBombDistance, 0.0f));
+	NextPlasmaBombTime = CurrentTime + PlasmaBombInterval;
+}
@@ -3,6 +3,12 @@
 #include "ZynapsReloaded.h"
 #include "PlayerProjectile.h"
 #include "ProjectionUtil.h"
+#include "ProjectilePool.h"
+#include "ScreenCullingManager.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsController.h"
+#include "CollisionManager.h"
+#include "PerformanceUtil.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogPlayerProjectile);
@@ -15,12 +21,67 @@ APlayerProjectile::APlayerProjectile() : Super()
 
 	// Set up the root component
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
+
+	// Init pool vars
+	ProjectileMovement = nullptr;
+	LocalLaunchVelocity = FVector::ZeroVector;
+	bCulledByManager = false;
+	bInPool = false;
 }
 
 // Called when the game starts or when spawned
 void APlayerProjectile::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Projectiles are spawned live. The pool takes its own ones back right after spawning them.
+	UPerformanceUtil::AddLiveProjectiles(1);
+
+	// Remember the movement component and its launch velocity so they can be restored each time the projectile
+	// is reused
+	ProjectileMovement = FindComponentByClass<UProjectileMovementComponent>();
+	if (ProjectileMovement)
+	{
+		LocalLaunchVelocity = GetActorRotation().UnrotateVector(ProjectileMovement->Velocity);
+	}
+
+	// Let the culling manager check the visibility. The projectile only needs to tick if there is none.
+	SetActorTickEnabled(!RegisterForCulling());
+
+	// Let the collision manager detect the hits using the first shape of the projectile. Pooled projectiles
+	// stay registered, the manager skips them while their collision is disabled.
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	UShapeComponent* Shape = FindComponentByClass<UShapeComponent>();
+	if (CollisionManager && Shape)
+	{
+		CollisionManager->Register(this, Shape, ECollisionLayer2D::PlayerProjectile,
+			FOnBodyOverlap::CreateUObject(this, &APlayerProjectile::BodyOverlap));
+		Shape->SetGenerateOverlapEvents(false);
+	}
+}
+
+// Called when the actor is removed from the level
+void APlayerProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AScreenCullingManager* CullingManager = AScreenCullingManager::GetScreenCullingManager(GetWorld());
+	if (CullingManager)
+	{
+		CullingManager->Unregister(this);
+	}
+
+	ACollisionManager* CollisionManager = ACollisionManager::GetCollisionManager(GetWorld());
+	if (CollisionManager)
+	{
+		CollisionManager->Unregister(this);
+	}
+
+	// Projectiles destroyed while in flight, i.e. with the level, stop counting as live
+	if (!bInPool)
+	{
+		UPerformanceUtil::AddLiveProjectiles(-1);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -28,8 +89,141 @@ void APlayerProjectile::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	// Destroy the projectile if it is not visible anymore
-	if (!IsVisibleOnScreen())
+	// Release the projectile if it is not visible anymore
+	if (!bCulledByManager && !IsVisibleOnScreen())
+	{
+		ReleaseProjectile();
+	}
+}
+
+// Called by the pool to place the projectile at the given transform and launch it
+void APlayerProjectile::ActivateFromPool(const FTransform& Transform)
+{
+	if (bInPool)
+	{
+		UPerformanceUtil::AddLiveProjectiles(1);
+		bInPool = false;
+	}
+	SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// Restart the projectile movement in the new direction
+	if (ProjectileMovement)
+	{
+		ProjectileMovement->SetUpdatedComponent(RootComponent);
+		ProjectileMovement->Velocity = Transform.GetRotation().RotateVector(LocalLaunchVelocity);
+		ProjectileMovement->Activate(true);
+	}
+
+	// Let the culling manager check the visibility. The projectile only needs to tick if there is none.
+	SetActorTickEnabled(!RegisterForCulling());
+
+	Launched();
+}
+
+// Moves the projectile along its launch velocity as if it had been fired the given seconds ago
+void APlayerProjectile::AdvanceSinceLaunch(float ElapsedSeconds)
+{
+	if (ProjectileMovement && ElapsedSeconds > 0.0f)
+	{
+		AddActorWorldOffset(ProjectileMovement->Velocity * ElapsedSeconds, false, nullptr,
+			ETeleportType::TeleportPhysics);
+	}
+}
+
+// Called by the pool to hide the projectile and stop its simulation until it is acquired again
+void APlayerProjectile::DeactivateToPool()
+{
+	if (!bInPool)
+	{
+		UPerformanceUtil::AddLiveProjectiles(-1);
+		bInPool = true;
+	}
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	// Stop checking the visibility while the projectile is in the pool
+	AScreenCullingManager* CullingManager = AScreenCullingManager::GetScreenCullingManager(GetWorld());
+	if (CullingManager)
+	{
+		CullingManager->Unregister(this);
+	}
+	bCulledByManager = false;
+
+	// Stop the projectile movement
+	if (ProjectileMovement)
+	{
+		ProjectileMovement->StopMovementImmediately();
+		ProjectileMovement->Deactivate();
+	}
+
+	Retired();
+}
+
+// Sets the pool which owns the projectile
+void APlayerProjectile::SetOwningPool(AProjectilePool* Pool)
+{
+	OwningPool = Pool;
+}
+
+// Returns whether the projectile is waiting in its pool to be acquired
+bool APlayerProjectile::IsInPool() const
+{
+	return bInPool;
+}
+
+// Called when the projectile is taken from the pool
+void APlayerProjectile::Launched_Implementation()
+{
+}
+
+// Called when the projectile is given back to the pool
+void APlayerProjectile::Retired_Implementation()
+{
+}
+
+// Called when the collision manager detects that the projectile hit a target
+void APlayerProjectile::TargetHit_Implementation(AActor* Target, UPrimitiveComponent* TargetComp)
+{
+	ReleaseProjectile();
+}
+
+// Registers the projectile in the culling manager. Returns false if there is no culling manager.
+bool APlayerProjectile::RegisterForCulling()
+{
+	AScreenCullingManager* CullingManager = AScreenCullingManager::GetScreenCullingManager(GetWorld());
+	bCulledByManager = CullingManager != nullptr;
+	if (CullingManager)
+	{
+		CullingManager->Register(this, FOnActorOffScreen::CreateUObject(this, &APlayerProjectile::OffScreen));
+	}
+	return bCulledByManager;
+}
+
+// Called by the culling manager when the projectile leaves the screen
+void APlayerProjectile::OffScreen(AActor* Actor)
+{
+	bCulledByManager = false;
+	ReleaseProjectile();
+}
+
+// Called by the collision manager when the projectile begins overlapping with a target
+void APlayerProjectile::BodyOverlap(AActor* OtherActor, UPrimitiveComponent* OtherComp)
+{
+	TargetHit(OtherActor, OtherComp);
+}
+
+// Gives the projectile back to its pool or destroys it if it was not spawned by a pool
+void APlayerProjectile::ReleaseProjectile()
+{
+	AProjectilePool* Pool = OwningPool.Get();
+	if (Pool)
+	{
+		Pool->Release(this);
+	}
+	else
 	{
 		Destroy();
 	}
@@ -38,8 +232,11 @@ void APlayerProjectile::Tick(float DeltaSeconds)
 // Checks that the projectile is within the viewport limits
 bool APlayerProjectile::IsVisibleOnScreen() const
 {
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsVisibilityChecks);
+
 	// Get the player controller
-	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
 	if (!PlayerController)
 	{
 		UE_LOG(LogPlayerProjectile, Error, TEXT("Failed to retrieve the player controller"));
@@ -57,4 +254,4 @@ bool APlayerProjectile::IsVisibleOnScreen() const
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "ProjectilePool.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+#include "PerformanceUtil.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogProjectilePool);
+
+// Sets default values
+AProjectilePool::AProjectilePool() : Super()
+{
+	// The pool doesn't need to tick
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+// Called when the actor is removed from the level
+void AProjectilePool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Dump the usage counters to help sizing the pool. The projectiles still in use go away with the level.
+	for (const TPair<UClass*, FProjectilePoolEntry>& Pair : Entries)
+	{
+		const FProjectilePoolStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogProjectilePool, Verbose,
+			TEXT("Pool for %s: capacity %d, high-water mark %d, hits %d, misses %d"),
+			*GetNameSafe(Pair.Key), Stats.Capacity, Stats.HighWaterMark, Stats.Hits, Stats.Misses);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Returns the projectile pool of the specified world or nullptr if the game mode doesn't provide one
+AProjectilePool* AProjectilePool::GetProjectilePool(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetProjectilePool();
+}
+
+// Spawns projectiles of the given class until the pool holds at least the specified capacity
+void AProjectilePool::Prewarm(TSubclassOf<APlayerProjectile> ProjectileClass, int32 Capacity)
+{
+	if (!ProjectileClass)
+	{
+		UE_LOG(LogProjectilePool, Warning, TEXT("Tried to pre-warm the pool without a projectile class"));
+		return;
+	}
+
+	FProjectilePoolEntry& Entry = Entries.FindOrAdd(*ProjectileClass);
+	Entry.Stats.Capacity = FMath::Max(Entry.Stats.Capacity, Capacity);
+	while (Entry.FreeProjectiles.Num() + Entry.Stats.InUse < Entry.Stats.Capacity)
+	{
+		APlayerProjectile* Projectile = SpawnProjectile(ProjectileClass, GetActorTransform());
+		if (!Projectile)
+		{
+			UE_LOG(LogProjectilePool, Error, TEXT("Failed to spawn a projectile of class %s"),
+				*ProjectileClass->GetName());
+			return;
+		}
+		Entry.FreeProjectiles.Add(Projectile);
+	}
+	UE_LOG(LogProjectilePool, Verbose, TEXT("Pool for %s pre-warmed with %d projectiles"),
+		*ProjectileClass->GetName(), Entry.Stats.Capacity);
+}
+
+// Takes a projectile of the given class from the pool and places it at the given transform. A new projectile
+// is spawned if none is available.
+APlayerProjectile* AProjectilePool::Acquire(TSubclassOf<APlayerProjectile> ProjectileClass,
+	const FTransform& Transform)
+{
+	if (!ProjectileClass)
+	{
+		UE_LOG(LogProjectilePool, Warning, TEXT("Tried to acquire a projectile without a projectile class"));
+		return nullptr;
+	}
+
+	// Take a free projectile or spawn a new one if the pool is empty
+	FProjectilePoolEntry& Entry = Entries.FindOrAdd(*ProjectileClass);
+	APlayerProjectile* Projectile = nullptr;
+	while (!Projectile && Entry.FreeProjectiles.Num() > 0)
+	{
+		// Skip projectiles destroyed by other means while they were in the pool
+		Projectile = Entry.FreeProjectiles.Pop(false);
+		if (Projectile && Projectile->IsPendingKill())
+		{
+			Projectile = nullptr;
+		}
+	}
+	if (Projectile)
+	{
+		Entry.Stats.Hits++;
+	}
+	else
+	{
+		Entry.Stats.Misses++;
+		Projectile = SpawnProjectile(ProjectileClass, Transform);
+		if (!Projectile)
+		{
+			UE_LOG(LogProjectilePool, Error, TEXT("Failed to spawn a projectile of class %s"),
+				*ProjectileClass->GetName());
+			return nullptr;
+		}
+		UE_LOG(LogProjectilePool, Verbose, TEXT("Pool for %s exhausted, %d projectiles in use"),
+			*ProjectileClass->GetName(), Entry.Stats.InUse + 1);
+	}
+
+	// Update the counters and launch the projectile
+	Entry.Stats.InUse++;
+	Entry.Stats.HighWaterMark = FMath::Max(Entry.Stats.HighWaterMark, Entry.Stats.InUse);
+	Projectile->ActivateFromPool(Transform);
+	return Projectile;
+}
+
+// Returns a projectile to the pool
+void AProjectilePool::Release(APlayerProjectile* Projectile)
+{
+	if (!Projectile)
+	{
+		return;
+	}
+
+	// A projectile which hits several targets in the same collision pass is released once per target
+	if (Projectile->IsInPool())
+	{
+		return;
+	}
+
+	FProjectilePoolEntry* Entry = Entries.Find(Projectile->GetClass());
+	if (!Entry)
+	{
+		UE_LOG(LogProjectilePool, Warning, TEXT("The projectile %s doesn't belong to the pool. It will be destroyed"),
+			*Projectile->GetName());
+		Projectile->Destroy();
+		return;
+	}
+
+	Projectile->DeactivateToPool();
+	Entry->FreeProjectiles.Add(Projectile);
+	Entry->Stats.InUse = FMath::Max(Entry->Stats.InUse - 1, 0);
+}
+
+// Returns the usage counters for the given projectile class
+FProjectilePoolStats AProjectilePool::GetStats(TSubclassOf<APlayerProjectile> ProjectileClass) const
+{
+	const FProjectilePoolEntry* Entry = ProjectileClass ? Entries.Find(*ProjectileClass) : nullptr;
+	return Entry ? Entry->Stats : FProjectilePoolStats();
+}
+
+// Spawns a new projectile owned by the pool. It is returned inactive.
+APlayerProjectile* AProjectilePool::SpawnProjectile(TSubclassOf<APlayerProjectile> ProjectileClass,
+	const FTransform& Transform)
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = this;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	APlayerProjectile* Projectile = GetWorld()->SpawnActor<APlayerProjectile>(ProjectileClass, Transform,
+		SpawnParameters);
+	if (Projectile)
+	{
+		UPerformanceUtil::RecordSpawn();
+		Projectile->SetOwningPool(this);
+		Projectile->DeactivateToPool();
+	}
+	return Projectile;
+}
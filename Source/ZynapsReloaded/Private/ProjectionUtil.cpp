@@ -2,6 +2,7 @@
 
 #include "ZynapsReloaded.h"
 #include "ProjectionUtil.h"
+#include "ZynapsCameraManager.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogProjectionUtil);
@@ -95,6 +96,8 @@ bool UProjectionUtil::GetCameraDistanceAndAspectRatio(APlayerController* PlayerC
 bool UProjectionUtil::CalculateViewportBounds(APlayerController* PlayerController, FVector& TopLeftBound,
 	FVector& BottomRightBound)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsViewportBounds);
+
 	// Get the camera distance and aspect ratio 
 	float CameraDistance = 20000.0f;
 	float CameraAspectRatio = 16.0f / 9.0f;
@@ -134,3 +137,146 @@ bool UProjectionUtil::CalculateViewportBounds(APlayerController* PlayerControlle
 
 	return true;
 }
+
+// Calculates the viewport bounds using only the camera view parameters, with the same result as deprojecting
+// the corners of the viewport excluding the black bars. Returns false on error.
+bool UProjectionUtil::CalculateViewportBoundsFromView(const FMinimalViewInfo& View, float ViewportAspectRatio,
+	FVector& TopLeftBound, FVector& BottomRightBound)
+{
+	if (View.AspectRatio <= 0.0f || ViewportAspectRatio <= 0.0f)
+	{
+		UE_LOG(LogProjectionUtil, Error, TEXT("Invalid aspect ratios %f and %f"), View.AspectRatio,
+			ViewportAspectRatio);
+		return false;
+	}
+
+	// Get the camera axes
+	FRotationMatrix CameraMatrix(View.Rotation);
+	FVector Forward = CameraMatrix.GetUnitAxis(EAxis::X);
+	FVector Right = CameraMatrix.GetUnitAxis(EAxis::Y);
+	FVector Up = CameraMatrix.GetUnitAxis(EAxis::Z);
+
+	// Half size of the view, at unit distance in perspective. The projection takes the aspect ratio of the
+	// viewport unless it is letterboxed, keeping the horizontal field of view.
+	float HalfWidth = View.ProjectionMode == ECameraProjectionMode::Orthographic ? View.OrthoWidth / 2.0f :
+		FMath::Tan(FMath::DegreesToRadians(View.FOV / 2.0f));
+	float ProjectionAspectRatio = View.bConstrainAspectRatio ? View.AspectRatio : ViewportAspectRatio;
+	float HalfHeight = HalfWidth / ProjectionAspectRatio;
+
+	// Exclude the areas of the black bars of a non 16:9 resolution, as if the view had the camera aspect ratio
+	if (ProjectionAspectRatio < View.AspectRatio)
+	{
+		// Top and bottom black bars
+		HalfHeight = HalfWidth / View.AspectRatio;
+	}
+	else if (ProjectionAspectRatio > View.AspectRatio)
+	{
+		// Left and right black bars
+		HalfWidth = HalfHeight * View.AspectRatio;
+	}
+
+	// The corners are at the camera distance along their rays
+	float CameraDistance = FMath::Abs(View.Location.X);
+	if (View.ProjectionMode == ECameraProjectionMode::Orthographic)
+	{
+		// Parallel rays starting at the corners of the ortho view
+		TopLeftBound = View.Location - Right * HalfWidth + Up * HalfHeight + Forward * CameraDistance;
+		BottomRightBound = View.Location + Right * HalfWidth - Up * HalfHeight + Forward * CameraDistance;
+	}
+	else
+	{
+		// Rays starting at the camera location through the corners of the frustum
+		FVector TopLeftDirection = (Forward - Right * HalfWidth + Up * HalfHeight).GetSafeNormal();
+		FVector BottomRightDirection = (Forward + Right * HalfWidth - Up * HalfHeight).GetSafeNormal();
+		TopLeftBound = View.Location + TopLeftDirection * CameraDistance;
+		BottomRightBound = View.Location + BottomRightDirection * CameraDistance;
+	}
+
+	return true;
+}
+
+// Returns the viewport bounds of the player's camera. They are recalculated at most once per frame and only
+// if the camera view or the viewport changed. Returns false on error.
+bool UProjectionUtil::GetCachedViewportBounds(APlayerController* PlayerController, FVector& TopLeftBound,
+	FVector& BottomRightBound)
+{
+	if (!PlayerController)
+	{
+		UE_LOG(LogProjectionUtil, Error, TEXT("No player controller specified"));
+		return false;
+	}
+
+	// The cache lives in the camera manager. Other camera managers can't cache the bounds.
+	AZynapsCameraManager* CameraManager = Cast<AZynapsCameraManager>(PlayerController->PlayerCameraManager);
+	if (!CameraManager)
+	{
+		return CalculateViewportBounds(PlayerController, TopLeftBound, BottomRightBound);
+	}
+	return GetViewportBoundsFromCache(PlayerController, CameraManager->GetViewportBoundsCache(), TopLeftBound,
+		BottomRightBound);
+}
+
+// Returns the viewport bounds using the given cache. They are recalculated at most once per frame and only
+// if the camera view or the viewport changed. Returns false on error.
+bool UProjectionUtil::GetViewportBoundsFromCache(APlayerController* PlayerController, FViewportBoundsCache& Cache,
+	FVector& TopLeftBound, FVector& BottomRightBound)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsViewportBounds);
+
+	// The bounds were already validated during this frame
+	if (Cache.bValid && Cache.Frame == GFrameCounter)
+	{
+		TopLeftBound = Cache.TopLeftBound;
+		BottomRightBound = Cache.BottomRightBound;
+		return true;
+	}
+
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+	{
+		UE_LOG(LogProjectionUtil, Error, TEXT("The camera manager could not be retrieved"));
+		return false;
+	}
+	const FMinimalViewInfo& View = PlayerController->PlayerCameraManager->GetCameraCachePOV();
+
+	// The black bars depend on the aspect ratio of the viewport
+	float ViewportAspectRatio = View.AspectRatio;
+	FVector2D ViewportSize = GetViewportSize(PlayerController);
+	if (ViewportSize.X > 0.0f && ViewportSize.Y > 0.0f)
+	{
+		ViewportAspectRatio = ViewportSize.X / ViewportSize.Y;
+	}
+
+	// Check what changed since the bounds were calculated
+	bool bSameProjection = Cache.bValid && Cache.ProjectionMode == View.ProjectionMode &&
+		Cache.FOV == View.FOV && Cache.OrthoWidth == View.OrthoWidth && Cache.AspectRatio == View.AspectRatio &&
+		Cache.ViewportAspectRatio == ViewportAspectRatio && Cache.bConstrainAspectRatio == View.bConstrainAspectRatio &&
+		Cache.CameraRotation.Equals(View.Rotation, 0.0f);
+	FVector CameraOffset = View.Location - Cache.CameraLocation;
+	if (bSameProjection && CameraOffset.X == 0.0f)
+	{
+		// Only the scroll changed, so the bounds just move with the camera along the gameplay plane
+		Cache.TopLeftBound += CameraOffset;
+		Cache.BottomRightBound += CameraOffset;
+	}
+	else if (!CalculateViewportBoundsFromView(View, ViewportAspectRatio, Cache.TopLeftBound, Cache.BottomRightBound))
+	{
+		Cache.Invalidate();
+		return false;
+	}
+
+	// Update the cache keys
+	Cache.bValid = true;
+	Cache.Frame = GFrameCounter;
+	Cache.CameraLocation = View.Location;
+	Cache.CameraRotation = View.Rotation;
+	Cache.FOV = View.FOV;
+	Cache.OrthoWidth = View.OrthoWidth;
+	Cache.AspectRatio = View.AspectRatio;
+	Cache.ViewportAspectRatio = ViewportAspectRatio;
+	Cache.bConstrainAspectRatio = View.bConstrainAspectRatio;
+	Cache.ProjectionMode = View.ProjectionMode;
+
+	TopLeftBound = Cache.TopLeftBound;
+	BottomRightBound = Cache.BottomRightBound;
+	return true;
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "ScreenCullingManager.h"
+#include "ProjectionUtil.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsController.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogScreenCullingManager);
+
+// Sets default values
+AScreenCullingManager::AScreenCullingManager() : Super()
+{
+	// Tick once per frame after the actors have been moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+// Called every frame
+void AScreenCullingManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsScreenCulling);
+
+	Super::Tick(DeltaSeconds);
+
+	if (CulledActors.Num() == 0)
+	{
+		return;
+	}
+
+	// Get the player controller
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
+	if (!PlayerController)
+	{
+		UE_LOG(LogScreenCullingManager, Error, TEXT("Failed to retrieve the player controller"));
+		return;
+	}
+
+	// Calculate the playfield bounds once for all the actors
+	FVector TopLeftBound;
+	FVector BottomRightBound;
+	if (!UProjectionUtil::GetCachedViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
+	{
+		UE_LOG(LogScreenCullingManager, Error, TEXT("Failed to calculate the viewport bounds"));
+		return;
+	}
+	const float MinY = TopLeftBound.Y;
+	const float MaxY = BottomRightBound.Y;
+	const float MinZ = BottomRightBound.Z;
+	const float MaxZ = TopLeftBound.Z;
+
+	// Test every actor against the bounds
+	OffScreenIndices.Reset();
+	for (int32 Index = 0; Index < CulledActors.Num(); Index++)
+	{
+		const FCulledActor& CulledActor = CulledActors[Index];
+		AActor* Actor = CulledActor.Actor.Get();
+		if (!Actor)
+		{
+			OffScreenIndices.Add(Index);
+			continue;
+		}
+
+		const FVector Location = Actor->GetActorLocation();
+		if (Location.Y + CulledActor.Extent.Y < MinY || Location.Y - CulledActor.Extent.Y > MaxY ||
+			Location.Z + CulledActor.Extent.Z < MinZ || Location.Z - CulledActor.Extent.Z > MaxZ)
+		{
+			OffScreenIndices.Add(Index);
+		}
+	}
+
+	// Remove the off-screen actors before notifying them, so the callbacks can safely register or unregister
+	// actors. Indices are processed backwards to keep them valid while removing.
+	TArray<FCulledActor, TInlineAllocator<16>> Notifications;
+	for (int32 Position = OffScreenIndices.Num() - 1; Position >= 0; Position--)
+	{
+		int32 Index = OffScreenIndices[Position];
+		Notifications.Add(CulledActors[Index]);
+		RemoveAt(Index);
+	}
+	for (FCulledActor& Notification : Notifications)
+	{
+		AActor* Actor = Notification.Actor.Get();
+		if (Actor)
+		{
+			Notification.OnOffScreen.ExecuteIfBound(Actor);
+		}
+	}
+}
+
+// Returns the culling manager of the specified world or nullptr if the game mode doesn't provide one
+AScreenCullingManager* AScreenCullingManager::GetScreenCullingManager(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetScreenCullingManager();
+}
+
+// Registers an actor to be notified when it leaves the screen
+void AScreenCullingManager::Register(AActor* Actor, FOnActorOffScreen OnOffScreen)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	// Take the size of the actor once, including only the colliding components
+	FVector Origin;
+	FVector Extent;
+	Actor->GetActorBounds(true, Origin, Extent);
+
+	int32* ExistingIndex = ActorIndices.Find(Actor);
+	if (ExistingIndex)
+	{
+		// Already registered, just refresh the entry
+		FCulledActor& CulledActor = CulledActors[*ExistingIndex];
+		CulledActor.Extent = Extent;
+		CulledActor.OnOffScreen = OnOffScreen;
+		return;
+	}
+
+	FCulledActor CulledActor;
+	CulledActor.Actor = Actor;
+	CulledActor.Key = Actor;
+	CulledActor.Extent = Extent;
+	CulledActor.OnOffScreen = OnOffScreen;
+	ActorIndices.Add(Actor, CulledActors.Add(CulledActor));
+}
+
+// Unregisters an actor
+void AScreenCullingManager::Unregister(AActor* Actor)
+{
+	int32* Index = ActorIndices.Find(Actor);
+	if (Index)
+	{
+		RemoveAt(*Index);
+	}
+}
+
+// Returns the number of registered actors
+int32 AScreenCullingManager::GetNumRegistered() const
+{
+	return CulledActors.Num();
+}
+
+// Removes the entry at the given index keeping the index lookup consistent
+void AScreenCullingManager::RemoveAt(int32 Index)
+{
+	ActorIndices.Remove(CulledActors[Index].Key);
+
+	// Fill the gap with the last entry and update its index
+	int32 LastIndex = CulledActors.Num() - 1;
+	if (Index != LastIndex)
+	{
+		ActorIndices.Add(CulledActors[LastIndex].Key, Index);
+	}
+	CulledActors.RemoveAtSwap(Index, 1, false);
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "SeekerMissileSystem.h"
+#include "EnemySwarm.h"
+#include "StageDistanceField.h"
+#include "StageGameMode.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogSeekerMissileSystem);
+
+// Sets default values
+ASeekerMissileSystem::ASeekerMissileSystem() : Super()
+{
+	// The seekers are slower than the homing missiles and only look for nearby targets
+	Speed = 1200.0f;
+	TurnRate = 6.0f;
+	AcquisitionDistance = 1200.0f;
+	Lifetime = 5.0f;
+
+	// Init terrain following vars
+	HugDistance = 80.0f;
+	HugReach = 400.0f;
+	AvoidanceStrength = 3.0f;
+}
+
+// Returns the seeker missile system of the specified world or nullptr if the game mode doesn't provide one
+ASeekerMissileSystem* ASeekerMissileSystem::GetSeekerMissileSystem(UWorld* World)
+{
+	AStageGameMode* GameMode = GetStageGameMode(World);
+	return GameMode ? GameMode->GetSeekerMissileSystem() : nullptr;
+}
+
+// Turns the missiles towards their targets around the scenery and moves them
+void ASeekerMissileSystem::SteerMissiles(float DeltaSeconds, AEnemySwarm* EnemySwarm)
+{
+	// Without scenery the seekers behave as homing missiles
+	const UStageDistanceField* Field = GetDistanceField();
+	if (!Field)
+	{
+		Super::SteerMissiles(DeltaSeconds, EnemySwarm);
+		return;
+	}
+
+	const float Blend = FMath::Min(TurnRate * DeltaSeconds, 1.0f);
+	const float InvHugDistance = 1.0f / FMath::Max(HugDistance, KINDA_SMALL_NUMBER);
+	const float InvPullRange = 1.0f / FMath::Max(HugReach - HugDistance, KINDA_SMALL_NUMBER);
+	for (int32 Missile = 0; Missile < PositionsY.Num(); Missile++)
+	{
+		const FVector2D Location(PositionsY[Missile], PositionsZ[Missile]);
+		const FVector2D Velocity(VelocitiesY[Missile], VelocitiesZ[Missile]);
+
+		// Head for the target or keep the current heading
+		const int32 Enemy = EnemySwarm ? EnemySwarm->FindEnemy(TargetIds[Missile]) : INDEX_NONE;
+		FVector2D Desired = Enemy != INDEX_NONE ? (EnemySwarm->GetEnemyLocation(Enemy) - Location).GetSafeNormal() :
+			Velocity.GetSafeNormal();
+
+		// Near the scenery, push the missiles closer than the hug distance away from it and pull the missiles
+		// without a target towards it, so they fly along the surface. The gradient points away from the surface.
+		const float Distance = Field->Sample(Location);
+		const FVector2D Normal = Distance < HugReach ? Field->SampleGradient(Location).GetSafeNormal() :
+			FVector2D::ZeroVector;
+		if (Distance < HugDistance)
+		{
+			Desired += Normal * (AvoidanceStrength * (HugDistance - Distance) * InvHugDistance);
+		}
+		else if (Enemy == INDEX_NONE)
+		{
+			Desired -= Normal * FMath::Min((Distance - HugDistance) * InvPullRange, 1.0f);
+		}
+
+		// Blend the velocity towards the desired direction. Within the hug distance the missiles never move
+		// towards the scenery.
+		FVector2D NewVelocity = Velocity + (Desired.GetSafeNormal() * Speed - Velocity) * Blend;
+		const float Approach = FVector2D::DotProduct(NewVelocity, Normal);
+		if (Distance < HugDistance && Approach < 0.0f)
+		{
+			NewVelocity -= Normal * Approach;
+		}
+		NewVelocity = NewVelocity.GetSafeNormal() * Speed;
+		if (NewVelocity.IsZero())
+		{
+			NewVelocity = Normal * Speed;
+		}
+
+		VelocitiesY[Missile] = NewVelocity.X;
+		VelocitiesZ[Missile] = NewVelocity.Y;
+		PositionsY[Missile] += NewVelocity.X * DeltaSeconds;
+		PositionsZ[Missile] += NewVelocity.Y * DeltaSeconds;
+		Ages[Missile] += DeltaSeconds;
+	}
+}
+
+// Damages the enemies hit by the missiles and explodes the missiles which touch the scenery
+void ASeekerMissileSystem::HitEnemies(AEnemySwarm* EnemySwarm)
+{
+	Super::HitEnemies(EnemySwarm);
+
+	const UStageDistanceField* Field = GetDistanceField();
+	if (!Field)
+	{
+		return;
+	}
+
+	for (int32 Missile = 0; Missile < PositionsY.Num(); Missile++)
+	{
+		if (!Exploded[Missile] && Field->Sample(FVector2D(PositionsY[Missile], PositionsZ[Missile])) < MissileRadius)
+		{
+			Exploded[Missile] = true;
+		}
+	}
+}
+
+// Returns the distance field of the stage scenery or nullptr if it wasn't built
+UStageDistanceField* ASeekerMissileSystem::GetDistanceField() const
+{
+	AStageGameMode* GameMode = GetStageGameMode(GetWorld());
+	UStageDistanceField* Field = GameMode ? GameMode->GetStageDistanceField() : nullptr;
+	return Field && Field->IsBuilt() ? Field : nullptr;
+}
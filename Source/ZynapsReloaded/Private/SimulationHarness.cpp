@@ -0,0 +1,254 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "SimulationHarness.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsController.h"
+#include "ZynapsCameraManager.h"
+#include "PerformanceUtil.h"
+#include "Serialization/MemoryWriter.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogSimulationHarness);
+
+// Sets default values
+ASimulationHarness::ASimulationHarness() : Super()
+{
+	// Inject the input before the actors are moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	// Init simulation vars
+	NumTicks = DefaultSimulationTicks;
+	CurrentTick = 0;
+	InputCursor = 0;
+	StartTime = 0.0;
+}
+
+// Called when the game starts or when spawned
+void ASimulationHarness::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	// Advance the time by a fixed step on every tick
+	float Rate = DefaultSimulationRate;
+	FParse::Value(CommandLine, TEXT("SimRate="), Rate);
+	Rate = FMath::Max(Rate, 1.0f);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / Rate);
+
+	// Make the random streams reproducible
+	int32 Seed = 0;
+	FParse::Value(CommandLine, TEXT("SimSeed="), Seed);
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	FParse::Value(CommandLine, TEXT("SimTicks="), NumTicks);
+	NumTicks = FMath::Max(NumTicks, 1);
+
+	FString InputFileName;
+	if (FParse::Value(CommandLine, TEXT("SimInput="), InputFileName) && !LoadInputScript(InputFileName))
+	{
+		UE_LOG(LogSimulationHarness, Error, TEXT("Failed to load the input script %s. No input will be injected"),
+			*InputFileName);
+	}
+
+	HashesFileName = FPaths::ProjectSavedDir() / TEXT("Simulation") / TEXT("StateHashes.txt");
+	FParse::Value(CommandLine, TEXT("SimHashes="), HashesFileName);
+	HashesLog.Reserve(NumTicks * 16);
+
+	StartTime = FPlatformTime::Seconds();
+	UE_LOG(LogSimulationHarness, Log, TEXT("Simulating %d ticks at %.0f ticks per second with seed %d"),
+		NumTicks, Rate, Seed);
+}
+
+// Called every frame
+void ASimulationHarness::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// The state at this point is the one left by the previous tick
+	if (CurrentTick > 0)
+	{
+		HashesLog += FString::Printf(TEXT("%d %08x\n"), CurrentTick - 1, (uint32)CalculateStateHash());
+	}
+	if (CurrentTick >= NumTicks)
+	{
+		FinishSimulation();
+		return;
+	}
+
+	// Inject the scripted input
+	AddTickPrerequisites();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	AZynapsController* Controller = WorldContext ? WorldContext->GetController() : nullptr;
+	if (Controller)
+	{
+		Controller->InjectInput(GetScriptedInput());
+	}
+	else
+	{
+		UE_LOG(LogSimulationHarness, Error, TEXT("Failed to retrieve the player controller"));
+	}
+
+	CurrentTick++;
+}
+
+// Returns true if the command line asks for a simulation run
+bool ASimulationHarness::IsSimulationRequested()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("ZynapsSim"));
+}
+
+// Returns the hash of the gameplay state
+int32 ASimulationHarness::CalculateStateHash() const
+{
+	// Gather the state in a flat buffer. Floats are hashed bit by bit, so any divergence is detected.
+	TArray<uint8> State;
+	FMemoryWriter Writer(State);
+
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	if (WorldContext)
+	{
+		AZynapsGameState* GameState = WorldContext->GetGameState();
+		if (GameState)
+		{
+			uint8 StageState = (uint8)GameState->GetCurrentState();
+			Writer << StageState;
+		}
+
+		AZynapsPlayerState* PlayerState = WorldContext->GetPlayerState();
+		if (PlayerState)
+		{
+			uint8 PlayerStateValue = (uint8)PlayerState->GetCurrentState();
+			int32 Score = PlayerState->GetGameScore();
+			uint8 Lives = PlayerState->GetLives();
+			uint8 SelectedPowerUp = (uint8)PlayerState->GetSelectedPowerUp();
+			uint8 SpeedUpLevel = PlayerState->GetSpeedUpLevel();
+			uint8 LaserPower = PlayerState->GetLaserPower();
+			Writer << PlayerStateValue << Score << Lives << SelectedPowerUp << SpeedUpLevel << LaserPower;
+		}
+
+		APlayerPawn* PlayerPawn = WorldContext->GetPlayerPawn();
+		if (PlayerPawn)
+		{
+			FVector Location = PlayerPawn->GetActorLocation();
+			FRotator Rotation = PlayerPawn->GetActorRotation();
+			Writer << Location << Rotation;
+		}
+
+		AZynapsCameraManager* CameraManager = WorldContext->GetCameraManager();
+		if (CameraManager)
+		{
+			FVector CameraLocation = CameraManager->GetCameraLocation();
+			Writer << CameraLocation;
+		}
+	}
+
+	FZynapsPerformanceStats Stats = UPerformanceUtil::GetPerformanceStats();
+	Writer << Stats.LiveProjectiles << Stats.LiveFuelCapsules;
+
+	return (int32)FCrc::MemCrc32(State.GetData(), State.Num());
+}
+
+// Loads the scripted input. Returns false on error.
+bool ASimulationHarness::LoadInputScript(const FString& FileName)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FileName))
+	{
+		return false;
+	}
+
+	InputKeys.Reset();
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); LineIndex++)
+	{
+		FString Line = Lines[LineIndex].TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		// Each line holds the tick and the input mask
+		FString TickText;
+		FString MaskText;
+		if (!Line.Split(TEXT(" "), &TickText, &MaskText) || !TickText.IsNumeric())
+		{
+			UE_LOG(LogSimulationHarness, Error, TEXT("Invalid input line %d: %s"), LineIndex + 1, *Line);
+			return false;
+		}
+		MaskText = MaskText.TrimStartAndEnd();
+
+		FSimulationInputKey Key;
+		Key.Tick = FCString::Atoi(*TickText);
+		Key.InputMask = (uint8)FCString::Strtoi(*MaskText, nullptr, 0);
+		InputKeys.Add(Key);
+	}
+
+	// Keyframes may be written in any order
+	InputKeys.StableSort([](const FSimulationInputKey& A, const FSimulationInputKey& B)
+	{
+		return A.Tick < B.Tick;
+	});
+	InputCursor = 0;
+
+	UE_LOG(LogSimulationHarness, Log, TEXT("Loaded %d input keyframes from %s"), InputKeys.Num(), *FileName);
+	return true;
+}
+
+// Returns the input mask for the current tick
+uint8 ASimulationHarness::GetScriptedInput()
+{
+	while (InputCursor + 1 < InputKeys.Num() && InputKeys[InputCursor + 1].Tick <= CurrentTick)
+	{
+		InputCursor++;
+	}
+	if (InputKeys.Num() == 0 || InputKeys[InputCursor].Tick > CurrentTick)
+	{
+		return 0;
+	}
+	return InputKeys[InputCursor].InputMask;
+}
+
+// Makes sure the player's movement runs after the input is injected
+void ASimulationHarness::AddTickPrerequisites()
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerPawn* PlayerPawn = WorldContext ? WorldContext->GetPlayerPawn() : nullptr;
+	if (!PlayerPawn || PrerequisitePawn.Get() == PlayerPawn)
+	{
+		return;
+	}
+
+	// A new pawn is spawned on each respawn
+	PlayerPawn->AddTickPrerequisiteActor(this);
+	if (PlayerPawn->MovementComponent)
+	{
+		PlayerPawn->MovementComponent->AddTickPrerequisiteActor(this);
+	}
+	PrerequisitePawn = PlayerPawn;
+}
+
+// Writes the hashes, logs the cost of the run and quits
+void ASimulationHarness::FinishSimulation()
+{
+	SetActorTickEnabled(false);
+
+	const double WallTime = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogSimulationHarness, Log, TEXT("Simulated %d ticks in %.3f s (%.3f ms per tick, %.1fx real time)"),
+		NumTicks, WallTime, WallTime * 1000.0 / NumTicks,
+		WallTime > 0.0 ? NumTicks * FApp::GetFixedDeltaTime() / WallTime : 0.0);
+
+	if (FFileHelper::SaveStringToFile(HashesLog, *HashesFileName))
+	{
+		UE_LOG(LogSimulationHarness, Log, TEXT("State hashes written to %s"), *HashesFileName);
+	}
+	else
+	{
+		UE_LOG(LogSimulationHarness, Error, TEXT("Failed to write the state hashes to %s"), *HashesFileName);
+	}
+
+	FPlatformMisc::RequestExit(false);
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "SpatialHashGrid.h"
+
+// Creates a grid with the given cell size and number of buckets
+FSpatialHashGrid::FSpatialHashGrid(float InCellSize, int32 InNumBuckets)
+{
+	check(FMath::IsPowerOfTwo(InNumBuckets));
+	BucketMask = InNumBuckets - 1;
+	Buckets.SetNum(InNumBuckets);
+	NumItems = 0;
+	QueryStamp = 0;
+	SetCellSize(InCellSize);
+}
+
+// Changes the cell size. It removes all the items.
+void FSpatialHashGrid::SetCellSize(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, KINDA_SMALL_NUMBER);
+	InvCellSize = 1.0f / CellSize;
+	Reset();
+}
+
+// Returns the cell size
+float FSpatialHashGrid::GetCellSize() const
+{
+	return CellSize;
+}
+
+// Removes all the items keeping the allocated memory
+void FSpatialHashGrid::Reset()
+{
+	for (int32 Bucket : UsedBuckets)
+	{
+		Buckets[Bucket].Reset();
+	}
+	UsedBuckets.Reset();
+	NumItems = 0;
+}
+
+// Adds an item covering the given bounds
+void FSpatialHashGrid::Insert(int32 Item, const FBox2D& Bounds)
+{
+	check(Item >= 0);
+
+	const FIntPoint MinCell = GetCell(Bounds.Min);
+	const FIntPoint MaxCell = GetCell(Bounds.Max);
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+		{
+			const int32 Bucket = GetBucket(CellX, CellY);
+			TArray<int32>& BucketItems = Buckets[Bucket];
+			if (BucketItems.Num() == 0)
+			{
+				UsedBuckets.Add(Bucket);
+			}
+
+			// Several cells of the same item may share a bucket
+			if (BucketItems.Num() == 0 || BucketItems.Last() != Item)
+			{
+				BucketItems.Add(Item);
+			}
+		}
+	}
+
+	if (Item >= ItemStamps.Num())
+	{
+		ItemStamps.SetNumZeroed(Item + 1);
+	}
+	NumItems++;
+}
+
+// Adds an item covering a circle
+void FSpatialHashGrid::Insert(int32 Item, const FVector2D& Center, float Radius)
+{
+	Insert(Item, FBox2D(Center - FVector2D(Radius, Radius), Center + FVector2D(Radius, Radius)));
+}
+
+// Appends to the output array the items whose cells overlap the given bounds. Each item is returned once.
+void FSpatialHashGrid::Query(const FBox2D& Bounds, TArray<int32>& OutItems) const
+{
+	if (NumItems == 0)
+	{
+		return;
+	}
+
+	// Start a new query. Clear the stamps when the counter wraps around.
+	if (++QueryStamp == 0)
+	{
+		FMemory::Memzero(ItemStamps.GetData(), ItemStamps.Num() * sizeof(uint32));
+		QueryStamp = 1;
+	}
+
+	const FIntPoint MinCell = GetCell(Bounds.Min);
+	const FIntPoint MaxCell = GetCell(Bounds.Max);
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+		{
+			for (int32 Item : Buckets[GetBucket(CellX, CellY)])
+			{
+				if (ItemStamps[Item] != QueryStamp)
+				{
+					ItemStamps[Item] = QueryStamp;
+					OutItems.Add(Item);
+				}
+			}
+		}
+	}
+}
+
+// Appends to the output array the items whose cells overlap a circle. Each item is returned once.
+void FSpatialHashGrid::Query(const FVector2D& Center, float Radius, TArray<int32>& OutItems) const
+{
+	Query(FBox2D(Center - FVector2D(Radius, Radius), Center + FVector2D(Radius, Radius)), OutItems);
+}
+
+// Returns the number of items inserted since the last reset
+int32 FSpatialHashGrid::GetNumItems() const
+{
+	return NumItems;
+}
+
+// Returns the cell containing a location
+FIntPoint FSpatialHashGrid::GetCell(const FVector2D& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+}
+
+// Returns the bucket of a cell
+int32 FSpatialHashGrid::GetBucket(int32 CellX, int32 CellY) const
+{
+	// Large primes to spread neighbour cells over different buckets
+	const uint32 Hash = (uint32)CellX * 73856093u ^ (uint32)CellY * 19349663u;
+	return (int32)(Hash & (uint32)BucketMask);
+}
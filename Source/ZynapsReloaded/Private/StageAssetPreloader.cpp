@@ -0,0 +1,208 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "StageAssetPreloader.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogStageAssetPreloader);
+
+// Sets default values
+AStageAssetPreloader::AStageAssetPreloader() : Super()
+{
+	// The preloader is notified by the streamable manager, so it doesn't need to tick
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Init preload vars
+	bPreloadStarted = false;
+	PreloadStartTime = 0.0;
+}
+
+// Returns the asset preloader of the specified world or nullptr if the game mode doesn't provide one
+AStageAssetPreloader* AStageAssetPreloader::GetStageAssetPreloader(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetStageAssetPreloader();
+}
+
+// Requests the given assets and calls the delegate once they are loaded
+void AStageAssetPreloader::RequestAssets(UWorld* World, const TArray<FSoftObjectPath>& Assets,
+	FSimpleDelegate OnLoaded)
+{
+	AStageAssetPreloader* Preloader = GetStageAssetPreloader(World);
+	if (Preloader)
+	{
+		Preloader->AddAssets(Assets);
+		Preloader->CallWhenLoaded(OnLoaded);
+		return;
+	}
+
+	UE_LOG(LogStageAssetPreloader, Verbose, TEXT("No asset preloader available. Loading %d assets synchronously"),
+		Assets.Num());
+	for (const FSoftObjectPath& Asset : Assets)
+	{
+		Asset.TryLoad();
+	}
+	OnLoaded.ExecuteIfBound();
+}
+
+// Adds assets to be loaded
+void AStageAssetPreloader::AddAssets(const TArray<FSoftObjectPath>& Assets)
+{
+	for (const FSoftObjectPath& Asset : Assets)
+	{
+		bool bAlreadyAdded = false;
+		if (Asset.IsValid())
+		{
+			AddedAssets.Add(Asset, &bAlreadyAdded);
+			if (!bAlreadyAdded)
+			{
+				PendingAssets.Add(Asset);
+			}
+		}
+	}
+
+	if (bPreloadStarted)
+	{
+		RequestPendingAssets();
+	}
+}
+
+// Adds the assets of a manifest to be loaded
+void AStageAssetPreloader::AddManifest(const UStageAssetManifest* Manifest)
+{
+	if (Manifest)
+	{
+		AddAssets(Manifest->Assets);
+	}
+}
+
+// Starts loading the assets added so far
+void AStageAssetPreloader::StartPreload()
+{
+	if (bPreloadStarted)
+	{
+		return;
+	}
+
+	bPreloadStarted = true;
+	PreloadStartTime = FPlatformTime::Seconds();
+	UE_LOG(LogStageAssetPreloader, Log, TEXT("Preloading %d stage assets"), PendingAssets.Num());
+	RequestPendingAssets();
+
+	// Nothing to wait for
+	if (Handles.Num() == 0)
+	{
+		BatchLoaded();
+	}
+}
+
+// Returns whether the preload has started and all the requested assets are loaded
+bool AStageAssetPreloader::IsPreloadComplete() const
+{
+	if (!bPreloadStarted || PendingAssets.Num() > 0)
+	{
+		return false;
+	}
+	for (const TSharedPtr<FStreamableHandle>& Handle : Handles)
+	{
+		if (Handle.IsValid() && !Handle->HasLoadCompleted() && !Handle->WasCanceled())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns the fraction between 0 and 1 of the requested assets which are loaded
+float AStageAssetPreloader::GetPreloadProgress() const
+{
+	if (IsPreloadComplete())
+	{
+		return 1.0f;
+	}
+
+	int32 TotalLoaded = 0;
+	int32 TotalRequested = PendingAssets.Num();
+	for (const TSharedPtr<FStreamableHandle>& Handle : Handles)
+	{
+		if (Handle.IsValid())
+		{
+			int32 Loaded = 0;
+			int32 Requested = 0;
+			Handle->GetLoadedCount(Loaded, Requested);
+			TotalLoaded += Loaded;
+			TotalRequested += Requested;
+		}
+	}
+	return TotalRequested > 0 ? (float)TotalLoaded / TotalRequested : 0.0f;
+}
+
+// Calls the delegate once all the requested assets are loaded
+void AStageAssetPreloader::CallWhenLoaded(FSimpleDelegate OnLoaded)
+{
+	if (IsPreloadComplete())
+	{
+		OnLoaded.ExecuteIfBound();
+	}
+	else
+	{
+		LoadedCallbacks.Add(OnLoaded);
+	}
+}
+
+// Requests the async load of the pending assets
+void AStageAssetPreloader::RequestPendingAssets()
+{
+	if (PendingAssets.Num() == 0)
+	{
+		return;
+	}
+
+	// The handle is kept so the assets are not released until the stage ends
+	TArray<FSoftObjectPath> Assets = MoveTemp(PendingAssets);
+	PendingAssets.Reset();
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(Assets,
+		FStreamableDelegate::CreateUObject(this, &AStageAssetPreloader::BatchLoaded),
+		FStreamableManager::AsyncLoadHighPriority);
+	if (Handle.IsValid())
+	{
+		Handles.Add(Handle);
+	}
+	else
+	{
+		UE_LOG(LogStageAssetPreloader, Error, TEXT("Failed to request the load of %d assets"), Assets.Num());
+	}
+}
+
+// Called when a batch of assets is loaded
+void AStageAssetPreloader::BatchLoaded()
+{
+	if (!IsPreloadComplete())
+	{
+		return;
+	}
+
+	UE_LOG(LogStageAssetPreloader, Log, TEXT("Stage assets loaded in %.3f s"),
+		FPlatformTime::Seconds() - PreloadStartTime);
+
+	// The callbacks may request more assets, so they are taken out first
+	TArray<FSimpleDelegate> Callbacks = MoveTemp(LoadedCallbacks);
+	LoadedCallbacks.Reset();
+	for (FSimpleDelegate& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound();
+	}
+	OnStageAssetsLoaded.Broadcast();
+}
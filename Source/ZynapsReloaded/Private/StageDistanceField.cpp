@@ -0,0 +1,256 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "StageDistanceField.h"
+#include "StageTerrainMap.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogStageDistanceField);
+
+// Default constructor
+UStageDistanceField::UStageDistanceField() : Super()
+{
+	Origin = FVector2D::ZeroVector;
+	CellSize = DefaultDistanceFieldCellSize;
+	InvCellSize = 1.0f / CellSize;
+	NumCellsY = NumCellsZ = 0;
+}
+
+// Builds the field from the static scenery of the world which crosses the gameplay plane
+bool UStageDistanceField::Build(UWorld* World, float InCellSize)
+{
+	Distances.Reset();
+	NumCellsY = NumCellsZ = 0;
+	if (!World || InCellSize <= 0.0f)
+	{
+		UE_LOG(LogStageDistanceField, Error, TEXT("Invalid parameters to build the distance field"));
+		return false;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Rasterize the static collision which crosses the gameplay plane, the same the player capsule overlaps
+	TArray<bool> Occupied;
+	FVector2D Corner;
+	CellSize = InCellSize;
+	if (!UStageTerrainMap::RasterizeScenery(World, CellSize, Corner, NumCellsY, NumCellsZ, Occupied))
+	{
+		NumCellsY = NumCellsZ = 0;
+		return false;
+	}
+	InvCellSize = 1.0f / CellSize;
+	Origin = Corner + FVector2D(CellSize / 2, CellSize / 2);
+	ComputeSignedDistances(Occupied);
+
+	UE_LOG(LogStageDistanceField, Log, TEXT("Distance field of %dx%d cells of %.0f built in %.1f ms"), NumCellsY,
+		NumCellsZ, CellSize, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+// Builds the field from the baked terrain map of the stage
+bool UStageDistanceField::Build(const UStageTerrainMap* TerrainMap)
+{
+	Distances.Reset();
+	NumCellsY = NumCellsZ = 0;
+	if (!TerrainMap || !TerrainMap->IsBaked())
+	{
+		UE_LOG(LogStageDistanceField, Error, TEXT("The terrain map to build the distance field is not baked"));
+		return false;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Unpack the cells of the map, which has the margin of free cells of the rasterization
+	CellSize = TerrainMap->GetCellSize();
+	InvCellSize = 1.0f / CellSize;
+	NumCellsY = TerrainMap->GetNumCellsY();
+	NumCellsZ = TerrainMap->GetNumCellsZ();
+	Origin = TerrainMap->GetOrigin() + FVector2D(CellSize / 2, CellSize / 2);
+	TArray<bool> Occupied;
+	Occupied.SetNumUninitialized(NumCellsY * NumCellsZ);
+	for (int32 CellZ = 0; CellZ < NumCellsZ; CellZ++)
+	{
+		for (int32 CellY = 0; CellY < NumCellsY; CellY++)
+		{
+			Occupied[CellZ * NumCellsY + CellY] = TerrainMap->IsCellBlocked(CellY, CellZ);
+		}
+	}
+	ComputeSignedDistances(Occupied);
+
+	UE_LOG(LogStageDistanceField, Log, TEXT("Distance field of %dx%d cells of %.0f built from %s in %.1f ms"),
+		NumCellsY, NumCellsZ, CellSize, *TerrainMap->GetName(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+// Returns whether the field has been built
+bool UStageDistanceField::IsBuilt() const
+{
+	return Distances.Num() > 0;
+}
+
+// Returns the signed distance to the scenery at the given location
+float UStageDistanceField::Sample(const FVector2D& Location) const
+{
+	if (Distances.Num() == 0)
+	{
+		return BIG_NUMBER;
+	}
+
+	// Interpolate between the centers of the four surrounding cells
+	const float GridY = (Location.X - Origin.X) * InvCellSize;
+	const float GridZ = (Location.Y - Origin.Y) * InvCellSize;
+	const int32 CellY = FMath::FloorToInt(GridY);
+	const int32 CellZ = FMath::FloorToInt(GridZ);
+	const float AlphaY = GridY - CellY;
+	const float AlphaZ = GridZ - CellZ;
+	const float Bottom = FMath::Lerp(GetCellDistance(CellY, CellZ), GetCellDistance(CellY + 1, CellZ), AlphaY);
+	const float Top = FMath::Lerp(GetCellDistance(CellY, CellZ + 1), GetCellDistance(CellY + 1, CellZ + 1), AlphaY);
+	return FMath::Lerp(Bottom, Top, AlphaZ);
+}
+
+// Returns the gradient of the distance at the given location
+FVector2D UStageDistanceField::SampleGradient(const FVector2D& Location) const
+{
+	if (Distances.Num() == 0)
+	{
+		return FVector2D::ZeroVector;
+	}
+
+	// Central differences one cell apart
+	const float InvStep = InvCellSize / 2;
+	return FVector2D(
+		(Sample(Location + FVector2D(CellSize, 0.0f)) - Sample(Location - FVector2D(CellSize, 0.0f))) * InvStep,
+		(Sample(Location + FVector2D(0.0f, CellSize)) - Sample(Location - FVector2D(0.0f, CellSize))) * InvStep);
+}
+
+// Marches a circle of the given radius along a segment until it touches the scenery
+bool UStageDistanceField::SweepSegment(const FVector2D& Start, const FVector2D& End, float Radius,
+	float& OutFraction) const
+{
+	if (Distances.Num() == 0)
+	{
+		return false;
+	}
+
+	// Each step advances the distance to the scenery, which is known to be free, with a minimum step so the
+	// march ends in a few steps when grazing a surface
+	const float Length = FVector2D::Distance(Start, End);
+	const float InvLength = Length > SMALL_NUMBER ? 1.0f / Length : 0.0f;
+	const float MinStep = CellSize / 4;
+	float Travelled = 0.0f;
+	while (true)
+	{
+		const float Fraction = Travelled * InvLength;
+		const float Distance = Sample(FMath::Lerp(Start, End, Fraction)) - Radius;
+		if (Distance <= 0.0f)
+		{
+			OutFraction = Fraction;
+			return true;
+		}
+		if (Travelled >= Length)
+		{
+			return false;
+		}
+		Travelled = FMath::Min(Travelled + FMath::Max(Distance, MinStep), Length);
+	}
+}
+
+// Returns the size of the cells
+float UStageDistanceField::GetCellSize() const
+{
+	return CellSize;
+}
+
+// Computes the signed distance of each cell from the occupancy of the cells
+void UStageDistanceField::ComputeSignedDistances(const TArray<bool>& Occupied)
+{
+	// The distances from the free cells to the scenery and from the scenery cells to the free space are combined,
+	// so the signed distance is measured to the border between both
+	TArray<float> OutsideDistances;
+	TArray<float> InsideDistances;
+	ComputeDistances(Occupied, true, OutsideDistances);
+	ComputeDistances(Occupied, false, InsideDistances);
+	Distances.SetNumUninitialized(Occupied.Num());
+	const float HalfCell = CellSize / 2;
+	for (int32 Cell = 0; Cell < Occupied.Num(); Cell++)
+	{
+		Distances[Cell] = Occupied[Cell] ? HalfCell - InsideDistances[Cell] : OutsideDistances[Cell] - HalfCell;
+	}
+}
+
+// Returns the distance from each cell to the nearest cell whose occupancy matches the given one
+void UStageDistanceField::ComputeDistances(const TArray<bool>& Occupied, bool bToOccupied,
+	TArray<float>& OutDistances) const
+{
+	// Chamfer weights of the straight and diagonal neighbours, in world units
+	const float Straight = CellSize;
+	const float Diagonal = CellSize * FMath::Sqrt(2.0f);
+
+	OutDistances.SetNumUninitialized(Occupied.Num());
+	for (int32 Cell = 0; Cell < Occupied.Num(); Cell++)
+	{
+		OutDistances[Cell] = Occupied[Cell] == bToOccupied ? 0.0f : BIG_NUMBER;
+	}
+
+	// Forward pass, propagating from the bottom left neighbours
+	for (int32 CellZ = 0; CellZ < NumCellsZ; CellZ++)
+	{
+		for (int32 CellY = 0; CellY < NumCellsY; CellY++)
+		{
+			const int32 Cell = CellZ * NumCellsY + CellY;
+			float Distance = OutDistances[Cell];
+			if (CellY > 0)
+			{
+				Distance = FMath::Min(Distance, OutDistances[Cell - 1] + Straight);
+			}
+			if (CellZ > 0)
+			{
+				const int32 Below = Cell - NumCellsY;
+				Distance = FMath::Min(Distance, OutDistances[Below] + Straight);
+				if (CellY > 0)
+				{
+					Distance = FMath::Min(Distance, OutDistances[Below - 1] + Diagonal);
+				}
+				if (CellY < NumCellsY - 1)
+				{
+					Distance = FMath::Min(Distance, OutDistances[Below + 1] + Diagonal);
+				}
+			}
+			OutDistances[Cell] = Distance;
+		}
+	}
+
+	// Backward pass, propagating from the top right neighbours
+	for (int32 CellZ = NumCellsZ - 1; CellZ >= 0; CellZ--)
+	{
+		for (int32 CellY = NumCellsY - 1; CellY >= 0; CellY--)
+		{
+			const int32 Cell = CellZ * NumCellsY + CellY;
+			float Distance = OutDistances[Cell];
+			if (CellY < NumCellsY - 1)
+			{
+				Distance = FMath::Min(Distance, OutDistances[Cell + 1] + Straight);
+			}
+			if (CellZ < NumCellsZ - 1)
+			{
+				const int32 Above = Cell + NumCellsY;
+				Distance = FMath::Min(Distance, OutDistances[Above] + Straight);
+				if (CellY < NumCellsY - 1)
+				{
+					Distance = FMath::Min(Distance, OutDistances[Above + 1] + Diagonal);
+				}
+				if (CellY > 0)
+				{
+					Distance = FMath::Min(Distance, OutDistances[Above - 1] + Diagonal);
+				}
+			}
+			OutDistances[Cell] = Distance;
+		}
+	}
+}
+
+// Returns the stored distance of a cell clamping its coordinates to the field
+float UStageDistanceField::GetCellDistance(int32 CellY, int32 CellZ) const
+{
+	CellY = FMath::Clamp(CellY, 0, NumCellsY - 1);
+	CellZ = FMath::Clamp(CellZ, 0, NumCellsZ - 1);
+	return Distances[CellZ * NumCellsY + CellY];
+}
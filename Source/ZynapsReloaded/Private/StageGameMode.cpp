@@ -6,6 +6,8 @@
 #include "ZynapsController.h"
 #include "ZynapsPlayerState.h"
 #include "PlayerPawn.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsWorldSettings.h"
 #include "Kismet/GameplayStatics.h"
 
 // Log category
@@ -14,8 +16,8 @@ DEFINE_LOG_CATEGORY(LogStageGameMode);
 // Sets default values
 AStageGameMode::AStageGameMode(const class FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
-	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// The game mode reacts to state changes, so it doesn't need to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Sets the game state class
 	GameStateClass = AZynapsGameState::StaticClass();
@@ -28,6 +30,129 @@ AStageGameMode::AStageGameMode(const class FObjectInitializer& ObjectInitializer
 
 	// Sets the default player state class
 	PlayerStateClass = AZynapsPlayerState::StaticClass();
+
+	// Sets the default enemy swarm class
+	EnemySwarmClass = AEnemySwarm::StaticClass();
+}
+
+// Called before the components of the game mode are initialized
+void AStageGameMode::PreInitializeComponents()
+{
+	Super::PreInitializeComponents();
+
+	// Spawn parameters for the stage managers
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Instigator = Instigator;
+	SpawnParameters.ObjectFlags |= RF_Transient;  // We never want to save the managers into a map
+
+	// Spawn the pool used to reuse the player projectiles
+	ProjectilePool = GetWorld()->SpawnActor<AProjectilePool>(AProjectilePool::StaticClass(), SpawnParameters);
+	if (!ProjectilePool)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the projectile pool"));
+	}
+
+	// Spawn the manager which culls the transient actors leaving the screen
+	ScreenCullingManager = GetWorld()->SpawnActor<AScreenCullingManager>(AScreenCullingManager::StaticClass(),
+		SpawnParameters);
+	if (!ScreenCullingManager)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the screen culling manager"));
+	}
+
+	// Spawn the manager which detects the overlaps between the gameplay actors
+	CollisionManager = GetWorld()->SpawnActor<ACollisionManager>(ACollisionManager::StaticClass(), SpawnParameters);
+	if (!CollisionManager)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the collision manager"));
+	}
+
+	// Spawn the manager which plays the gameplay sounds
+	GameplayAudioManager = GetWorld()->SpawnActor<AGameplayAudioManager>(AGameplayAudioManager::StaticClass(),
+		SpawnParameters);
+	if (!GameplayAudioManager)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the gameplay audio manager"));
+	}
+
+	// Spawn the pool used to reuse the particle systems of the effects
+	EffectsPool = GetWorld()->SpawnActor<AEffectsPool>(AEffectsPool::StaticClass(), SpawnParameters);
+	if (!EffectsPool)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the effects pool"));
+	}
+
+	// Spawn the preloader which streams in the assets of the stage
+	StageAssetPreloader = GetWorld()->SpawnActor<AStageAssetPreloader>(AStageAssetPreloader::StaticClass(),
+		SpawnParameters);
+	if (!StageAssetPreloader)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the stage asset preloader"));
+	}
+
+	// Spawn the manager which streams the chunks of the stage
+	StageStreamingManager = GetWorld()->SpawnActor<AStageStreamingManager>(AStageStreamingManager::StaticClass(),
+		SpawnParameters);
+	if (!StageStreamingManager)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the stage streaming manager"));
+	}
+
+	// Spawn the scheduler which keeps the garbage collection out of the action
+	GarbageCollectionScheduler = GetWorld()->SpawnActor<AGarbageCollectionScheduler>(
+		AGarbageCollectionScheduler::StaticClass(), SpawnParameters);
+	if (!GarbageCollectionScheduler)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the garbage collection scheduler"));
+	}
+
+	// Spawn the system which simulates and draws the enemies
+	EnemySwarm = EnemySwarmClass ? GetWorld()->SpawnActor<AEnemySwarm>(EnemySwarmClass, SpawnParameters) : nullptr;
+	if (!EnemySwarm)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the enemy swarm"));
+	}
+
+	// Spawn the system which simulates and draws the homing missiles
+	HomingMissileSystem = GetWorld()->SpawnActor<AHomingMissileSystem>(AHomingMissileSystem::StaticClass(),
+		SpawnParameters);
+	if (!HomingMissileSystem)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the homing missile system"));
+	}
+
+	// Spawn the system which simulates and draws the seeker missiles
+	SeekerMissileSystem = GetWorld()->SpawnActor<ASeekerMissileSystem>(ASeekerMissileSystem::StaticClass(),
+		SpawnParameters);
+	if (!SeekerMissileSystem)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the seeker missile system"));
+	}
+
+	// Spawn the system which simulates and draws the plasma bombs
+	PlasmaBombSystem = GetWorld()->SpawnActor<APlasmaBombSystem>(APlasmaBombSystem::StaticClass(), SpawnParameters);
+	if (!PlasmaBombSystem)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the plasma bomb system"));
+	}
+
+	// Spawn the system which simulates and draws the laser beams
+	LaserBeamSystem = GetWorld()->SpawnActor<ALaserBeamSystem>(ALaserBeamSystem::StaticClass(), SpawnParameters);
+	if (!LaserBeamSystem)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the laser beam system"));
+	}
+
+	// Spawn the harness which drives a headless simulation run
+	if (ASimulationHarness::IsSimulationRequested())
+	{
+		SimulationHarness = GetWorld()->SpawnActor<ASimulationHarness>(ASimulationHarness::StaticClass(),
+			SpawnParameters);
+		if (!SimulationHarness)
+		{
+			UE_LOG(LogStageGameMode, Error, TEXT("Failed to spawn the simulation harness"));
+		}
+	}
 }
 
 // Called when the game starts
@@ -35,6 +160,49 @@ void AStageGameMode::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// Gather the assets to be loaded while the stage is preparing
+	AZynapsWorldSettings* WorldSettings = AZynapsWorldSettings::GetZynapsWorldSettings(GetWorld());
+	if (StageAssetPreloader)
+	{
+		if (WorldSettings)
+		{
+			StageAssetPreloader->AddManifest(WorldSettings->AssetManifest);
+		}
+
+		// The assets of the pawn and the batched systems are gathered into a single array
+		TArray<FSoftObjectPath> Assets;
+		const APlayerPawn* DefaultPlayerPawn = DefaultPawnClass ?
+			Cast<APlayerPawn>(DefaultPawnClass->GetDefaultObject()) : nullptr;
+		if (DefaultPlayerPawn)
+		{
+			DefaultPlayerPawn->GetPreloadAssets(Assets);
+		}
+		const AInstancedBatchSystem* BatchSystems[] = { EnemySwarm, HomingMissileSystem, SeekerMissileSystem,
+			PlasmaBombSystem, LaserBeamSystem };
+		for (const AInstancedBatchSystem* BatchSystem : BatchSystems)
+		{
+			if (BatchSystem)
+			{
+				BatchSystem->GetPreloadAssets(Assets);
+			}
+		}
+		StageAssetPreloader->AddAssets(Assets);
+	}
+
+	// Build the distance field of the scenery the seeker missiles follow, from the baked terrain map if there is
+	// one, so the physics scene is only probed for the stages without it
+	StageDistanceField = NewObject<UStageDistanceField>(this);
+	UStageTerrainMap* TerrainMap = UStageTerrainMap::GetStageTerrainMap(GetWorld());
+	if (TerrainMap)
+	{
+		StageDistanceField->Build(TerrainMap);
+	}
+	else
+	{
+		StageDistanceField->Build(GetWorld(), WorldSettings ? WorldSettings->DistanceFieldCellSize :
+			DefaultDistanceFieldCellSize);
+	}
+
 	// Find all player start objects in the stage
 	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
 	{
@@ -65,13 +233,9 @@ void AStageGameMode::BeginPlay()
 		return;
 	}
 
-	// Sort the player start object array using the Y coordinate
-	PlayerStarts.Sort([](const APlayerStart& PlayerStart1, const APlayerStart& PlayerStart2)
-	{
-		FVector Location1 = PlayerStart1.GetActorLocation();
-		FVector Location2 = PlayerStart2.GetActorLocation();
-		return Location1.Y < Location2.Y;
-	});
+	// Index the player starts sorted by their Y coordinate to track the checkpoint reached by the camera
+	CheckpointIndex = NewObject<UCheckpointIndex>(this);
+	CheckpointIndex->Init(PlayerStarts, StageInitPlayerStart);
 
 	// Set the current start for the player
 	AZynapsController* ZynapsController = GetZynapsController();
@@ -82,21 +246,37 @@ void AStageGameMode::BeginPlay()
 	}
 	ZynapsController->StartSpot = StageInitPlayerStart;
 
-	// Set initial state
+	// Listen to the player state changes
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	if (!ZynapsPlayerState)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the player state"));
+		return;
+	}
+	ZynapsPlayerState->OnPlayerStateChanged.AddUniqueDynamic(this, &AStageGameMode::PlayerStateChanged);
+
+	// Listen to the stage state changes and set the initial state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
 	{
 		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the stage state"));
 		return;
 	}
-	ZynapsGameState->SetCurrentState(EStageState::Preparing);
+	ZynapsGameState->OnStageStateChanged.AddUniqueDynamic(this, &AStageGameMode::StageStateChanged);
+	if (ZynapsGameState->GetCurrentState() == EStageState::Preparing)
+	{
+		// The stage is already in the initial state, so no transition will be notified
+		HandlePreparingState(ZynapsGameState, ZynapsPlayerState, ZynapsController);
+	}
+	else
+	{
+		ZynapsGameState->SetCurrentState(EStageState::Preparing);
+	}
 }
 
-// Called every frame
-void AStageGameMode::Tick(float DeltaSeconds)
+// Called when the stage state changes
+void AStageGameMode::StageStateChanged(EStageState PreviousState, EStageState NewState)
 {
-	Super::Tick(DeltaSeconds);
-
 	// Get the stage state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -106,48 +286,73 @@ void AStageGameMode::Tick(float DeltaSeconds)
 	}
 
 	// Get the player's state
-	AZynapsPlayerState* PlayerState = GetZynapsPlayerState();
-	if (!PlayerState)
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	if (!ZynapsPlayerState)
 	{
 		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the player state"));
 		return;
 	}
 
 	// Get the player controller
-	AZynapsController* Controller = GetZynapsController();
-	if (!Controller)
+	AZynapsController* ZynapsController = GetZynapsController();
+	if (!ZynapsController)
 	{
 		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the player controller"));
 		return;
 	}
 
-	// Evaluate the current player start
-	APlayerStart* NewPlayerStart = EvaluatePlayerStartSpot();
-	if (!NewPlayerStart)
-	{
-		UE_LOG(LogStageGameMode, Error, TEXT("The player start spot could not be evaluated"));
-		return;
-	}
-	if (Controller->StartSpot == nullptr || Controller->StartSpot != NewPlayerStart)
-	{
-		Controller->StartSpot = NewPlayerStart;
-	}
-
-	// Handle stage states
-	switch (ZynapsGameState->GetCurrentState())
+	// Handle the new stage state
+	switch (NewState)
 	{
 	case EStageState::Preparing:
-		HandlePreparingState(ZynapsGameState, PlayerState, Controller);
+		HandlePreparingState(ZynapsGameState, ZynapsPlayerState, ZynapsController);
 		break;
 	case EStageState::Playing:
-		HandlePlayingState(ZynapsGameState, PlayerState, Controller);
+		HandlePlayingState(ZynapsGameState, ZynapsPlayerState, ZynapsController);
 		break;
 	case EStageState::GameOver:
-		HandleGameOverState(ZynapsGameState, PlayerState, Controller);
+		HandleGameOverState(ZynapsGameState, ZynapsPlayerState, ZynapsController);
 		break;
 	}
 }
 
+// Called when the player state changes
+void AStageGameMode::PlayerStateChanged(EPlayerState PreviousState, EPlayerState NewState)
+{
+	// Get the stage state
+	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
+	if (!ZynapsGameState)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the game state"));
+		return;
+	}
+
+	// The player state only drives the stage while playing. Otherwise, it is handled when the stage enters
+	// the Playing state.
+	if (ZynapsGameState->GetCurrentState() != EStageState::Playing)
+	{
+		return;
+	}
+
+	// Get the player's state
+	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
+	if (!ZynapsPlayerState)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the player state"));
+		return;
+	}
+
+	// Get the player controller
+	AZynapsController* ZynapsController = GetZynapsController();
+	if (!ZynapsController)
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("Failed to retrieve the player controller"));
+		return;
+	}
+
+	HandlePlayingState(ZynapsGameState, ZynapsPlayerState, ZynapsController);
+}
+
 // Implementation which returns the StageInit player start
 AActor* AStageGameMode::ChoosePlayerStart_Implementation(AController* Controller)
 {
@@ -163,7 +368,97 @@ AActor* AStageGameMode::ChoosePlayerStart_Implementation(AController* Controller
 	return nullptr;
 }
 
-// Called from Tick() to evaluate the player start to be used when the player is respawned
+// Returns the pool used to reuse the player projectiles
+AProjectilePool* AStageGameMode::GetProjectilePool() const
+{
+	return ProjectilePool;
+}
+
+// Returns the manager which checks whether transient actors have left the screen
+AScreenCullingManager* AStageGameMode::GetScreenCullingManager() const
+{
+	return ScreenCullingManager;
+}
+
+// Returns the manager which detects the overlaps between the gameplay actors
+ACollisionManager* AStageGameMode::GetCollisionManager() const
+{
+	return CollisionManager;
+}
+
+// Returns the manager which plays the gameplay sounds through pre-allocated voices
+AGameplayAudioManager* AStageGameMode::GetGameplayAudioManager() const
+{
+	return GameplayAudioManager;
+}
+
+// Returns the pool used to reuse the particle systems of the one-shot effects
+AEffectsPool* AStageGameMode::GetEffectsPool() const
+{
+	return EffectsPool;
+}
+
+// Returns the preloader which streams in the assets of the stage
+AStageAssetPreloader* AStageGameMode::GetStageAssetPreloader() const
+{
+	return StageAssetPreloader;
+}
+
+// Returns the manager which streams the chunks of the stage as the camera scrolls
+AStageStreamingManager* AStageGameMode::GetStageStreamingManager() const
+{
+	return StageStreamingManager;
+}
+
+// Returns the scheduler which keeps the garbage collection out of the action
+AGarbageCollectionScheduler* AStageGameMode::GetGarbageCollectionScheduler() const
+{
+	return GarbageCollectionScheduler;
+}
+
+// Returns the system which simulates and draws the enemies
+AEnemySwarm* AStageGameMode::GetEnemySwarm() const
+{
+	return EnemySwarm;
+}
+
+// Returns the system which simulates and draws the homing missiles
+AHomingMissileSystem* AStageGameMode::GetHomingMissileSystem() const
+{
+	return HomingMissileSystem;
+}
+
+// Returns the system which simulates and draws the seeker missiles
+ASeekerMissileSystem* AStageGameMode::GetSeekerMissileSystem() const
+{
+	return SeekerMissileSystem;
+}
+
+// Returns the system which simulates and draws the plasma bombs
+APlasmaBombSystem* AStageGameMode::GetPlasmaBombSystem() const
+{
+	return PlasmaBombSystem;
+}
+
+// Returns the system which simulates and draws the laser beams
+ALaserBeamSystem* AStageGameMode::GetLaserBeamSystem() const
+{
+	return LaserBeamSystem;
+}
+
+// Returns the distance field of the stage scenery
+UStageDistanceField* AStageGameMode::GetStageDistanceField() const
+{
+	return StageDistanceField;
+}
+
+// Returns the index which tracks the checkpoint reached by the camera
+UCheckpointIndex* AStageGameMode::GetCheckpointIndex() const
+{
+	return CheckpointIndex;
+}
+
+// Called before respawning the player to evaluate the player start to be used
 APlayerStart* AStageGameMode::EvaluatePlayerStartSpot()
 {
 	AZynapsCameraManager* CameraManager = GetZynapsCameraManager();
@@ -173,21 +468,17 @@ APlayerStart* AStageGameMode::EvaluatePlayerStartSpot()
 		return nullptr;
 	}
 
-	APlayerStart* NewPlayerStart = StageInitPlayerStart;
-	FVector CameraLocation = CameraManager->GetCameraLocation();
-	for (APlayerStart* PlayerStart : PlayerStarts)
+	if (!CheckpointIndex)
 	{
-		FVector PlayerStartLocation = PlayerStart->GetActorLocation();
-		UE_LOG(LogStageGameMode, VeryVerbose,
-			TEXT("Evaluating player start %s at %f against camera location at %f"),
-			*PlayerStart->GetName(), PlayerStartLocation.Y, CameraLocation.Y);
-		if (CameraLocation.Y > PlayerStartLocation.Y)
-		{
-			NewPlayerStart = PlayerStart;
-		}
+		UE_LOG(LogStageGameMode, Error, TEXT("The checkpoint index was not built"));
+		return StageInitPlayerStart;
 	}
+
+	// Bring the checkpoint index up to date with the camera location
+	FVector CameraLocation = CameraManager->GetCameraLocation();
+	APlayerStart* NewPlayerStart = CheckpointIndex->Seek(CameraLocation.Y);
 	UE_LOG(LogStageGameMode, VeryVerbose, TEXT("Current player start evaluated to %s"),
-		*NewPlayerStart->GetName());
+		*GetNameSafe(NewPlayerStart));
 	return NewPlayerStart;
 }
 
@@ -195,11 +486,42 @@ APlayerStart* AStageGameMode::EvaluatePlayerStartSpot()
 void AStageGameMode::HandlePreparingState(AZynapsGameState* ZynapsGameState, AZynapsPlayerState* ZynapsPlayerState,
 	AZynapsController* ZynapsController)
 {
-	// Start playing after a given time
-	if (!PreparingTimerHandle.IsValid() || !GetWorldTimerManager().IsTimerActive(PreparingTimerHandle))
+	// Stream in the stage assets while preparing. The preload only runs the first time.
+	if (StageAssetPreloader)
+	{
+		StageAssetPreloader->StartPreload();
+	}
+
+	// Remove the enemies and the shots of the previous attempt
+	if (EnemySwarm)
+	{
+		EnemySwarm->ClearEnemies();
+	}
+	if (HomingMissileSystem)
+	{
+		HomingMissileSystem->ClearMissiles();
+	}
+	if (SeekerMissileSystem)
+	{
+		SeekerMissileSystem->ClearMissiles();
+	}
+	if (PlasmaBombSystem)
 	{
-		GetWorldTimerManager().SetTimer(PreparingTimerHandle, this, &AStageGameMode::Play, PreparingDelay);
+		PlasmaBombSystem->ClearBombs();
 	}
+	if (LaserBeamSystem)
+	{
+		LaserBeamSystem->ClearBeams();
+	}
+
+	// Collect the garbage left by the previous attempt while there is no action
+	if (GarbageCollectionScheduler)
+	{
+		GarbageCollectionScheduler->RequestCollection();
+	}
+
+	// Start playing after a given time
+	GetWorldTimerManager().SetTimer(PreparingTimerHandle, this, &AStageGameMode::Play, PreparingDelay);
 }
 
 // Handles the Playing state
@@ -209,6 +531,12 @@ void AStageGameMode::HandlePlayingState(AZynapsGameState* ZynapsGameState, AZyna
 	// Update the state of the stage based on the state of the player
 	if (ZynapsPlayerState->GetCurrentState() == EPlayerState::Destroyed)
 	{
+		// There is no action until the player respawns, so it is a good time to collect the garbage
+		if (GarbageCollectionScheduler)
+		{
+			GarbageCollectionScheduler->RequestCollection();
+		}
+
 		// The player has been destroyed
 		if (!PlayerCanRestart(ZynapsController))
 		{
@@ -217,11 +545,8 @@ void AStageGameMode::HandlePlayingState(AZynapsGameState* ZynapsGameState, AZyna
 		}
 		else
 		{
-			// More lives available, set a timed respawn if it was not set previously
-			if (!SpawnTimerHandle.IsValid() || !GetWorldTimerManager().IsTimerActive(SpawnTimerHandle))
-			{
-				GetWorldTimerManager().SetTimer(SpawnTimerHandle, this, &AStageGameMode::Respawn, RespawnDelay);
-			}
+			// More lives available, set a timed respawn
+			GetWorldTimerManager().SetTimer(SpawnTimerHandle, this, &AStageGameMode::Respawn, RespawnDelay);
 		}
 	}
 }
@@ -230,11 +555,14 @@ void AStageGameMode::HandlePlayingState(AZynapsGameState* ZynapsGameState, AZyna
 void AStageGameMode::HandleGameOverState(AZynapsGameState* ZynapsGameState, AZynapsPlayerState* ZynapsPlayerState,
 	AZynapsController* ZynapsController)
 {
-	// Go back to the main menu after a given time
-	if (!GameOverTimerHandle.IsValid() || !GetWorldTimerManager().IsTimerActive(GameOverTimerHandle))
+	// Collect the garbage while the game over message is shown
+	if (GarbageCollectionScheduler)
 	{
-		GetWorldTimerManager().SetTimer(GameOverTimerHandle, this, &AStageGameMode::ExitToMenu, GameOverDelay);
+		GarbageCollectionScheduler->RequestCollection();
 	}
+
+	// Go back to the main menu after a given time
+	GetWorldTimerManager().SetTimer(GameOverTimerHandle, this, &AStageGameMode::ExitToMenu, GameOverDelay);
 }
 
 // Sets the state state to Playing
@@ -248,6 +576,22 @@ void AStageGameMode::Play()
 		return;
 	}
 
+	// Wait for the stage assets if they are still loading
+	if (StageAssetPreloader && !StageAssetPreloader->IsPreloadComplete())
+	{
+		UE_LOG(LogStageGameMode, Log, TEXT("Waiting for the stage assets (%.0f%% loaded)"),
+			StageAssetPreloader->GetPreloadProgress() * 100.0f);
+		StageAssetPreloader->CallWhenLoaded(FSimpleDelegate::CreateUObject(this, &AStageGameMode::Play));
+		return;
+	}
+
+	// Wait for the stage chunks around the camera, i.e. after respawning at a checkpoint left far behind
+	if (StageStreamingManager && !StageStreamingManager->IsViewportAreaReady())
+	{
+		GetWorldTimerManager().SetTimer(PreparingTimerHandle, this, &AStageGameMode::Play, StreamingWaitInterval);
+		return;
+	}
+
 	// Set the stage state to Playing
 	ZynapsGameState->SetCurrentState(EStageState::Playing);
 }
@@ -279,6 +623,17 @@ void AStageGameMode::Respawn()
 		return;
 	}
 
+	// Evaluate the player start reached by the camera
+	APlayerStart* NewPlayerStart = EvaluatePlayerStartSpot();
+	if (NewPlayerStart)
+	{
+		ZynapsController->StartSpot = NewPlayerStart;
+	}
+	else
+	{
+		UE_LOG(LogStageGameMode, Error, TEXT("The player start spot could not be evaluated"));
+	}
+
 	// Set the camera location back to the current player start
 	FVector CameraLocation = ZynapsCameraManager->GetCameraLocation();
 	APlayerStart* PlayerStart = Cast<APlayerStart>(ZynapsController->StartSpot.Get());
@@ -307,67 +662,34 @@ void AStageGameMode::ExitToMenu()
 // Returns the player's pawn
 APlayerPawn* AStageGameMode::GetPlayerPawn() const 
 {
-	APawn* Pawn = UGameplayStatics::GetPlayerPawn(this, 0);
-	if (!Pawn)
-	{
-		return nullptr;
-	}
-	return Cast<APlayerPawn>(Pawn);
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetPlayerPawn() : nullptr;
 }
 
 // Retrieves the game state
 AZynapsGameState* AStageGameMode::GetZynapsGameState() const
 {
-	if (!GameState)
-	{
-		return nullptr;
-	}
-	return Cast<AZynapsGameState>(GameState);
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetGameState() : nullptr;
 }
 
 // Returns the player controller
 AZynapsController* AStageGameMode::GetZynapsController() const
 {
-	APlayerController* Controller = GetWorld()->GetFirstPlayerController();
-	if (!Controller)
-	{
-		return nullptr;
-	}
-	return Cast<AZynapsController>(Controller);
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetController() : nullptr;
 }
 
 // Returns the player state
 AZynapsPlayerState* AStageGameMode::GetZynapsPlayerState() const
 {
-	AZynapsController* Controller = GetZynapsController();
-	if (!Controller)
-	{
-		return nullptr;
-	}
-
-	APlayerState* PlayerState = Controller->PlayerState;
-	if (!PlayerState)
-	{
-		return nullptr;
-	}
-
-	return Cast<AZynapsPlayerState>(PlayerState);
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetPlayerState() : nullptr;
 }
 
 // Returns the camera manager
 AZynapsCameraManager* AStageGameMode::GetZynapsCameraManager() const
 {
-	AZynapsController* Controller = GetZynapsController();
-	if (!Controller)
-	{
-		return nullptr;
-	}
-
-	APlayerCameraManager* CameraManager = Controller->PlayerCameraManager;
-	if (!CameraManager)
-	{
-		return nullptr;
-	}
-
-	return Cast<AZynapsCameraManager>(CameraManager);
-}
\ No newline at end of file
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetCameraManager() : nullptr;
+}
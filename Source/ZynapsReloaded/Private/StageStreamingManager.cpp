@@ -0,0 +1,181 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "StageStreamingManager.h"
+#include "ProjectionUtil.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsWorldSettings.h"
+#include "Engine/LevelStreaming.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogStageStreamingManager);
+
+// Sets default values
+AStageStreamingManager::AStageStreamingManager() : Super()
+{
+	// Tick once per frame after the camera has been moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// Init streaming vars
+	ViewMinY = ViewMaxY = 0.0f;
+	NextRequestId = 0;
+}
+
+// Called when the game starts or when spawned
+void AStageStreamingManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AZynapsWorldSettings* WorldSettings = AZynapsWorldSettings::GetZynapsWorldSettings(GetWorld());
+	if (WorldSettings)
+	{
+		for (const FStageStreamingChunk& Chunk : WorldSettings->StreamingChunks)
+		{
+			if (Chunk.LevelName == NAME_None || Chunk.MaxY < Chunk.MinY)
+			{
+				UE_LOG(LogStageStreamingManager, Warning, TEXT("Ignoring the invalid streaming chunk %s"),
+					*Chunk.LevelName.ToString());
+				continue;
+			}
+			Chunks.Add(Chunk);
+		}
+	}
+	Chunks.Sort([](const FStageStreamingChunk& A, const FStageStreamingChunk& B)
+	{
+		return A.MinY < B.MinY;
+	});
+	ChunkLoadRequested.Init(false, Chunks.Num());
+
+	// Nothing to stream in a monolithic stage
+	SetActorTickEnabled(Chunks.Num() > 0);
+	UE_LOG(LogStageStreamingManager, Verbose, TEXT("%d streaming chunks found in the stage"), Chunks.Num());
+}
+
+// Called every frame
+void AStageStreamingManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsStreaming);
+
+	Super::Tick(DeltaSeconds);
+
+	// Get the viewport span
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	APlayerController* PlayerController = WorldContext ? WorldContext->GetController() : nullptr;
+	AZynapsWorldSettings* WorldSettings = WorldContext ? WorldContext->GetWorldSettings() : nullptr;
+	if (!PlayerController || !WorldSettings)
+	{
+		return;
+	}
+	FVector TopLeftBound;
+	FVector BottomRightBound;
+	if (!UProjectionUtil::GetCachedViewportBounds(PlayerController, TopLeftBound, BottomRightBound))
+	{
+		UE_LOG(LogStageStreamingManager, Error, TEXT("Failed to calculate the viewport bounds"));
+		return;
+	}
+	ViewMinY = TopLeftBound.Y;
+	ViewMaxY = BottomRightBound.Y;
+
+	// The lead distance covers the scroll during the time a chunk needs to load. The chunks are loaded when they
+	// enter the streaming span and unloaded once they are beyond it by the unload margin, so a chunk at the edge
+	// doesn't load and unload repeatedly.
+	const float LeadDistance = FMath::Abs(WorldSettings->ScrollSpeed) * WorldSettings->StreamingLeadTime;
+	const float LoadMinY = ViewMinY;
+	const float LoadMaxY = ViewMaxY + LeadDistance;
+	const float UnloadMinY = LoadMinY - WorldSettings->StreamingUnloadMargin;
+	const float UnloadMaxY = LoadMaxY + WorldSettings->StreamingUnloadMargin;
+	for (int32 Index = 0; Index < Chunks.Num(); Index++)
+	{
+		const FStageStreamingChunk& Chunk = Chunks[Index];
+		if (!ChunkLoadRequested[Index] && Chunk.MaxY >= LoadMinY && Chunk.MinY <= LoadMaxY)
+		{
+			StreamChunk(Index, true);
+		}
+		else if (ChunkLoadRequested[Index] && (Chunk.MaxY < UnloadMinY || Chunk.MinY > UnloadMaxY))
+		{
+			StreamChunk(Index, false);
+		}
+	}
+}
+
+// Returns the streaming manager of the specified world or nullptr if the game mode doesn't provide one
+AStageStreamingManager* AStageStreamingManager::GetStageStreamingManager(UWorld* World)
+{
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(World);
+	if (!WorldContext)
+	{
+		return nullptr;
+	}
+
+	AStageGameMode* GameMode = WorldContext->GetStageGameMode();
+	if (!GameMode)
+	{
+		return nullptr;
+	}
+	return GameMode->GetStageStreamingManager();
+}
+
+// Returns whether all the chunks within the viewport are loaded and visible
+bool AStageStreamingManager::IsViewportAreaReady() const
+{
+	for (int32 Index = 0; Index < Chunks.Num(); Index++)
+	{
+		const FStageStreamingChunk& Chunk = Chunks[Index];
+		if (Chunk.MaxY >= ViewMinY && Chunk.MinY <= ViewMaxY && !IsChunkVisible(Index))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns the number of chunks currently requested to be loaded
+int32 AStageStreamingManager::GetNumLoadedChunks() const
+{
+	int32 Result = 0;
+	for (bool bLoadRequested : ChunkLoadRequested)
+	{
+		Result += bLoadRequested ? 1 : 0;
+	}
+	return Result;
+}
+
+// Requests the load or the unload of a chunk
+void AStageStreamingManager::StreamChunk(int32 Index, bool bLoad)
+{
+	ChunkLoadRequested[Index] = bLoad;
+
+	// Each request needs its own identifier, otherwise it would be discarded while a previous one is pending
+	FLatentActionInfo LatentInfo;
+	LatentInfo.CallbackTarget = this;
+	LatentInfo.ExecutionFunction = GET_FUNCTION_NAME_CHECKED(AStageStreamingManager, ChunkStreamed);
+	LatentInfo.UUID = NextRequestId++;
+	LatentInfo.Linkage = 0;
+
+	const FName LevelName = Chunks[Index].LevelName;
+	if (bLoad)
+	{
+		UE_LOG(LogStageStreamingManager, Verbose, TEXT("Loading the chunk %s"), *LevelName.ToString());
+		UGameplayStatics::LoadStreamLevel(GetWorld(), LevelName, true, false, LatentInfo);
+	}
+	else
+	{
+		UE_LOG(LogStageStreamingManager, Verbose, TEXT("Unloading the chunk %s"), *LevelName.ToString());
+		UGameplayStatics::UnloadStreamLevel(GetWorld(), LevelName, LatentInfo);
+	}
+}
+
+// Called when a chunk finishes loading or unloading
+void AStageStreamingManager::ChunkStreamed()
+{
+	UE_LOG(LogStageStreamingManager, Verbose, TEXT("Chunk streamed, %d chunks loaded"), GetNumLoadedChunks());
+}
+
+// Returns whether a chunk is loaded and visible
+bool AStageStreamingManager::IsChunkVisible(int32 Index) const
+{
+	ULevelStreaming* StreamingLevel = UGameplayStatics::GetStreamingLevel(GetWorld(), Chunks[Index].LevelName);
+	return StreamingLevel && StreamingLevel->IsLevelLoaded() && StreamingLevel->IsLevelVisible();
+}
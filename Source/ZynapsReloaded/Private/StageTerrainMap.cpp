@@ -0,0 +1,282 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "StageTerrainMap.h"
+#include "ZynapsWorldSettings.h"
+
+// Log category
+DEFINE_LOG_CATEGORY(LogStageTerrainMap);
+
+// Default constructor
+UStageTerrainMap::UStageTerrainMap() : Super()
+{
+	Origin = FVector2D::ZeroVector;
+	CellSize = DefaultTerrainMapCellSize;
+	NumCellsY = NumCellsZ = NumTilesY = 0;
+}
+
+// Returns the terrain map of the specified world or nullptr if its stage has no baked map
+UStageTerrainMap* UStageTerrainMap::GetStageTerrainMap(UWorld* World)
+{
+	AZynapsWorldSettings* WorldSettings = AZynapsWorldSettings::GetZynapsWorldSettings(World);
+	UStageTerrainMap* TerrainMap = WorldSettings ? WorldSettings->TerrainMap : nullptr;
+	return TerrainMap && TerrainMap->IsBaked() ? TerrainMap : nullptr;
+}
+
+// Rasterizes the static scenery of the world which crosses the gameplay plane
+bool UStageTerrainMap::RasterizeScenery(UWorld* World, float& InOutCellSize, FVector2D& OutOrigin,
+	int32& OutNumCellsY, int32& OutNumCellsZ, TArray<bool>& OutOccupied)
+{
+	if (!World || InOutCellSize <= 0.0f)
+	{
+		UE_LOG(LogStageTerrainMap, Error, TEXT("Invalid parameters to rasterize the scenery"));
+		return false;
+	}
+
+	// Gather the static collision which crosses the gameplay plane, the same the player capsule overlaps
+	TArray<UPrimitiveComponent*> Scenery;
+	FBox2D Bounds(ForceInit);
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		TInlineComponentArray<UPrimitiveComponent*> Components(*It);
+		for (UPrimitiveComponent* Component : Components)
+		{
+			if (Component->Mobility != EComponentMobility::Static || !Component->IsCollisionEnabled() ||
+				Component->GetCollisionObjectType() != ECC_WorldStatic)
+			{
+				continue;
+			}
+
+			const FBox Box = Component->Bounds.GetBox();
+			if (Box.Min.X > TerrainProbeHalfDepth || Box.Max.X < -TerrainProbeHalfDepth)
+			{
+				continue;
+			}
+			Scenery.Add(Component);
+			Bounds += FVector2D(Box.Min.Y, Box.Min.Z);
+			Bounds += FVector2D(Box.Max.Y, Box.Max.Z);
+		}
+	}
+	if (Scenery.Num() == 0)
+	{
+		UE_LOG(LogStageTerrainMap, Warning, TEXT("No scenery found to rasterize"));
+		return false;
+	}
+
+	// Size the grid to the scenery with a margin of free cells, coarsening it if the stage is too large
+	FVector2D Size = Bounds.GetSize();
+	while ((Size.X / InOutCellSize + 4.0f) * (Size.Y / InOutCellSize + 4.0f) > MaxTerrainCells)
+	{
+		InOutCellSize *= 2.0f;
+	}
+	const float InvCellSize = 1.0f / InOutCellSize;
+	Bounds = Bounds.ExpandBy(2.0f * InOutCellSize);
+	Size = Bounds.GetSize();
+	OutNumCellsY = FMath::CeilToInt(Size.X * InvCellSize);
+	OutNumCellsZ = FMath::CeilToInt(Size.Y * InvCellSize);
+	OutOrigin = Bounds.Min;
+
+	// Each component only probes the cells within its bounds. A cell is covered if a box of its size in the
+	// gameplay plane overlaps the collision of the component.
+	OutOccupied.Init(false, OutNumCellsY * OutNumCellsZ);
+	const float HalfCell = InOutCellSize / 2;
+	const FCollisionShape Probe = FCollisionShape::MakeBox(FVector(TerrainProbeHalfDepth, HalfCell, HalfCell));
+	for (UPrimitiveComponent* Component : Scenery)
+	{
+		const FBox Box = Component->Bounds.GetBox();
+		const int32 MinY = FMath::Max(FMath::FloorToInt((Box.Min.Y - OutOrigin.X) * InvCellSize), 0);
+		const int32 MaxY = FMath::Min(FMath::FloorToInt((Box.Max.Y - OutOrigin.X) * InvCellSize),
+			OutNumCellsY - 1);
+		const int32 MinZ = FMath::Max(FMath::FloorToInt((Box.Min.Z - OutOrigin.Y) * InvCellSize), 0);
+		const int32 MaxZ = FMath::Min(FMath::FloorToInt((Box.Max.Z - OutOrigin.Y) * InvCellSize),
+			OutNumCellsZ - 1);
+		for (int32 CellZ = MinZ; CellZ <= MaxZ; CellZ++)
+		{
+			for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+			{
+				const int32 Cell = CellZ * OutNumCellsY + CellY;
+				const FVector Center(0.0f, OutOrigin.X + CellY * InOutCellSize + HalfCell,
+					OutOrigin.Y + CellZ * InOutCellSize + HalfCell);
+				if (!OutOccupied[Cell] && Component->OverlapComponent(Center, FQuat::Identity, Probe))
+				{
+					OutOccupied[Cell] = true;
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogStageTerrainMap, Verbose, TEXT("Rasterized %d scenery components into %dx%d cells of %.0f"),
+		Scenery.Num(), OutNumCellsY, OutNumCellsZ, InOutCellSize);
+	return true;
+}
+
+#if WITH_EDITOR
+// Bakes the map from the static scenery of the world
+bool UStageTerrainMap::Bake(UWorld* World, float InCellSize)
+{
+	TArray<bool> Occupied;
+	float NewCellSize = InCellSize;
+	FVector2D NewOrigin;
+	int32 NewNumCellsY;
+	int32 NewNumCellsZ;
+	if (!RasterizeScenery(World, NewCellSize, NewOrigin, NewNumCellsY, NewNumCellsZ, Occupied))
+	{
+		return false;
+	}
+
+	// Pack the cells into the tiles
+	Modify();
+	Origin = NewOrigin;
+	CellSize = NewCellSize;
+	NumCellsY = NewNumCellsY;
+	NumCellsZ = NewNumCellsZ;
+	NumTilesY = FMath::DivideAndRoundUp(NumCellsY, TerrainTileSize);
+	const int32 NumTilesZ = FMath::DivideAndRoundUp(NumCellsZ, TerrainTileSize);
+	Tiles.Init(0, NumTilesY * NumTilesZ);
+	int32 NumBlocked = 0;
+	for (int32 CellZ = 0; CellZ < NumCellsZ; CellZ++)
+	{
+		for (int32 CellY = 0; CellY < NumCellsY; CellY++)
+		{
+			if (Occupied[CellZ * NumCellsY + CellY])
+			{
+				const int32 Tile = (CellZ / TerrainTileSize) * NumTilesY + CellY / TerrainTileSize;
+				const int32 Bit = (CellZ % TerrainTileSize) * TerrainTileSize + CellY % TerrainTileSize;
+				Tiles[Tile] |= 1ull << Bit;
+				NumBlocked++;
+			}
+		}
+	}
+
+	UE_LOG(LogStageTerrainMap, Log, TEXT("Terrain map of %dx%d cells of %.0f baked in %d tiles, %d cells blocked"),
+		NumCellsY, NumCellsZ, CellSize, Tiles.Num(), NumBlocked);
+	return true;
+}
+#endif
+
+// Returns whether the map has been baked
+bool UStageTerrainMap::IsBaked() const
+{
+	return Tiles.Num() > 0;
+}
+
+// Returns whether a location is inside the scenery
+bool UStageTerrainMap::IsBlocked(const FVector2D& Location) const
+{
+	const FVector2D Grid = (Location - Origin) / CellSize;
+	return IsCellBlocked(FMath::FloorToInt(Grid.X), FMath::FloorToInt(Grid.Y));
+}
+
+// Returns whether a box overlaps the scenery
+bool UStageTerrainMap::OverlapsBox(const FBox2D& Box) const
+{
+	int32 MinY, MinZ, MaxY, MaxZ;
+	if (!GetCellRange(Box, MinY, MinZ, MaxY, MaxZ))
+	{
+		return false;
+	}
+
+	for (int32 CellZ = MinZ; CellZ <= MaxZ; CellZ++)
+	{
+		for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+		{
+			if (IsCellBlocked(CellY, CellZ))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// Returns whether a capsule overlaps the scenery
+bool UStageTerrainMap::OverlapsCapsule(const FVector2D& SegmentStart, const FVector2D& SegmentEnd,
+	float Radius) const
+{
+	FBox2D Box(SegmentStart, SegmentStart);
+	Box += SegmentEnd;
+	int32 MinY, MinZ, MaxY, MaxZ;
+	if (!GetCellRange(Box.ExpandBy(Radius), MinY, MinZ, MaxY, MaxZ))
+	{
+		return false;
+	}
+
+	// Test the distance from the center of each blocked cell to the segment
+	const FVector2D Segment = SegmentEnd - SegmentStart;
+	const float SegmentSizeSquared = Segment.SizeSquared();
+	const float ContactDistance = Radius + CellSize / 2;
+	for (int32 CellZ = MinZ; CellZ <= MaxZ; CellZ++)
+	{
+		for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+		{
+			if (!IsCellBlocked(CellY, CellZ))
+			{
+				continue;
+			}
+
+			const FVector2D Center = Origin + FVector2D(CellY + 0.5f, CellZ + 0.5f) * CellSize;
+			const float Alpha = SegmentSizeSquared > SMALL_NUMBER ?
+				FVector2D::DotProduct(Center - SegmentStart, Segment) / SegmentSizeSquared : 0.0f;
+			const FVector2D Closest = SegmentStart + Segment * FMath::Clamp(Alpha, 0.0f, 1.0f);
+			if (FVector2D::DistSquared(Center, Closest) <= ContactDistance * ContactDistance)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// Returns whether a cell is inside the scenery
+bool UStageTerrainMap::IsCellBlocked(int32 CellY, int32 CellZ) const
+{
+	if (CellY < 0 || CellZ < 0 || CellY >= NumCellsY || CellZ >= NumCellsZ)
+	{
+		return false;
+	}
+
+	const uint64 Tile = Tiles[(CellZ / TerrainTileSize) * NumTilesY + CellY / TerrainTileSize];
+	const int32 Bit = (CellZ % TerrainTileSize) * TerrainTileSize + CellY % TerrainTileSize;
+	return ((Tile >> Bit) & 1) != 0;
+}
+
+// Returns the location of the corner of the first cell
+FVector2D UStageTerrainMap::GetOrigin() const
+{
+	return Origin;
+}
+
+// Returns the size of the cells
+float UStageTerrainMap::GetCellSize() const
+{
+	return CellSize;
+}
+
+// Returns the number of cells along the Y axis
+int32 UStageTerrainMap::GetNumCellsY() const
+{
+	return NumCellsY;
+}
+
+// Returns the number of cells along the Z axis
+int32 UStageTerrainMap::GetNumCellsZ() const
+{
+	return NumCellsZ;
+}
+
+// Returns the range of cells which covers a box, clamped to the map
+bool UStageTerrainMap::GetCellRange(const FBox2D& Box, int32& OutMinY, int32& OutMinZ, int32& OutMaxY,
+	int32& OutMaxZ) const
+{
+	if (Tiles.Num() == 0)
+	{
+		return false;
+	}
+
+	const float InvCellSize = 1.0f / CellSize;
+	OutMinY = FMath::Max(FMath::FloorToInt((Box.Min.X - Origin.X) * InvCellSize), 0);
+	OutMinZ = FMath::Max(FMath::FloorToInt((Box.Min.Y - Origin.Y) * InvCellSize), 0);
+	OutMaxY = FMath::Min(FMath::FloorToInt((Box.Max.X - Origin.X) * InvCellSize), NumCellsY - 1);
+	OutMaxZ = FMath::Min(FMath::FloorToInt((Box.Max.Y - Origin.Y) * InvCellSize), NumCellsZ - 1);
+	return OutMinY <= OutMaxY && OutMinZ <= OutMaxZ;
+}
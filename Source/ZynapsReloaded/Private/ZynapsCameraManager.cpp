@@ -3,6 +3,8 @@
 #include "ZynapsReloaded.h"
 #include "ZynapsCameraManager.h"
 #include "ZynapsWorldSettings.h"
+#include "StageGameMode.h"
+#include "ZynapsWorldContext.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogZynapsCameraManager);
@@ -10,10 +12,20 @@ DEFINE_LOG_CATEGORY(LogZynapsCameraManager);
 // Performs per-tick camera update
 void AZynapsCameraManager::UpdateCamera(float DeltaSeconds)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ZynapsCameraUpdate);
+
 	Super::UpdateCamera(DeltaSeconds);
 
+	// Get the world context
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	if (!WorldContext)
+	{
+		UE_LOG(LogZynapsCameraManager, Error, TEXT("Failed to retrieve the world context"));
+		return;
+	}
+
 	// Get game state
-	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
+	AZynapsGameState* ZynapsGameState = WorldContext->GetGameState();
 	if (!ZynapsGameState)
 	{
 		UE_LOG(LogZynapsCameraManager, Error, TEXT("Failed to retrieve the game state"));
@@ -35,7 +47,7 @@ void AZynapsCameraManager::UpdateCamera(float DeltaSeconds)
 	}
 
 	// Scroll the camera using the speed in the world settings
-	AZynapsWorldSettings* WorldSettings = AZynapsWorldSettings::GetZynapsWorldSettings(GetWorld());
+	AZynapsWorldSettings* WorldSettings = WorldContext->GetWorldSettings();
 	if (!WorldSettings)
 	{
 		UE_LOG(LogZynapsCameraManager, Error, TEXT("Failed to retrieve the Zynaps stage world settings"));
@@ -43,6 +55,13 @@ void AZynapsCameraManager::UpdateCamera(float DeltaSeconds)
 	}
 	float CameraSpeed = WorldSettings->ScrollSpeed;
 	GetViewTarget()->AddActorWorldOffset(FVector(0.0f, CameraSpeed * DeltaSeconds, 0.0f));
+
+	// Keep the checkpoint reached by the camera up to date
+	AStageGameMode* StageGameMode = WorldContext->GetStageGameMode();
+	if (StageGameMode && StageGameMode->GetCheckpointIndex())
+	{
+		StageGameMode->GetCheckpointIndex()->Advance(GetCameraLocation().Y);
+	}
 }
 
 // Sets the camera location
@@ -67,8 +86,15 @@ void AZynapsCameraManager::SetCameraLocationWithOffset(FVector Location)
 	GetViewTarget()->SetActorLocation(Location + ZynapsWorldSettings->FixedCameraOffset);
 }
 
+// Returns the cache of the viewport bounds for this camera
+FViewportBoundsCache& AZynapsCameraManager::GetViewportBoundsCache()
+{
+	return ViewportBoundsCache;
+}
+
 // Returns the game state
 AZynapsGameState* AZynapsCameraManager::GetZynapsGameState() const
 {
-	return GetWorld()->GetGameState<AZynapsGameState>();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetGameState() : nullptr;
 }
@@ -3,6 +3,9 @@
 #include "ZynapsReloaded.h"
 #include "ZynapsController.h"
 #include "ZynapsCameraManager.h"
+#include "ZynapsWorldContext.h"
+#include "PerformanceUtil.h"
+#include "Debug/DebugDrawService.h"
 
 // Log category
 DEFINE_LOG_CATEGORY(LogZynapsController);
@@ -16,14 +19,56 @@ AZynapsController::AZynapsController(const FObjectInitializer& ObjectInitializer
 	// Set the player camera manager
 	PlayerCameraManagerClass = AZynapsCameraManager::StaticClass();
 
-	// Reset the time in which the fire button was pressed
-	FirePressedTime = -1.0;
+	// Input events are placed at the end of the frame unless they are injected with a sub-frame time
+	InputSubFrameAlpha = 1.0f;
+
+	// Init input vars
+	CurrentInputMask = 0;
+	InputRecordingMode = EInputRecordingMode::None;
+	ReplayTick = 0;
+	ReplayCursor = 0;
+	bTimeStepLocked = false;
+	bSavedUseFixedTimeStep = false;
+	SavedFixedDeltaTime = 0.0;
 }
 
 // Called when the game starts
 void AZynapsController::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Draw the performance overlay on top of the HUD. It is only visible when Zynaps.PerfOverlay is set.
+	if (IsLocalController())
+	{
+		PerformanceOverlayHandle = UDebugDrawService::Register(TEXT("Game"),
+			FDebugDrawDelegate::CreateStatic(&UPerformanceUtil::DrawPerformanceOverlay));
+	}
+
+	// Record or replay the session if the command line asks for it
+	FString InputRecordingName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ZynapsReplay="), InputRecordingName))
+	{
+		ZynapsReplayInput(InputRecordingName);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("ZynapsRecord="), InputRecordingName))
+	{
+		ZynapsRecordInput(InputRecordingName);
+	}
+}
+
+// Called when the controller is removed from the level
+void AZynapsController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Save the recording in progress
+	ZynapsStopInput();
+
+	if (PerformanceOverlayHandle.IsValid())
+	{
+		UDebugDrawService::Unregister(PerformanceOverlayHandle);
+		PerformanceOverlayHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -53,10 +98,11 @@ void AZynapsController::Tick(float DeltaSeconds)
 		return;
 	}
 
-	// Set the power-up activation mode on if necessary
-	if (FirePressedTime > 0)
+	// Set the power-up activation mode on if necessary. The holding time is measured in game time, so it
+	// follows pause, time dilation and replay speed.
+	if (InputTiming.IsHeld(ZynapsInput_Fire))
 	{
-		double FireHoldingTime = FPlatformTime::Seconds() - FirePressedTime;
+		double FireHoldingTime = InputTiming.GetHoldDuration(ZynapsInput_Fire, GetWorld()->GetTimeSeconds());
 		if (FireHoldingTime > PowerUpActivationModeTime)
 		{
 			// The power-up activation mode is on
@@ -85,6 +131,170 @@ bool AZynapsController::CanRestartPlayer()
 	return false;
 }
 
+// Feeds a mask of held buttons through the same handlers as the player input
+void AZynapsController::InjectInput(uint8 InputMask, float SubFrameAlpha)
+{
+	InputSubFrameAlpha = FMath::Clamp(SubFrameAlpha, 0.0f, 1.0f);
+
+	if (InputMask & ZynapsInput_Up)
+	{
+		MoveUp(1.0f);
+	}
+	if (InputMask & ZynapsInput_Down)
+	{
+		MoveDown(1.0f);
+	}
+	if (InputMask & ZynapsInput_Left)
+	{
+		MoveLeft(1.0f);
+	}
+	if (InputMask & ZynapsInput_Right)
+	{
+		MoveRight(1.0f);
+	}
+
+	// The fire button only acts on presses and releases
+	uint8 ChangedMask = InputMask ^ CurrentInputMask;
+	if (ChangedMask & ZynapsInput_Fire)
+	{
+		if (InputMask & ZynapsInput_Fire)
+		{
+			FirePressed();
+		}
+		else
+		{
+			FireReleased();
+		}
+	}
+
+	InputSubFrameAlpha = 1.0f;
+}
+
+// Returns the press and release times of the buttons, in game time
+const FInputTiming& AZynapsController::GetInputTiming() const
+{
+	return InputTiming;
+}
+
+// Processes the player input. It also records or replays the input.
+void AZynapsController::PlayerTick(float DeltaTime)
+{
+	// The player input handlers run here
+	Super::PlayerTick(DeltaTime);
+
+	if (InputRecordingMode == EInputRecordingMode::Replaying)
+	{
+		if (ReplayTick < InputRecording.GetNumTicks())
+		{
+			InjectInput(InputRecording.GetInputMask(ReplayTick++, ReplayCursor));
+		}
+		else
+		{
+			UE_LOG(LogZynapsController, Log, TEXT("Input replay finished after %u ticks"), ReplayTick);
+			ZynapsStopInput();
+		}
+	}
+	else if (InputRecordingMode == EInputRecordingMode::Recording)
+	{
+		InputRecording.AddTick(CurrentInputMask);
+	}
+
+	// Axes are reported on every tick, while the fire button keeps its state until it is released
+	CurrentInputMask &= ZynapsInput_Fire;
+}
+
+// Starts recording the input of each tick
+void AZynapsController::ZynapsRecordInput(const FString& Name)
+{
+	ZynapsStopInput();
+
+	// Use a new seed for the random streams, so the replay can reproduce them
+	const int32 Seed = FMath::Rand();
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	// A variable time step can't be reproduced, so force a fixed one if the engine isn't using it
+	float TickRate = DefaultRecordingTickRate;
+	if (FApp::UseFixedTimeStep() && FApp::GetFixedDeltaTime() > 0.0)
+	{
+		TickRate = (float)(1.0 / FApp::GetFixedDeltaTime());
+	}
+	else
+	{
+		UE_LOG(LogZynapsController, Warning, TEXT("No fixed time step. Recording at %.0f ticks per second"),
+			TickRate);
+	}
+	LockTimeStep(TickRate);
+	InputRecording.Reset(UGameplayStatics::GetCurrentLevelName(this), Seed, TickRate);
+	InputRecordingFileName = FInputRecording::GetRecordingPath(Name);
+	InputRecordingMode = EInputRecordingMode::Recording;
+	UE_LOG(LogZynapsController, Log, TEXT("Recording the input to %s"), *InputRecordingFileName);
+}
+
+// Replays a recording through the same handlers as the player input
+void AZynapsController::ZynapsReplayInput(const FString& Name)
+{
+	ZynapsStopInput();
+
+	const FString FileName = FInputRecording::GetRecordingPath(Name);
+	if (!InputRecording.LoadFromFile(FileName))
+	{
+		UE_LOG(LogZynapsController, Error, TEXT("Failed to load the input recording %s"), *FileName);
+		return;
+	}
+	if (InputRecording.GetStageName() != UGameplayStatics::GetCurrentLevelName(this))
+	{
+		UE_LOG(LogZynapsController, Warning, TEXT("The input recording %s was made in the stage %s"),
+			*FileName, *InputRecording.GetStageName());
+	}
+
+	// Restore the conditions of the recording
+	FMath::RandInit(InputRecording.GetSeed());
+	FMath::SRandInit(InputRecording.GetSeed());
+	if (InputRecording.GetTickRate() > 0.0f)
+	{
+		LockTimeStep(InputRecording.GetTickRate());
+	}
+	else
+	{
+		UE_LOG(LogZynapsController, Warning, TEXT("The input recording %s has no fixed time step. "
+			"The replay may diverge"), *FileName);
+	}
+
+	// Ignore the player input during the replay
+	DisableInput(this);
+	ReplayTick = 0;
+	ReplayCursor = 0;
+	InputRecordingMode = EInputRecordingMode::Replaying;
+	UE_LOG(LogZynapsController, Log, TEXT("Replaying %u ticks from %s"), InputRecording.GetNumTicks(), *FileName);
+}
+
+// Stops recording or replaying the input
+void AZynapsController::ZynapsStopInput()
+{
+	if (InputRecordingMode == EInputRecordingMode::Recording)
+	{
+		if (InputRecording.SaveToFile(InputRecordingFileName))
+		{
+			UE_LOG(LogZynapsController, Log, TEXT("Saved %u ticks with %d input changes to %s"),
+				InputRecording.GetNumTicks(), InputRecording.GetNumEvents(), *InputRecordingFileName);
+		}
+		else
+		{
+			UE_LOG(LogZynapsController, Error, TEXT("Failed to save the input recording %s"),
+				*InputRecordingFileName);
+		}
+	}
+	else if (InputRecordingMode == EInputRecordingMode::Replaying)
+	{
+		// Release the buttons held by the replay and give the control back to the player
+		InjectInput(0);
+		EnableInput(this);
+	}
+	RestoreTimeStep();
+	InputRecordingMode = EInputRecordingMode::None;
+}
+
 // Called to bind functionality to input
 void AZynapsController::SetupInputComponent()
 {
@@ -103,6 +313,12 @@ void AZynapsController::SetupInputComponent()
 // Handles moving up
 void AZynapsController::MoveUp(float Val)
 {
+	// Keep the raw input for the recording
+	if (Val != 0.0f)
+	{
+		CurrentInputMask |= ZynapsInput_Up;
+	}
+
 	// Get the game state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -128,6 +344,12 @@ void AZynapsController::MoveUp(float Val)
 // Handles moving down
 void AZynapsController::MoveDown(float Val)
 {
+	// Keep the raw input for the recording
+	if (Val != 0.0f)
+	{
+		CurrentInputMask |= ZynapsInput_Down;
+	}
+
 	// Get the game state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -153,6 +375,12 @@ void AZynapsController::MoveDown(float Val)
 // Handles moving left
 void AZynapsController::MoveLeft(float Val)
 {
+	// Keep the raw input for the recording
+	if (Val != 0.0f)
+	{
+		CurrentInputMask |= ZynapsInput_Left;
+	}
+
 	// Get the game state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -178,6 +406,12 @@ void AZynapsController::MoveLeft(float Val)
 // Handles moving right
 void AZynapsController::MoveRight(float Val)
 {
+	// Keep the raw input for the recording
+	if (Val != 0.0f)
+	{
+		CurrentInputMask |= ZynapsInput_Right;
+	}
+
 	// Get the game state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -203,6 +437,9 @@ void AZynapsController::MoveRight(float Val)
 // Handles fire button pressed
 void AZynapsController::FirePressed()
 {
+	// Keep the raw input for the recording
+	CurrentInputMask |= ZynapsInput_Fire;
+
 	// Get the game state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -218,19 +455,29 @@ void AZynapsController::FirePressed()
 	}
 
 	// Take the time in which the button was pressed
-	FirePressedTime = FPlatformTime::Seconds();
+	InputTiming.Press(ZynapsInput_Fire, GetInputTime());
 
 	// Ask the pawn to fire
 	APlayerPawn* PlayerPawn = GetPlayerPawn();
 	if (PlayerPawn)
 	{
-		PlayerPawn->Fire();
+		PlayerPawn->StartFire(GetWorld()->GetTimeSeconds() - GetInputTime());
 	}
 }
 
 // Handles fire button released
 void AZynapsController::FireReleased()
 {
+	// Keep the raw input for the recording
+	CurrentInputMask &= ~ZynapsInput_Fire;
+
+	// Stop the automatic fire
+	APlayerPawn* PlayerPawn = GetPlayerPawn();
+	if (PlayerPawn)
+	{
+		PlayerPawn->StopFire();
+	}
+
 	// Get the game state
 	AZynapsGameState* ZynapsGameState = GetZynapsGameState();
 	if (!ZynapsGameState)
@@ -245,8 +492,8 @@ void AZynapsController::FireReleased()
 		return;
 	}
 
-	// Reset the time in which the fire button was pressed and set the power-up activation mode off
-	FirePressedTime = -1.0;
+	// Take the time in which the button was released and set the power-up activation mode off
+	InputTiming.Release(ZynapsInput_Fire, GetInputTime());
 	AZynapsPlayerState* ZynapsPlayerState = GetZynapsPlayerState();
 	if (!ZynapsPlayerState)
 	{
@@ -266,6 +513,39 @@ void AZynapsController::BackPressed()
 	UGameplayStatics::OpenLevel(GetWorld(), TEXT("World'/Game/Levels/Menu.Menu'"));
 }
 
+// Returns the game time of the input being handled
+double AZynapsController::GetInputTime() const
+{
+	// The input handled in this frame happened during the time elapsed since the previous one
+	const UWorld* World = GetWorld();
+	return World->GetTimeSeconds() - (1.0f - InputSubFrameAlpha) * World->GetDeltaSeconds();
+}
+
+// Uses a fixed time step of the given tick rate, saving the previous time step settings to restore them later
+void AZynapsController::LockTimeStep(float TickRate)
+{
+	// Keep the settings of the player, not those of a previous lock
+	if (!bTimeStepLocked)
+	{
+		bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+		SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+		bTimeStepLocked = true;
+	}
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / TickRate);
+}
+
+// Restores the time step settings saved when the time step was locked
+void AZynapsController::RestoreTimeStep()
+{
+	if (bTimeStepLocked)
+	{
+		FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		bTimeStepLocked = false;
+	}
+}
+
 // Returns the player's pawn
 APlayerPawn* AZynapsController::GetPlayerPawn() const
 {
@@ -275,7 +555,8 @@ APlayerPawn* AZynapsController::GetPlayerPawn() const
 // Returns the game state
 AZynapsGameState* AZynapsController::GetZynapsGameState() const
 {
-	return GetWorld()->GetGameState<AZynapsGameState>();
+	UZynapsWorldContext* WorldContext = UZynapsWorldContext::Get(GetWorld());
+	return WorldContext ? WorldContext->GetGameState() : nullptr;
 }
 
 // Returns the player state
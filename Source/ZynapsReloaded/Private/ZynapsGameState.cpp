@@ -25,6 +25,7 @@ void AZynapsGameState::SetCurrentState(EStageState State)
 	// Change to the new state only if it is different from the current one
 	if (CurrentState != State)
 	{
+		EStageState PreviousState = CurrentState;
 		CurrentState = State;
 
 		// Handle the new state
@@ -44,5 +45,8 @@ void AZynapsGameState::SetCurrentState(EStageState State)
 			UE_LOG(LogZynapsGameState, Warning, TEXT("Tried to set and invalid game state"));
 			break;
 		}
+
+		// Notify the transition
+		OnStageStateChanged.Broadcast(PreviousState, CurrentState);
 	}
 }
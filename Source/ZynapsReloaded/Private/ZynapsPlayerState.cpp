@@ -35,6 +35,7 @@ void AZynapsPlayerState::SetCurrentState(EPlayerState State)
 	if (CurrentState != State)
 	{
 		// Handle the new state
+		EPlayerState PreviousState = CurrentState;
 		switch (State)
 		{
 		case EPlayerState::Playing:
@@ -50,8 +51,11 @@ void AZynapsPlayerState::SetCurrentState(EPlayerState State)
 			// Do nothing here
 			UE_LOG(LogZynapsPlayerState, Warning, 
 				TEXT("Tried to set and invalid player state. The state will not be changed"));
-			break;
+			return;
 		}
+
+		// Notify the transition
+		OnPlayerStateChanged.Broadcast(PreviousState, CurrentState);
 	}
 }
 
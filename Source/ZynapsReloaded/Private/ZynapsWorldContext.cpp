@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#include "ZynapsReloaded.h"
+#include "ZynapsWorldContext.h"
+#include "ZynapsWorldSettings.h"
+#include "ZynapsGameState.h"
+#include "ZynapsController.h"
+#include "ZynapsPlayerState.h"
+#include "ZynapsCameraManager.h"
+#include "StageGameMode.h"
+#include "PlayerPawn.h"
+
+// Returns the context of the specified world or nullptr if the world doesn't use the Zynaps world settings
+UZynapsWorldContext* UZynapsWorldContext::Get(UWorld* World)
+{
+	AZynapsWorldSettings* WorldSettings = AZynapsWorldSettings::GetZynapsWorldSettings(World);
+	if (!WorldSettings)
+	{
+		return nullptr;
+	}
+	return WorldSettings->GetWorldContext();
+}
+
+// Returns the world settings
+AZynapsWorldSettings* UZynapsWorldContext::GetWorldSettings()
+{
+	// The context is owned by the world settings
+	return Cast<AZynapsWorldSettings>(GetOuter());
+}
+
+// Returns the game state
+AZynapsGameState* UZynapsWorldContext::GetGameState()
+{
+	if (!GameState.IsValid())
+	{
+		UWorld* World = GetWorld();
+		GameState = World ? World->GetGameState<AZynapsGameState>() : nullptr;
+	}
+	return GameState.Get();
+}
+
+// Returns the stage game mode. It is only available on the server.
+AStageGameMode* UZynapsWorldContext::GetStageGameMode()
+{
+	if (!StageGameMode.IsValid())
+	{
+		UWorld* World = GetWorld();
+		StageGameMode = World ? World->GetAuthGameMode<AStageGameMode>() : nullptr;
+	}
+	return StageGameMode.Get();
+}
+
+// Returns the player controller
+AZynapsController* UZynapsWorldContext::GetController()
+{
+	if (!Controller.IsValid())
+	{
+		UWorld* World = GetWorld();
+		Controller = World ? Cast<AZynapsController>(World->GetFirstPlayerController()) : nullptr;
+	}
+	return Controller.Get();
+}
+
+// Returns the player state
+AZynapsPlayerState* UZynapsWorldContext::GetPlayerState()
+{
+	// The player state is resolved again if the controller or its player state changed
+	AZynapsController* CurrentController = GetController();
+	if (!CurrentController)
+	{
+		return nullptr;
+	}
+	if (CurrentController->PlayerState != PlayerState.Get())
+	{
+		PlayerState = Cast<AZynapsPlayerState>(CurrentController->PlayerState);
+	}
+	return PlayerState.Get();
+}
+
+// Returns the camera manager
+AZynapsCameraManager* UZynapsWorldContext::GetCameraManager()
+{
+	// The camera manager is resolved again if the controller or its camera manager changed
+	AZynapsController* CurrentController = GetController();
+	if (!CurrentController)
+	{
+		return nullptr;
+	}
+	if (CurrentController->PlayerCameraManager != CameraManager.Get())
+	{
+		CameraManager = Cast<AZynapsCameraManager>(CurrentController->PlayerCameraManager);
+	}
+	return CameraManager.Get();
+}
+
+// Returns the player's pawn
+APlayerPawn* UZynapsWorldContext::GetPlayerPawn()
+{
+	// The pawn is resolved again when the player is respawned. A pawn being destroyed is never returned.
+	AZynapsController* CurrentController = GetController();
+	APawn* CurrentPawn = CurrentController ? CurrentController->GetPawn() : nullptr;
+	if (!IsValid(CurrentPawn))
+	{
+		PlayerPawn.Reset();
+		return nullptr;
+	}
+	if (CurrentPawn != PlayerPawn.Get())
+	{
+		PlayerPawn = Cast<APlayerPawn>(CurrentPawn);
+	}
+	return PlayerPawn.Get();
+}
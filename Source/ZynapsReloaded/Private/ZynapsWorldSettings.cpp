@@ -11,13 +11,55 @@ AZynapsWorldSettings::AZynapsWorldSettings() : Super()
 
 	// Default fixed camera offset
 	FixedCameraOffset = FVector(0.0f, 2500.0f, 0.0f);
+
+	// No assets to preload by default
+	AssetManifest = nullptr;
+
+	// Default streaming distances
+	StreamingLeadTime = 3.0f;
+	StreamingUnloadMargin = 1000.0f;
+
+	// Default resolution of the scenery distance field
+	DistanceFieldCellSize = DefaultDistanceFieldCellSize;
+
+	// No terrain map by default
+	TerrainMap = nullptr;
+	TerrainMapCellSize = DefaultTerrainMapCellSize;
+
+	// The world context is created on demand
+	WorldContext = nullptr;
 }
 
 // Returns the world settings for the specified world
 AZynapsWorldSettings* AZynapsWorldSettings::GetZynapsWorldSettings(UWorld* World)
 {
-	TActorIterator<AZynapsWorldSettings> It(World);
-	if (It) return *It;
-	return nullptr;
+	if (!World) return nullptr;
+	return Cast<AZynapsWorldSettings>(World->GetWorldSettings(false, false));
 }
 
+// Returns the cache of the game framework objects of this world
+UZynapsWorldContext* AZynapsWorldSettings::GetWorldContext()
+{
+	if (!WorldContext)
+	{
+		WorldContext = NewObject<UZynapsWorldContext>(this, NAME_None, RF_Transient);
+	}
+	return WorldContext;
+}
+
+#if WITH_EDITOR
+// Bakes the scenery of the stage into the terrain map
+void AZynapsWorldSettings::BakeTerrainMap()
+{
+	if (!TerrainMap)
+	{
+		UE_LOG(LogStageTerrainMap, Error, TEXT("No terrain map asset set to bake the stage into"));
+		return;
+	}
+
+	if (TerrainMap->Bake(GetWorld(), TerrainMapCellSize))
+	{
+		TerrainMap->MarkPackageDirty();
+	}
+}
+#endif
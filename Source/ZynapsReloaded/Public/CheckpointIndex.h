@@ -0,0 +1,69 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "UObject/NoExportTypes.h"
+#include "CheckpointIndex.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogCheckpointIndex, Log, All);
+
+// Delegate called when the camera crosses a checkpoint
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCheckpointCrossed, APlayerStart*, Checkpoint);
+
+/**
+ * Index of the player starts of a stage sorted by their Y coordinate. It tracks the checkpoint reached by the
+ * camera incrementally as it scrolls, so the current checkpoint is known without scanning all of them.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API UCheckpointIndex : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Default constructor
+	UCheckpointIndex();
+
+	// Builds the index from the given player starts. The initial checkpoint is returned while the camera has not
+	// passed any player start.
+	void Init(const TArray<APlayerStart*>& PlayerStarts, APlayerStart* InitialCheckpoint);
+
+	// Moves the cursor to the last checkpoint passed by the camera at the given Y coordinate. Moving forward
+	// advances the cursor one checkpoint at a time notifying each one crossed. Moving backwards (i.e. on respawn)
+	// relocates the cursor with a binary search without notifications.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	APlayerStart* Advance(float CameraY);
+
+	// Relocates the cursor with a binary search without notifying the checkpoints crossed
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	APlayerStart* Seek(float CameraY);
+
+	// Returns the checkpoint where the player should be respawned
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	APlayerStart* GetCurrentCheckpoint() const;
+
+	// Returns the number of checkpoints in the index
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 GetNumCheckpoints() const;
+
+	// Called when the camera crosses a checkpoint
+	UPROPERTY(BlueprintAssignable, Category = ZynapsEvents)
+	FOnCheckpointCrossed OnCheckpointCrossed;
+
+private:
+
+	// Player starts sorted by their Y coordinate
+	UPROPERTY()  // Needed to ensure garbage collection
+	TArray<APlayerStart*> Checkpoints;
+
+	// Y coordinates of the checkpoints, kept apart to make the searches cache friendly
+	TArray<float> CheckpointLocations;
+
+	// Checkpoint returned before passing any player start
+	UPROPERTY()  // Needed to ensure garbage collection
+	APlayerStart* InitialCheckpoint;
+
+	// Index of the last checkpoint passed by the camera or INDEX_NONE if none was passed
+	int32 Cursor;
+};
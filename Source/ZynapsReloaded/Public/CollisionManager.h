@@ -0,0 +1,191 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "SpatialHashGrid.h"
+#include "CollisionManager.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogCollisionManager, Log, All);
+
+// Delegate called when a registered body begins overlapping with another one
+DECLARE_DELEGATE_TwoParams(FOnBodyOverlap, AActor* /* OtherActor */, UPrimitiveComponent* /* OtherComp */);
+
+/**
+ * Collision layers of the bodies registered in the collision manager. Only some pairs of layers are tested.
+ */
+UENUM(BlueprintType)
+enum class ECollisionLayer2D : uint8
+{
+	Player,
+	PlayerProjectile,
+	Pickup,
+	Enemy,
+	EnemyProjectile
+};
+
+/**
+ * Struct which stores a body registered in the collision manager.
+ */
+struct FCollisionBody2D
+{
+	// The registered actor
+	TWeakObjectPtr<AActor> Actor;
+
+	// Raw pointer used as the lookup key. It is never dereferenced.
+	AActor* Key;
+
+	// Component which gives the shape of the body
+	TWeakObjectPtr<UPrimitiveComponent> Shape;
+
+	// Collision layer
+	ECollisionLayer2D Layer;
+
+	// Delegate called when the body begins overlapping with another body
+	FOnBodyOverlap OnOverlap;
+
+	// Start of the capsule segment in the gameplay plane. Updated on each pass.
+	FVector2D SegmentStart;
+
+	// End of the capsule segment in the gameplay plane. It is the same as the start for circles.
+	FVector2D SegmentEnd;
+
+	// Radius of the capsule or circle
+	float Radius;
+
+	// Flag which indicates that the body takes part in the current pass
+	bool bActive;
+};
+
+/**
+ * Struct which stores a pair of bodies found overlapping in a pass, kept until the callbacks are executed.
+ */
+struct FCollisionPair2D
+{
+	// First body of the pair
+	FCollisionBody2D First;
+
+	// Second body of the pair
+	FCollisionBody2D Second;
+};
+
+/**
+ * Struct which stores a registered body found by a query of the collision manager.
+ */
+struct FCollisionOverlap2D
+{
+	// The registered actor
+	AActor* Actor;
+
+	// Component which gives the shape of the body
+	UPrimitiveComponent* Shape;
+
+	// Collision layer of the body
+	ECollisionLayer2D Layer;
+};
+
+/**
+ * Actor which detects the overlaps between the registered bodies once per frame, so the transient actors don't
+ * need the physics engine to generate overlap events. The bodies are capsules or circles in the YZ plane. They
+ * are inserted into a spatial hash grid, and the pairs of layers that can interact are tested against each
+ * other in a single pass. Each body is notified once when it begins overlapping with another body.
+ *
+ * If the stage has a baked terrain map, the bodies of the layers which collide with the scenery are also tested
+ * against it in the same pass. Their overlap with the scenery is notified as an overlap with the world settings
+ * of the stage, with no component.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API ACollisionManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	ACollisionManager();
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the collision manager of the specified world or nullptr if the game mode doesn't provide one
+	static ACollisionManager* GetCollisionManager(UWorld* World);
+
+	// Registers an actor using the given component as its shape. Capsules and spheres keep their shape, other
+	// components use their bounding sphere. The actor stays registered until it is unregistered or destroyed.
+	// Bodies with collision disabled are skipped.
+	void Register(AActor* Actor, UPrimitiveComponent* Shape, ECollisionLayer2D Layer, FOnBodyOverlap OnOverlap);
+
+	// Unregisters an actor
+	void Unregister(AActor* Actor);
+
+	// Appends to the output array the bodies which overlap a circle and can collide with the given layer. It is
+	// meant for the objects which are not actors, like the enemies of the swarm, and uses the shapes of the last
+	// pass, so it must be called after the manager has ticked.
+	void OverlapCircle(const FVector2D& Center, float Radius, ECollisionLayer2D Layer,
+		TArray<FCollisionOverlap2D>& OutOverlaps);
+
+	// Notifies a registered actor that it began overlapping with an object found by a query
+	void NotifyOverlap(AActor* Actor, AActor* OtherActor, UPrimitiveComponent* OtherComp);
+
+	// Returns the number of registered bodies
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 GetNumRegistered() const;
+
+	// Returns whether bodies of the given layers are tested against each other
+	static bool CanCollide(ECollisionLayer2D LayerA, ECollisionLayer2D LayerB);
+
+	// Returns whether bodies of the given layer are tested against the terrain map of the stage
+	static bool CollidesWithTerrain(ECollisionLayer2D Layer);
+
+	// Size of the cells of the broadphase grid. It should be around the size of the largest common body.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Collision)
+	float CellSize;
+
+private:
+
+	// Updates the shape of a body in the gameplay plane. Returns false if the body can't collide.
+	static bool UpdateBodyShape(FCollisionBody2D& Body);
+
+	// Checks whether two bodies overlap
+	static bool AreOverlapping(const FCollisionBody2D& BodyA, const FCollisionBody2D& BodyB);
+
+	// Tests the active bodies against the terrain map of the stage and notifies the new overlaps
+	void CollideTerrain();
+
+	// Removes the entry at the given index keeping the index lookup consistent
+	void RemoveAt(int32 Index);
+
+	// Registered bodies
+	TArray<FCollisionBody2D> Bodies;
+
+	// Index of each registered actor in Bodies
+	TMap<AActor*, int32> BodyIndices;
+
+	// Broadphase grid, rebuilt on each pass
+	FSpatialHashGrid Grid;
+
+	// Pairs of actors overlapping in the previous pass, used to notify only new overlaps
+	TSet<TPair<AActor*, AActor*>> OverlappingPairs;
+
+	// Pairs of actors overlapping in the current pass. Kept as a member to avoid allocations on each tick.
+	TSet<TPair<AActor*, AActor*>> CurrentPairs;
+
+	// Overlaps to notify in the current pass
+	TArray<FCollisionPair2D> NewPairs;
+
+	// Actors overlapping the terrain map in the previous pass, used to notify only new overlaps
+	TSet<AActor*> TerrainContacts;
+
+	// Actors overlapping the terrain map in the current pass. Kept as a member to avoid allocations on each tick.
+	TSet<AActor*> CurrentTerrainContacts;
+
+	// Bodies which began overlapping the terrain map in the current pass
+	TArray<FCollisionBody2D> NewTerrainContacts;
+
+	// Candidates returned by the grid. Kept as a member to avoid allocations on each tick.
+	TArray<int32> Candidates;
+
+	// Candidates returned by the grid to the queries. Kept as a member to avoid allocations on each query.
+	TArray<int32> QueryCandidates;
+};
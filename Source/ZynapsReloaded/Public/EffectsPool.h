@@ -0,0 +1,129 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "EffectsPool.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogEffectsPool, Log, All);
+
+// Number of components pre-warmed for a particle system when no capacity is specified
+const int32 DefaultEffectsPoolCapacity = 4;
+
+// Maximum number of components of a particle system when no budget is specified
+const int32 DefaultEffectsPoolBudget = 8;
+
+/**
+ * Struct which stores the usage counters of the pool for a particle system.
+ */
+USTRUCT(BlueprintType)
+struct FEffectsPoolStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of components the pool was pre-warmed with
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Capacity;
+
+	// Maximum number of components the pool can hold
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Budget;
+
+	// Number of components playing an effect
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 InUse;
+
+	// Maximum number of components playing an effect at the same time
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 HighWaterMark;
+
+	// Number of requests served with an already created component
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Hits;
+
+	// Number of requests which needed to create a new component because the pool was empty
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Misses;
+
+	// Number of requests which restarted the oldest effect because the budget was exhausted
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Steals;
+
+	// Default constructor
+	FEffectsPoolStats()
+	{
+		Capacity = Budget = InUse = HighWaterMark = Hits = Misses = Steals = 0;
+	}
+};
+
+/**
+ * Struct which stores the components of a particle system.
+ */
+USTRUCT()
+struct FEffectsPoolEntry
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Components ready to play an effect
+	UPROPERTY()  // Needed to ensure garbage collection
+	TArray<UParticleSystemComponent*> FreeComponents;
+
+	// Components playing an effect, the oldest first
+	UPROPERTY()  // Needed to ensure garbage collection
+	TArray<UParticleSystemComponent*> ActiveComponents;
+
+	// Usage counters
+	UPROPERTY()
+	FEffectsPoolStats Stats;
+};
+
+/**
+ * Actor which keeps particle system components ready to be reused, so the one-shot effects like explosions don't
+ * need to create and destroy a component each time. Each particle system has a budget of components: once it is
+ * exhausted the oldest effect is restarted at the new location.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AEffectsPool : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AEffectsPool();
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Returns the effects pool of the specified world or nullptr if the game mode doesn't provide one
+	static AEffectsPool* GetEffectsPool(UWorld* World);
+
+	// Creates components for the given particle system until the pool holds at least the specified capacity, and
+	// sets the maximum number of components it can hold. The defaults match DefaultEffectsPoolCapacity and
+	// DefaultEffectsPoolBudget, the header tool only accepts literal defaults.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void Prewarm(UParticleSystem* Template, int32 Capacity = 4, int32 Budget = 8);
+
+	// Plays the given particle system at the given transform using a pooled component
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	UParticleSystemComponent* SpawnEffect(UParticleSystem* Template, const FTransform& Transform);
+
+	// Returns the usage counters for the given particle system
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FEffectsPoolStats GetStats(UParticleSystem* Template) const;
+
+private:
+
+	// Creates a new component owned by the pool. It is returned inactive.
+	UParticleSystemComponent* CreateComponent(UParticleSystem* Template);
+
+	// Called when a pooled component finishes its effect
+	UFUNCTION()
+	void EffectFinished(UParticleSystemComponent* Component);
+
+	// Pooled components by particle system
+	UPROPERTY()  // Needed to ensure garbage collection
+	TMap<UParticleSystem*, FEffectsPoolEntry> Entries;
+};
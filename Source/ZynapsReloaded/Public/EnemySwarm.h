@@ -0,0 +1,342 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "InstancedBatchSystem.h"
+#include "SpatialHashGrid.h"
+#include "CollisionManager.h"
+#include "EnemySwarm.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogEnemySwarm, Log, All);
+
+// Default number of enemies the swarm allocates room for
+const int32 DefaultEnemySwarmCapacity = 256;
+
+/**
+ * Movement patterns of the enemies of the swarm.
+ */
+UENUM(BlueprintType)
+enum class EEnemyPattern : uint8
+{
+	// Flies in a straight line
+	Straight,
+	// Oscillates vertically around the height where it was spawned
+	SineWave,
+	// Moves vertically towards the player at a limited speed
+	Chase
+};
+
+/**
+ * Struct which describes a wave of enemies entering the screen from its right edge.
+ */
+USTRUCT(BlueprintType)
+struct FEnemyWave
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Y coordinate which the right edge of the viewport must reach for the wave to be spawned
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	float TriggerY;
+
+	// Number of enemies of the wave
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "1"))
+	int32 Count;
+
+	// Horizontal distance between consecutive enemies of the wave
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "0.0"))
+	float Spacing;
+
+	// Z coordinate at which the enemies are spawned
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	float SpawnZ;
+
+	// Velocity of the enemies relative to the screen. The enemies are also carried along by the scroll.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	FVector2D Velocity;
+
+	// Movement pattern of the enemies
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	EEnemyPattern Pattern;
+
+	// Vertical amplitude of the sine wave, or vertical speed of the chase
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "0.0"))
+	float Amplitude;
+
+	// Oscillations per second of the sine wave
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "0.0"))
+	float Frequency;
+
+	// Default constructor
+	FEnemyWave()
+	{
+		TriggerY = 0.0f;
+		Count = 1;
+		Spacing = 200.0f;
+		SpawnZ = 0.0f;
+		Velocity = FVector2D(-400.0f, 0.0f);
+		Pattern = EEnemyPattern::Straight;
+		Amplitude = 200.0f;
+		Frequency = 0.5f;
+	}
+};
+
+/**
+ * Struct which stores the activity of the enemy swarm during the stage.
+ */
+USTRUCT(BlueprintType)
+struct FEnemySwarmStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of live enemies
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 LiveEnemies;
+
+	// Maximum number of live enemies at the same time
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 HighWaterMark;
+
+	// Number of enemies spawned
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Spawned;
+
+	// Number of enemies destroyed by the player
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Destroyed;
+
+	// Number of enemies which left the screen
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Escaped;
+
+	// Default constructor
+	FEnemySwarmStats()
+	{
+		LiveEnemies = HighWaterMark = Spawned = Destroyed = Escaped = 0;
+	}
+};
+
+/**
+ * Actor which simulates all the enemies of the stage as a single data-oriented system. The enemies are not actors:
+ * their state is kept in parallel arrays updated in tight loops, and they are drawn as the instances of a single
+ * instanced static mesh component, so hundreds of them cost one draw call and no actor ticks.
+ *
+ * The waves are set in the world settings. The enemies collide with the player and the player projectiles through
+ * the queries of the collision manager, and they are inserted into a spatial hash grid on each frame, so other
+ * systems can find them. An enemy is identified by its index, which is only valid during the current frame.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AEnemySwarm : public AInstancedBatchSystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AEnemySwarm();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the enemy swarm of the specified world or nullptr if the game mode doesn't provide one
+	static AEnemySwarm* GetEnemySwarm(UWorld* World);
+
+	// Returns the soft references to the assets of the swarm
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& Assets) const override;
+
+	// Removes all the enemies and rewinds the waves to the current camera location
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void ClearEnemies();
+
+	// Returns the number of enemies, including the ones destroyed during the current frame
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 GetNumEnemies() const;
+
+	// Returns the activity of the swarm during the stage
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FEnemySwarmStats GetStats() const;
+
+	// Appends to the output array the live enemies which overlap a circle
+	void QueryEnemies(const FVector2D& Center, float Radius, TArray<int32>& OutEnemies) const;
+
+	// Appends to the output array the live enemies which overlap a box
+	void QueryEnemies(const FBox2D& Bounds, TArray<int32>& OutEnemies) const;
+
+	// Finds the nearest live enemy to each location within the given distance, writing its index or INDEX_NONE
+	// to the output array. The whole batch is served by the grid of the current frame.
+	void FindNearestEnemies(const TArray<FVector2D>& Locations, float MaxDistance, TArray<int32>& OutEnemies) const;
+
+	// Finds the first live enemy touched by each segment swept with the given radius, writing its index or
+	// INDEX_NONE and the fraction of the segment at which it is touched to the output arrays. The whole batch is
+	// served by the grid of the current frame.
+	void SweepEnemies(const TArray<FVector2D>& Starts, const TArray<FVector2D>& Ends, float Radius,
+		TArray<int32>& OutEnemies, TArray<float>& OutFractions) const;
+
+	// Returns the location of an enemy in the gameplay plane
+	FVector2D GetEnemyLocation(int32 Enemy) const;
+
+	// Returns the identifier of an enemy. Unlike its index, it stays the same while the enemy lives.
+	uint32 GetEnemyId(int32 Enemy) const;
+
+	// Returns the index of the enemy with the given identifier or INDEX_NONE if it is not alive
+	int32 FindEnemy(uint32 EnemyId) const;
+
+	// Returns whether an enemy is still alive
+	bool IsEnemyAlive(int32 Enemy) const;
+
+	// Damages an enemy, destroying it when it runs out of hit points. Returns whether it was destroyed.
+	bool DamageEnemy(int32 Enemy, int32 Damage);
+
+	// The mesh of the enemies. It is loaded asynchronously and set on the instances component if it has no mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UStaticMesh> EnemyMesh;
+
+	// The particle system of the explosion. It is loaded asynchronously.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UParticleSystem> ExplosionTemplate;
+
+	// Rotation of the enemy meshes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	FRotator EnemyRotation;
+
+	// Scale of the enemy meshes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	FVector EnemyScale;
+
+	// Radius of the enemies in the gameplay plane
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "1.0"))
+	float EnemyRadius;
+
+	// Hit points of each enemy
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "1"))
+	int32 EnemyHitPoints;
+
+	// Points scored when an enemy is destroyed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	int32 EnemyScore;
+
+	// Damage caused by each player projectile
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "1"))
+	int32 ProjectileDamage;
+
+	// Number of enemies the swarm allocates room for. It grows beyond it if needed.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "1"))
+	int32 Capacity;
+
+	// Distance beyond the right edge of the viewport at which the waves are spawned
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "0.0"))
+	float SpawnMargin;
+
+	// Distance beyond the other edges of the viewport at which the enemies are removed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies, meta = (ClampMin = "0.0"))
+	float CullMargin;
+
+	// Number of explosion effects pre-warmed in the effects pool
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	int32 ExplosionPoolCapacity;
+
+	// Maximum number of explosion effects played at the same time
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	int32 ExplosionPoolBudget;
+
+protected:
+
+	// Returns the mesh of the enemies
+	virtual TSoftObjectPtr<UStaticMesh> GetInstanceMesh() const override;
+
+	// Called when the assets of the swarm are loaded
+	virtual void AssetsLoaded() override;
+
+private:
+
+	// Spawns the waves reached by the right edge of the viewport
+	void SpawnWaves(float ViewMaxY);
+
+	// Adds an enemy of a wave
+	void AddEnemy(const FEnemyWave& Wave, float Y);
+
+	// Moves the enemies along their patterns
+	void MoveEnemies(float DeltaSeconds, float ScrollSpeed, float PlayerZ);
+
+	// Checks the overlaps of the enemies with the player and the player projectiles
+	void CollideEnemies();
+
+	// Removes the destroyed enemies and the ones which left the screen
+	void RemoveEnemies(const FBox2D& CullBounds);
+
+	// Removes an enemy, filling the gap with the last one
+	void RemoveAtSwap(int32 Enemy);
+
+	// Updates the instances to match the enemies and rebuilds the grid
+	void UpdateInstances();
+
+	// Waves of the stage sorted by their trigger
+	TArray<FEnemyWave> Waves;
+
+	// Index of the next wave to be spawned
+	int32 NextWave;
+
+	// Identifier of the enemies
+	TArray<uint32> EnemyIds;
+
+	// Index of each enemy by its identifier
+	TMap<uint32, int32> EnemyIndices;
+
+	// Identifier of the next enemy. Zero is never used, so it can mean no enemy.
+	uint32 NextEnemyId;
+
+	// Horizontal location of the enemies
+	TArray<float> PositionsY;
+
+	// Vertical location of the enemies
+	TArray<float> PositionsZ;
+
+	// Horizontal velocity of the enemies relative to the screen
+	TArray<float> VelocitiesY;
+
+	// Vertical velocity of the enemies
+	TArray<float> VelocitiesZ;
+
+	// Hit points left to the enemies. Destroyed enemies have none until they are removed.
+	TArray<int32> HitPoints;
+
+	// Movement pattern of the enemies
+	TArray<EEnemyPattern> PatternIds;
+
+	// Time elapsed since the enemies were spawned
+	TArray<float> Ages;
+
+	// Vertical location around which the enemies move
+	TArray<float> BaseZ;
+
+	// Amplitude of the pattern of the enemies
+	TArray<float> Amplitudes;
+
+	// Angular frequency of the pattern of the enemies
+	TArray<float> AngularFrequencies;
+
+	// Flag which indicates that the waves must be rewound to the camera location on the next tick
+	bool bRewindWaves;
+
+	// Grid of the live enemies, rebuilt on each frame
+	FSpatialHashGrid Grid;
+
+	// Candidates returned by the grid to the nearest enemy and sweep queries. Kept to avoid allocations.
+	mutable TArray<int32> NearestCandidates;
+
+	// Overlaps returned by the collision manager. Kept as a member to avoid allocations on each tick.
+	TArray<FCollisionOverlap2D> Overlaps;
+
+	// The explosion particle system spawned when an enemy is destroyed
+	UPROPERTY()
+	UParticleSystem* ExplosionPartSystem;
+
+	// Activity of the swarm during the stage
+	FEnemySwarmStats Stats;
+};
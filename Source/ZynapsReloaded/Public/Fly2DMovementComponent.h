@@ -15,9 +15,26 @@ const float LimitMarginDown = 50.0f;
 const float LimitMarginLeft = 50.0f;
 const float LimitMarginRight = 50.0f;
 
+// Frame rate at which the movement speeds are defined. Speeds are expressed in units per frame at this rate.
+const float MovementReferenceFrameRate = 60.0f;
+
 // Percentage that the speed and acceleration will be incremented for each speed-up level
 const float SpeedUpLevelIncrement = 0.12f;  // 12%
 
+/**
+ * Struct which stores the range of world locations the flying machine can move within on the gameplay plane.
+ */
+struct FMovementLimits2D
+{
+	// Horizontal range
+	float MinY;
+	float MaxY;
+
+	// Vertical range
+	float MinZ;
+	float MaxZ;
+};
+
 /**
  * Component to manage the movement of a flying machine in a 2.5D game.
  */
@@ -81,13 +98,34 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rotation)
 	float RotationRecoverySpeed;
 
+	// If true, the movement is simulated in fixed steps independent from the frame rate
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Simulation)
+	bool bUseFixedTimestep;
+
+	// Number of simulation steps per second when using a fixed timestep
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Simulation, meta = (ClampMin = "1.0"))
+	float FixedStepRate;
+
+	// Maximum number of simulation steps run in a single frame. The remaining time is dropped after a hitch.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Simulation, meta = (ClampMin = "1"))
+	int32 MaxSubsteps;
+
+	// If true, the rendered location is interpolated between the last two simulated states when using a fixed
+	// timestep
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Simulation)
+	bool bInterpolateMovement;
+
 private:
 
 	// Called from TickComponent() to calculate and apply movement to the updated component based on user input
 	void ApplyActorMovement(float DeltaSeconds);
 
-	// Calculates and applies rotation to the updated component when moving up and down
-	void ApplyActorRotation(USceneComponent* ComponentToUpdate, float RotationToApply, float DeltaSeconds);
+	// Integrates the speed and rotation over the given time and moves the given location within the limits
+	void StepActorMovement(float StepSeconds, float MaxMovementSpeed, float MaxAcceleration,
+		const FMovementLimits2D& MovementLimits, FVector& Location);
+
+	// Calculates the rotation of the updated component when moving up and down
+	void UpdateActorRotation(float RotationToApply, float DeltaSeconds);
 
 	// Returns the owner component to update. If an updated component was not set, returns the root component
 	// of the owner.
@@ -113,4 +151,22 @@ private:
 
 	// The actor's current rotation
 	float CurrentRotation;
+
+	// Simulation time not consumed yet by the fixed steps
+	float TimeAccumulator;
+
+	// Flag which indicates that the simulated states below are initialized
+	bool bHasSimulatedState;
+
+	// Location in the previous simulation step
+	FVector PreviousLocation;
+
+	// Location in the last simulation step
+	FVector SimulatedLocation;
+
+	// Location set to the updated component in the last tick
+	FVector LastRenderedLocation;
+
+	// Rotation in the previous simulation step
+	float PreviousRotation;
 };
@@ -8,6 +8,24 @@
 // Log category
 DECLARE_LOG_CATEGORY_EXTERN(LogFuelCapsule, Log, All);
 
+class USplineComponent;
+
+/**
+ * Enum defining how a fuel capsule moves.
+ */
+UENUM(BlueprintType)
+enum class EFuelCapsuleMotion : uint8
+{
+	// Moved by the physics engine as a simulated rigid body
+	Physics = 0,
+	// Drifts at a constant velocity
+	Velocity = 1,
+	// Drifts at a constant velocity while oscillating along the wave axis
+	SineWave = 2,
+	// Follows a spline at a constant speed
+	Spline = 3
+};
+
 /**
  * Power-up fuel capsule.
  */
@@ -24,6 +42,9 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
 
@@ -51,6 +72,48 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Components)
 	UStaticMeshComponent* MeshComponent;
 
+	// The mesh of the fuel capsule. It is loaded asynchronously and set on the mesh component if it has no mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UStaticMesh> CapsuleMesh;
+
+	// How the fuel capsule moves. Every mode except Physics is integrated by the fuel capsule itself, with
+	// query-only collision and no rigid body simulation.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	EFuelCapsuleMotion MotionMode;
+
+	// Drift velocity in units per second, used by the Velocity and SineWave modes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	FVector DriftVelocity;
+
+	// Axis of the oscillation of the SineWave mode
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	FVector WaveAxis;
+
+	// Amplitude of the oscillation of the SineWave mode
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	float WaveAmplitude;
+
+	// Frequency of the oscillation of the SineWave mode, in hertz
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	float WaveFrequency;
+
+	// Actor holding the spline followed in the Spline mode. The first spline component found is used.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	AActor* MotionPathActor;
+
+	// Speed along the spline in units per second
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	float PathSpeed;
+
+	// Whether the spline is followed again from the start once the end is reached. Otherwise the fuel capsule
+	// keeps moving along the end tangent.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Motion)
+	bool bLoopPath;
+
+	// Changes the motion mode. The motion restarts from the current location.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void SetMotionMode(EFuelCapsuleMotion NewMotionMode);
+
 protected:
 
 	// Checks that the projectile is within the viewport limits
@@ -59,10 +122,43 @@ protected:
 
 private:
 
+	// Called by the culling manager when the fuel capsule leaves the screen
+	void OffScreen(AActor* Actor);
+
+	// Called by the collision manager when the fuel capsule begins overlapping with another actor
+	void BodyOverlap(AActor* OtherActor, UPrimitiveComponent* OtherComp);
+
+	// Flag which indicates that the culling manager checks the visibility of the fuel capsule
+	bool bCulledByManager;
+
 	// Creates the capsule component used for collision detection
 	UCapsuleComponent* CreateCapsuleComponent(USceneComponent* Parent);
 
 	// Creates the mesh component which models the fuel capsule
 	UStaticMeshComponent* CreateMeshComponent(USceneComponent* Parent);
 
+	// Called when the mesh of the fuel capsule is loaded
+	void AssetsLoaded();
+
+	// Enables the rigid body simulation or the query-only collision depending on the motion mode
+	void ApplyMotionMode();
+
+	// Moves the fuel capsule according to the kinematic motion mode
+	void UpdateKinematicMotion(float DeltaSeconds);
+
+	// Returns the location along the motion path after the given time
+	FVector GetPathLocation(float Time) const;
+
+	// Returns whether the fuel capsule needs to tick
+	bool NeedsTick() const;
+
+	// Location where the current kinematic motion started
+	FVector MotionOrigin;
+
+	// Time elapsed since the current kinematic motion started
+	float MotionTime;
+
+	// Spline followed in the Spline mode
+	TWeakObjectPtr<USplineComponent> MotionPath;
+
 };
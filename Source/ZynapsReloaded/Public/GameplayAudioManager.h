@@ -0,0 +1,171 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Components/AudioComponent.h"
+#include "GameplayAudioManager.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogGameplayAudioManager, Log, All);
+
+// Number of voices pre-allocated for a sound cue when no settings are specified
+const int32 DefaultSoundCueMaxVoices = 4;
+
+/**
+ * Struct which stores how many instances of a sound cue can be played at the same time.
+ */
+USTRUCT(BlueprintType)
+struct FSoundCueSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Maximum number of instances of the sound played at the same time. All the voices are pre-allocated.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Audio, meta = (ClampMin = "1"))
+	int32 MaxVoices;
+
+	// Minimum time between two instances of the sound. The requests within this time are ignored.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Audio, meta = (ClampMin = "0.0"))
+	float RetriggerInterval;
+
+	// Whether the oldest instance is stopped to play a new one when all the voices are busy. Otherwise the new
+	// instance is ignored.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Audio)
+	bool bStealOldestVoice;
+
+	// Default constructor
+	FSoundCueSettings()
+	{
+		MaxVoices = DefaultSoundCueMaxVoices;
+		RetriggerInterval = 0.0f;
+		bStealOldestVoice = true;
+	}
+
+	// Constructor with all the settings
+	FSoundCueSettings(int32 InMaxVoices, float InRetriggerInterval, bool bInStealOldestVoice)
+	{
+		MaxVoices = InMaxVoices;
+		RetriggerInterval = InRetriggerInterval;
+		bStealOldestVoice = bInStealOldestVoice;
+	}
+};
+
+/**
+ * Struct which stores the usage counters of a sound cue.
+ */
+USTRUCT(BlueprintType)
+struct FSoundCueStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of pre-allocated voices
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Voices;
+
+	// Number of instances played
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Plays;
+
+	// Number of instances which stopped an older one because all the voices were busy
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Steals;
+
+	// Number of requests ignored because they came too soon after the previous one
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Throttled;
+
+	// Number of requests ignored because all the voices were busy and stealing is not allowed
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Dropped;
+
+	// Default constructor
+	FSoundCueStats()
+	{
+		Voices = Plays = Steals = Throttled = Dropped = 0;
+	}
+};
+
+/**
+ * Struct which stores the voices of a sound cue.
+ */
+USTRUCT()
+struct FSoundCueEntry
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Audio components which play the sound
+	UPROPERTY()  // Needed to ensure garbage collection
+	TArray<UAudioComponent*> Voices;
+
+	// Game time at which each voice started playing
+	TArray<float> VoiceStartTimes;
+
+	// Concurrency settings
+	UPROPERTY()
+	FSoundCueSettings Settings;
+
+	// Game time of the last instance played
+	float LastPlayTime;
+
+	// Usage counters
+	UPROPERTY()
+	FSoundCueStats Stats;
+
+	// Default constructor
+	FSoundCueEntry()
+	{
+		LastPlayTime = -BIG_NUMBER;
+	}
+};
+
+/**
+ * Actor which plays the non-spatialized gameplay sounds through a fixed set of pre-allocated voices per sound
+ * cue. Each cue has a maximum number of voices and a minimum time between instances, so the number of sounds
+ * played doesn't grow with the action on screen and no audio component is created while playing.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AGameplayAudioManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AGameplayAudioManager();
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Returns the audio manager of the specified world or nullptr if the game mode doesn't provide one
+	static AGameplayAudioManager* GetGameplayAudioManager(UWorld* World);
+
+	// Allocates the voices of a sound cue and sets its concurrency settings. The voices are never reduced.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void Prewarm(USoundBase* Sound, const FSoundCueSettings& Settings);
+
+	// Plays a sound on one of its voices. Sounds not pre-warmed get the default settings. Returns false if the
+	// request was throttled or dropped.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	bool Play(USoundBase* Sound);
+
+	// Stops all the voices
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void StopAll();
+
+	// Returns the usage counters of a sound cue
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FSoundCueStats GetStats(USoundBase* Sound) const;
+
+	// Returns the number of voices playing
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 GetNumActiveVoices() const;
+
+private:
+
+	// Creates a voice for a sound cue
+	UAudioComponent* CreateVoice(USoundBase* Sound);
+
+	// Voices by sound cue
+	UPROPERTY()  // Needed to ensure garbage collection
+	TMap<USoundBase*, FSoundCueEntry> Entries;
+};
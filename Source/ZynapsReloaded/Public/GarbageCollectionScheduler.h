@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "GarbageCollectionScheduler.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogGarbageCollectionScheduler, Log, All);
+
+/**
+ * Struct which stores the garbage collection passes observed during the stage.
+ */
+USTRUCT(BlueprintType)
+struct FGarbageCollectionStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of garbage collection passes
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Collections;
+
+	// Number of passes which happened while the stage was in the Playing state
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 CollectionsWhilePlaying;
+
+	// Duration in milliseconds of the last pass
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	float LastPauseMs;
+
+	// Duration in milliseconds of the longest pass
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	float MaxPauseMs;
+
+	// Duration in milliseconds of the longest pass while the stage was in the Playing state
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	float MaxPauseWhilePlayingMs;
+
+	// Default constructor
+	FGarbageCollectionStats()
+	{
+		Collections = CollectionsWhilePlaying = 0;
+		LastPauseMs = MaxPauseMs = MaxPauseWhilePlayingMs = 0.0f;
+	}
+};
+
+/**
+ * Actor which keeps the garbage collection out of the action. While the stage is in the Playing state the
+ * collection is deferred, up to a maximum time so memory doesn't grow without bounds, and it is requested on the
+ * transitions driven by the game mode instead: the Preparing window, the destruction of the player and the game
+ * over. The objects collected then are purged incrementally within a time budget per frame.
+ *
+ * The behaviour is tuned with the console variables Zynaps.GC.DeferWhilePlaying, Zynaps.GC.MaxDeferTime and
+ * Zynaps.GC.PurgeBudgetMs.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AGarbageCollectionScheduler : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AGarbageCollectionScheduler();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the garbage collection scheduler of the specified world or nullptr if the game mode doesn't
+	// provide one
+	static AGarbageCollectionScheduler* GetGarbageCollectionScheduler(UWorld* World);
+
+	// Requests a garbage collection pass on the next frame. Called by the game mode when there is no action.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void RequestCollection();
+
+	// Returns the garbage collection passes observed during the stage
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FGarbageCollectionStats GetStats() const;
+
+private:
+
+	// Returns whether the stage is in the Playing state
+	bool IsPlaying() const;
+
+	// Called before a garbage collection pass
+	void PreGarbageCollect();
+
+	// Called after a garbage collection pass
+	void PostGarbageCollect();
+
+	// Garbage collection passes observed during the stage
+	FGarbageCollectionStats Stats;
+
+	// Flag which indicates that a pass has been requested and must not be deferred
+	bool bCollectionRequested;
+
+	// Flag which indicates that the pass in progress started while playing
+	bool bCollectingWhilePlaying;
+
+	// Time at which the pass in progress started
+	double CollectionStartTime;
+
+	// Time since the last pass, in real seconds
+	float TimeSinceLastCollection;
+
+	// Handle of the delegate called before a garbage collection pass
+	FDelegateHandle PreGarbageCollectHandle;
+
+	// Handle of the delegate called after a garbage collection pass
+	FDelegateHandle PostGarbageCollectHandle;
+};
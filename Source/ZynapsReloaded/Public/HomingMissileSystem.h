@@ -0,0 +1,213 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "InstancedBatchSystem.h"
+#include "HomingMissileSystem.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogHomingMissileSystem, Log, All);
+
+// Default number of missiles the system allocates room for
+const int32 DefaultHomingMissileCapacity = 32;
+
+/**
+ * Struct which stores the activity of the homing missiles during the stage.
+ */
+USTRUCT(BlueprintType)
+struct FHomingMissileStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of live missiles
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 LiveMissiles;
+
+	// Maximum number of live missiles at the same time
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 HighWaterMark;
+
+	// Number of missiles launched
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Launched;
+
+	// Number of missiles which hit an enemy
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Hits;
+
+	// Number of target acquisitions
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Acquisitions;
+
+	// Default constructor
+	FHomingMissileStats()
+	{
+		LiveMissiles = HighWaterMark = Launched = Hits = Acquisitions = 0;
+	}
+};
+
+/**
+ * Actor which simulates all the homing missiles of the player as a single batched system. The missiles are kept in
+ * parallel arrays and drawn as the instances of a single instanced static mesh component, so they need neither
+ * actors nor ticks of their own.
+ *
+ * On each frame the missiles due for a new target are gathered into a single nearest enemy query against the grid
+ * of the enemy swarm. Each missile only looks for a target again once its re-acquisition interval has passed or
+ * its target is gone, so the cost of the queries is spread over the frames. The steering of all the missiles is
+ * then updated in a branchless loop.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AHomingMissileSystem : public AInstancedBatchSystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AHomingMissileSystem();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the homing missile system of the specified world or nullptr if the game mode doesn't provide one
+	static AHomingMissileSystem* GetHomingMissileSystem(UWorld* World);
+
+	// Launches a missile from the given location in the given direction of the gameplay plane
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void LaunchMissile(const FVector& Location, const FVector2D& Direction);
+
+	// Removes all the missiles
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void ClearMissiles();
+
+	// Returns the activity of the missiles during the stage
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FHomingMissileStats GetStats() const;
+
+	// The mesh of the missiles. It is loaded asynchronously and set on the instances component if it has no mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UStaticMesh> MissileMesh;
+
+	// Rotation of the missile meshes relative to their heading
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles)
+	FRotator MissileRotation;
+
+	// Scale of the missile meshes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles)
+	FVector MissileScale;
+
+	// Radius of the missiles in the gameplay plane
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "1.0"))
+	float MissileRadius;
+
+	// Speed of the missiles
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float Speed;
+
+	// Rate at which the missiles turn towards their target. The higher, the sharper the turns.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float TurnRate;
+
+	// Maximum distance at which the missiles acquire a target
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float AcquisitionDistance;
+
+	// Time between the target acquisitions of a missile while its target lives
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float ReacquisitionInterval;
+
+	// Time after which a missile which didn't hit anything is removed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float Lifetime;
+
+	// Damage caused by each missile
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "1"))
+	int32 Damage;
+
+	// Number of missiles the system allocates room for. It grows beyond it if needed.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "1"))
+	int32 Capacity;
+
+	// Distance beyond the edges of the viewport at which the missiles are removed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float CullMargin;
+
+protected:
+
+	// Returns the mesh of the missiles
+	virtual TSoftObjectPtr<UStaticMesh> GetInstanceMesh() const override;
+
+	// Turns the missiles towards their targets and moves them
+	virtual void SteerMissiles(float DeltaSeconds, class AEnemySwarm* EnemySwarm);
+
+	// Damages the enemies hit by the missiles
+	virtual void HitEnemies(class AEnemySwarm* EnemySwarm);
+
+	// Horizontal location of the missiles
+	TArray<float> PositionsY;
+
+	// Vertical location of the missiles
+	TArray<float> PositionsZ;
+
+	// Horizontal velocity of the missiles
+	TArray<float> VelocitiesY;
+
+	// Vertical velocity of the missiles
+	TArray<float> VelocitiesZ;
+
+	// Identifier of the enemy targeted by the missiles, or zero if they have no target
+	TArray<uint32> TargetIds;
+
+	// Time left until the missiles look for a target again
+	TArray<float> AcquisitionTimers;
+
+	// Time elapsed since the missiles were launched
+	TArray<float> Ages;
+
+	// Flag of the missiles which hit something in the current frame
+	TArray<bool> Exploded;
+
+	// Enemies returned by the hit queries. Kept as a member to avoid allocations on each tick.
+	TArray<int32> HitCandidates;
+
+	// Activity of the missiles during the stage
+	FHomingMissileStats Stats;
+
+private:
+
+	// Finds new targets for the missiles due for an acquisition in a single batch
+	void AcquireTargets(float DeltaSeconds, class AEnemySwarm* EnemySwarm);
+
+	// Removes the missiles which hit an enemy, expired or left the screen
+	void RemoveMissiles(const FBox2D& CullBounds);
+
+	// Removes a missile, filling the gap with the last one
+	void RemoveAtSwap(int32 Missile);
+
+	// Updates the instances to match the missiles
+	void UpdateInstances();
+
+	// Horizontal location of the target of each missile in the current frame. Kept to avoid allocations.
+	TArray<float> TargetsY;
+
+	// Vertical location of the target of each missile in the current frame. Kept to avoid allocations.
+	TArray<float> TargetsZ;
+
+	// Weight of the steering of each missile in the current frame, zero if it has no target
+	TArray<float> SteeringWeights;
+
+	// Missiles gathered for the batched acquisition. Kept as a member to avoid allocations on each tick.
+	TArray<int32> AcquiringMissiles;
+
+	// Locations of the missiles gathered for the batched acquisition
+	TArray<FVector2D> AcquisitionLocations;
+
+	// Results of the batched acquisition
+	TArray<int32> AcquiredEnemies;
+};
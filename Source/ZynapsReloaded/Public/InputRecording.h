@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogInputRecording, Log, All);
+
+// Identifier at the start of the recording files ("ZREC")
+const uint32 InputRecordingMagic = 0x5A524543;
+
+// Version of the recording file format
+const uint32 InputRecordingVersion = 1;
+
+// Extension of the recording files
+const TCHAR* const InputRecordingExtension = TEXT(".zrec");
+
+/**
+ * Struct which stores a change of the recorded input.
+ */
+struct FInputRecordingEvent
+{
+	// Tick in which the input mask changed
+	uint32 Tick;
+
+	// Mask of held buttons from this tick (see EZynapsInputBits)
+	uint8 InputMask;
+};
+
+/**
+ * Per-tick input of a play session. Only the ticks in which the input mask changes are kept, and they are saved
+ * delta-encoded: each change is stored as the number of ticks since the previous change, as a variable-length
+ * integer, followed by the new mask. A session holding the same buttons for a long time takes a few bytes.
+ */
+class ZYNAPSRELOADED_API FInputRecording
+{
+public:
+
+	// Creates an empty recording
+	FInputRecording();
+
+	// Clears the recording and sets its header
+	void Reset(const FString& InStageName, int32 InSeed, float InTickRate);
+
+	// Adds the input mask of the next tick
+	void AddTick(uint8 InputMask);
+
+	// Returns the input mask of a tick. The cursor keeps the position of the previous query, so reading the
+	// ticks in order is O(1).
+	uint8 GetInputMask(uint32 Tick, int32& Cursor) const;
+
+	// Returns the number of recorded ticks
+	uint32 GetNumTicks() const;
+
+	// Returns the number of input changes
+	int32 GetNumEvents() const;
+
+	// Returns the name of the recorded stage
+	const FString& GetStageName() const;
+
+	// Returns the random seed used during the recording
+	int32 GetSeed() const;
+
+	// Returns the fixed tick rate used during the recording, or 0 if the time step was variable
+	float GetTickRate() const;
+
+	// Saves the recording to a file. Returns false on error.
+	bool SaveToFile(const FString& FileName);
+
+	// Loads the recording from a file. Returns false on error.
+	bool LoadFromFile(const FString& FileName);
+
+	// Returns the full path of a recording. Names without a directory are placed in Saved/InputRecordings.
+	static FString GetRecordingPath(const FString& Name);
+
+private:
+
+	// Serializes the recording
+	bool Serialize(FArchive& Archive);
+
+	// Name of the recorded stage
+	FString StageName;
+
+	// Random seed used during the recording
+	int32 Seed;
+
+	// Fixed tick rate used during the recording
+	float TickRate;
+
+	// Number of recorded ticks
+	uint32 NumTicks;
+
+	// Input changes sorted by tick
+	TArray<FInputRecordingEvent> Events;
+};
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Number of buttons tracked by the input timing
+const int32 InputTimingNumButtons = 8;
+
+/**
+ * Struct which stores the press and release times of a button.
+ */
+struct FButtonTiming
+{
+	// Time of the last press, or a negative value if the button was never pressed
+	double PressTime;
+
+	// Time of the press before the last one, or a negative value if there is none
+	double PreviousPressTime;
+
+	// Time of the last release, or a negative value if the button was never released
+	double ReleaseTime;
+
+	// Whether the button is held down
+	bool bHeld;
+
+	// Default constructor
+	FButtonTiming()
+	{
+		PressTime = PreviousPressTime = ReleaseTime = -1.0;
+		bHeld = false;
+	}
+};
+
+/**
+ * Tracks when the buttons are pressed and released to measure hold durations, double taps and charge levels.
+ * Buttons are identified by their bit in the input mask (see EZynapsInputBits).
+ *
+ * All the times are expected in simulation time, e.g. UWorld::GetTimeSeconds() adjusted to the moment of the
+ * event within the frame, so the measures follow pause, time dilation and replay speed and don't depend on the
+ * frame rate.
+ */
+class ZYNAPSRELOADED_API FInputTiming
+{
+public:
+
+	// Registers a press of the button at the given time. It is ignored if the button is already held.
+	void Press(uint8 ButtonBit, double Time);
+
+	// Registers a release of the button at the given time. It is ignored if the button is not held.
+	void Release(uint8 ButtonBit, double Time);
+
+	// Forgets all the presses and releases
+	void Reset();
+
+	// Returns whether the button is held down
+	bool IsHeld(uint8 ButtonBit) const;
+
+	// Returns how long the button has been held at the given time, or 0 if it is not held
+	double GetHoldDuration(uint8 ButtonBit, double Now) const;
+
+	// Returns how long the button was held the last time it was released, or 0 if it was never released
+	double GetLastHoldDuration(uint8 ButtonBit) const;
+
+	// Returns whether the last press came within the given time window after the previous one
+	bool IsDoubleTap(uint8 ButtonBit, double Window) const;
+
+	// Returns the charge level between 0 and 1 of a button held at the given time, where 1 is reached after
+	// holding it for the full charge time
+	float GetChargeLevel(uint8 ButtonBit, double Now, double FullChargeTime) const;
+
+	// Returns the timing of a button
+	const FButtonTiming& GetButtonTiming(uint8 ButtonBit) const;
+
+private:
+
+	// Returns the index of a button from its bit
+	static int32 GetButtonIndex(uint8 ButtonBit);
+
+	// Timing of each button
+	FButtonTiming Buttons[InputTimingNumButtons];
+};
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "InstancedBatchSystem.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogInstancedBatchSystem, Log, All);
+
+/**
+ * Base of the actors which simulate many elements as a single batched system and draw each element as an instance
+ * of a single instanced static mesh component. The instances have no bodies, the systems check their collisions
+ * themselves.
+ *
+ * The instance buffer only grows. On each update the systems set the instances of their live elements and then the
+ * number of elements shown, so the instances of the elements removed since the previous update are collapsed
+ * instead of removed and the render state is only marked dirty once.
+ */
+UCLASS(Abstract)
+class ZYNAPSRELOADED_API AInstancedBatchSystem : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AInstancedBatchSystem();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Returns the soft references to the assets of the system
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& Assets) const;
+
+	// Component which draws the elements of the system
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Components)
+	UInstancedStaticMeshComponent* InstancesComponent;
+
+protected:
+
+	// Returns the stage game mode of the specified world or nullptr if there is none
+	static class AStageGameMode* GetStageGameMode(UWorld* World);
+
+	// Returns the mesh of the instances. It is set on the instances component once loaded if it has no mesh.
+	virtual TSoftObjectPtr<UStaticMesh> GetInstanceMesh() const;
+
+	// Called when the assets of the system are loaded
+	virtual void AssetsLoaded();
+
+	// Adds hidden instances until the component holds the given number, so the system doesn't allocate while playing
+	void ReserveInstances(int32 NumInstances);
+
+	// Places the instance of the element with the given index. The render state is marked dirty by SetNumShown.
+	void SetInstance(int32 Index, const FTransform& Transform);
+
+	// Sets the number of elements shown after their instances were placed. The instances beyond them are collapsed.
+	void SetNumShown(int32 NumShown);
+
+	// Returns the number of elements shown in the last update
+	int32 GetNumShown() const;
+
+private:
+
+	// Number of elements shown in the last update. The instances beyond them are collapsed.
+	int32 NumShownInstances;
+};
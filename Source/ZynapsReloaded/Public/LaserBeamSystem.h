@@ -0,0 +1,181 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "InstancedBatchSystem.h"
+#include "LaserBeamSystem.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogLaserBeamSystem, Log, All);
+
+// Default number of beams the system allocates room for
+const int32 DefaultLaserBeamCapacity = 64;
+
+/**
+ * Struct which stores the activity of the laser beams during the stage.
+ */
+USTRUCT(BlueprintType)
+struct FLaserBeamStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of beams fired
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Fired;
+
+	// Number of beams which hit an enemy
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 EnemyHits;
+
+	// Number of beams stopped by the scenery
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 TerrainHits;
+
+	// Maximum number of live beams at the same time
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 HighWaterMark;
+
+	// Default constructor
+	FLaserBeamStats()
+	{
+		Fired = EnemyHits = TerrainHits = HighWaterMark = 0;
+	}
+};
+
+/**
+ * Actor which simulates the laser shots of the powered up cannons as a single batched system. Each beam is a
+ * segment whose length and damage grow with the laser power, drawn as an instance of a single instanced static
+ * mesh component, so the beams need neither actors nor physics bodies.
+ *
+ * On each frame every beam is tested along its whole travel since the previous frame, from its old tail to its new
+ * head, so fast beams can't tunnel through enemies or thin walls at low frame rates. All the swept segments are
+ * tested against the enemy grid in a single batch, and against the scenery by marching the stage distance field.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API ALaserBeamSystem : public AInstancedBatchSystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	ALaserBeamSystem();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the laser beam system of the specified world or nullptr if the game mode doesn't provide one
+	static ALaserBeamSystem* GetLaserBeamSystem(UWorld* World);
+
+	// Fires a beam of the given laser power from the given location in the given direction of the gameplay plane.
+	// ElapsedSeconds is the time passed since the moment of the shot, so the beam is moved to where it would be.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void FireBeam(const FVector& Location, const FVector2D& Direction, uint8 LaserPower, float ElapsedSeconds);
+
+	// Removes all the beams
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void ClearBeams();
+
+	// Returns the activity of the beams during the stage
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FLaserBeamStats GetStats() const;
+
+	// The mesh of the beams. It is loaded asynchronously and set on the instances component if it has no mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UStaticMesh> BeamMesh;
+
+	// Size of the beam mesh at unit scale
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "1.0"))
+	float BeamMeshSize;
+
+	// Speed of the beams
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "0.0"))
+	float Speed;
+
+	// Radius of the beams in the gameplay plane
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "1.0"))
+	float BeamRadius;
+
+	// Length of the beams for each level of laser power
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "0.0"))
+	float LengthPerLaserPower;
+
+	// Damage caused by the beams for each level of laser power
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "1"))
+	int32 DamagePerLaserPower;
+
+	// Number of beams the system allocates room for. It grows beyond it if needed.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "1"))
+	int32 Capacity;
+
+	// Distance beyond the edges of the viewport at which the beams are removed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Beams, meta = (ClampMin = "0.0"))
+	float CullMargin;
+
+protected:
+
+	// Returns the mesh of the beams
+	virtual TSoftObjectPtr<UStaticMesh> GetInstanceMesh() const override;
+
+private:
+
+	// Moves the beams and gathers the segments swept since the previous frame
+	void MoveBeams(float DeltaSeconds);
+
+	// Tests the swept segments against the enemies and the scenery, stopping the beams at the first contact
+	void HitTargets(class AEnemySwarm* EnemySwarm);
+
+	// Removes the beams which hit something or left the screen
+	void RemoveBeams(const FBox2D& CullBounds);
+
+	// Updates the instances to match the beams
+	void UpdateInstances();
+
+	// Returns the tail of a beam, which grows from the cannon until the beam reaches its length
+	FVector2D GetTail(int32 Beam) const;
+
+	// Horizontal location of the head of the beams
+	TArray<float> HeadsY;
+
+	// Vertical location of the head of the beams
+	TArray<float> HeadsZ;
+
+	// Horizontal component of the direction of the beams
+	TArray<float> DirectionsY;
+
+	// Vertical component of the direction of the beams
+	TArray<float> DirectionsZ;
+
+	// Distance travelled by the head of the beams since they were fired
+	TArray<float> Travelled;
+
+	// Length of the beams
+	TArray<float> Lengths;
+
+	// Damage caused by the beams
+	TArray<int32> Damages;
+
+	// Flag of the beams which hit something in the current frame
+	TArray<bool> Stopped;
+
+	// Start of the segment swept by each beam in the current frame. Kept to avoid allocations.
+	TArray<FVector2D> SweepStarts;
+
+	// End of the segment swept by each beam in the current frame. Kept to avoid allocations.
+	TArray<FVector2D> SweepEnds;
+
+	// First enemy touched by each swept segment
+	TArray<int32> SweptEnemies;
+
+	// Fraction of each swept segment at which the first enemy is touched
+	TArray<float> SweptFractions;
+
+	// Activity of the beams during the stage
+	FLaserBeamStats Stats;
+};
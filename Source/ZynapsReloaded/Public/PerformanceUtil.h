@@ -0,0 +1,81 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "PerformanceUtil.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogPerformanceUtil, Log, All);
+
+/**
+ * Struct which stores a snapshot of the performance counters of the gameplay module.
+ */
+USTRUCT(BlueprintType)
+struct FZynapsPerformanceStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Duration of the last frame in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = Utilities)
+	float FrameTime;
+
+	// Game thread time of the last frame in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = Utilities)
+	float GameThreadTime;
+
+	// Frames per second derived from the last frame time
+	UPROPERTY(BlueprintReadOnly, Category = Utilities)
+	float FramesPerSecond;
+
+	// Number of player projectiles in flight
+	UPROPERTY(BlueprintReadOnly, Category = Utilities)
+	int32 LiveProjectiles;
+
+	// Number of fuel capsules in the level
+	UPROPERTY(BlueprintReadOnly, Category = Utilities)
+	int32 LiveFuelCapsules;
+
+	// Number of actors spawned during the last second
+	UPROPERTY(BlueprintReadOnly, Category = Utilities)
+	float SpawnsPerSecond;
+
+	// Default constructor
+	FZynapsPerformanceStats()
+	{
+		FrameTime = GameThreadTime = FramesPerSecond = SpawnsPerSecond = 0.0f;
+		LiveProjectiles = LiveFuelCapsules = 0;
+	}
+};
+
+/**
+ * A class with utility methods to instrument the gameplay module. The counters are kept in all build
+ * configurations, so they can be shown by the performance overlay even where the engine stats are compiled out.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API UPerformanceUtil : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	// Adds the given amount to the number of live projectiles
+	static void AddLiveProjectiles(int32 Delta);
+
+	// Adds the given amount to the number of live fuel capsules
+	static void AddLiveFuelCapsules(int32 Delta);
+
+	// Records that a gameplay actor was spawned
+	static void RecordSpawn();
+
+	// Returns a snapshot of the performance counters
+	UFUNCTION(BlueprintPure, Category = Utilities)
+	static FZynapsPerformanceStats GetPerformanceStats();
+
+	// Returns true if the performance overlay is enabled with the console variable Zynaps.PerfOverlay
+	UFUNCTION(BlueprintPure, Category = Utilities)
+	static bool IsPerformanceOverlayEnabled();
+
+	// Draws the performance overlay if it is enabled. It is meant to be registered as a debug draw delegate.
+	static void DrawPerformanceOverlay(UCanvas* Canvas, APlayerController* PlayerController);
+};
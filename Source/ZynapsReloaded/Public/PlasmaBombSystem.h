@@ -0,0 +1,146 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "InstancedBatchSystem.h"
+#include "PlasmaBombSystem.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogPlasmaBombSystem, Log, All);
+
+// Default number of bombs the system allocates room for
+const int32 DefaultPlasmaBombCapacity = 4;
+
+/**
+ * Struct which stores the activity of the plasma bombs during the stage.
+ */
+USTRUCT(BlueprintType)
+struct FPlasmaBombStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of bombs detonated
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Detonated;
+
+	// Number of enemies damaged by the bombs
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Hits;
+
+	// Number of region queries against the enemy grid
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Queries;
+
+	// Default constructor
+	FPlasmaBombStats()
+	{
+		Detonated = Hits = Queries = 0;
+	}
+};
+
+/**
+ * Actor which simulates all the plasma bombs of the player as a single batched system. Each bomb is a blast whose
+ * radius expands from its detonation point and damages every enemy it reaches once.
+ *
+ * On each frame the bounds of all the live blasts are served by a single region query against the grid of the
+ * enemy swarm. Each bomb remembers the enemies it has already damaged, so the enemies inside a blast are only
+ * processed once however many frames it lasts.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API APlasmaBombSystem : public AInstancedBatchSystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	APlasmaBombSystem();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the plasma bomb system of the specified world or nullptr if the game mode doesn't provide one
+	static APlasmaBombSystem* GetPlasmaBombSystem(UWorld* World);
+
+	// Detonates a bomb at the given location
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void DetonateBomb(const FVector& Location);
+
+	// Removes all the bombs
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void ClearBombs();
+
+	// Returns the activity of the bombs during the stage
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FPlasmaBombStats GetStats() const;
+
+	// The mesh of the blasts. It is loaded asynchronously and set on the instances component if it has no mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UStaticMesh> BlastMesh;
+
+	// Radius of the blast mesh at unit scale
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Bombs, meta = (ClampMin = "1.0"))
+	float BlastMeshRadius;
+
+	// Radius the blasts reach when fully expanded
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Bombs, meta = (ClampMin = "0.0"))
+	float MaxRadius;
+
+	// Time the blasts take to expand to their maximum radius
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Bombs, meta = (ClampMin = "0.01"))
+	float ExpansionTime;
+
+	// Damage caused to each enemy reached by a blast
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Bombs, meta = (ClampMin = "1"))
+	int32 Damage;
+
+	// Number of bombs the system allocates room for. It grows beyond it if needed.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Bombs, meta = (ClampMin = "1"))
+	int32 Capacity;
+
+protected:
+
+	// Returns the mesh of the blasts
+	virtual TSoftObjectPtr<UStaticMesh> GetInstanceMesh() const override;
+
+private:
+
+	// Expands the blasts
+	void ExpandBlasts(float DeltaSeconds);
+
+	// Damages the enemies reached by the blasts with a single region query
+	void HitEnemies(class AEnemySwarm* EnemySwarm);
+
+	// Removes the blasts which finished expanding
+	void RemoveBombs();
+
+	// Updates the instances to match the blasts
+	void UpdateInstances();
+
+	// Horizontal location of the bombs
+	TArray<float> PositionsY;
+
+	// Vertical location of the bombs
+	TArray<float> PositionsZ;
+
+	// Current radius of the blasts
+	TArray<float> Radii;
+
+	// Time elapsed since the bombs were detonated
+	TArray<float> Ages;
+
+	// Identifiers of the enemies already damaged by each bomb
+	TArray<TSet<uint32>> DamagedEnemies;
+
+	// Enemies returned by the region query. Kept as a member to avoid allocations on each tick.
+	TArray<int32> Candidates;
+
+	// Activity of the bombs during the stage
+	FPlasmaBombStats Stats;
+};
@@ -8,6 +8,7 @@
 #include "PlayerProjectile.h"
 #include "Fly2DMovementComponent.h"
 #include "FuelCapsule.h"
+#include "GameplayAudioManager.h"
 #include "PlayerPawn.generated.h"
 
 // Log category
@@ -18,6 +19,15 @@ const uint8 RightCannon = 0;
 const uint8 LeftCannon = 1;
 const uint8 TopCannon = 2;
 
+// Default number of shots per second of the automatic fire with the laser power at its lowest level
+const float DefaultAutoFireRate = 6.0f;
+
+// Default number of shots per second added by each laser power level
+const float DefaultAutoFireRatePerLaserPower = 2.0f;
+
+// Default maximum number of shots fired in a single frame, so a long hitch doesn't release a burst of shots
+const int32 DefaultMaxAutoFireShotsPerFrame = 8;
+
 // Constant which defines the speed of the highlight glow while in power-up activation mode
 const float HighlightGlowSpeed = 1.0f;
 
@@ -33,15 +43,18 @@ public:
 	// Sets default values for this pawn's properties
 	APlayerPawn();
 
-	// Called after component initialization
-	virtual void PostInitializeComponents() override;
-
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
 
+	// Returns the soft references to the assets of the pawn, so they can be preloaded
+	void GetPreloadAssets(TArray<FSoftObjectPath>& Assets) const;
+
 	// Called to move the player up
 	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
 	void MoveUp(float Val);
@@ -58,10 +71,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
 	void MoveRight(float Val);
 
-	// Called to fire
+	// Called to fire a single shot
 	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
 	void Fire();
 
+	// Called when the fire button is pressed. Fires a shot and, if the automatic fire is enabled, keeps firing
+	// at the cadence of the laser power until StopFire is called. ElapsedSeconds is the time passed since the
+	// button was pressed, so the following shots are scheduled from the exact moment of the press.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void StartFire(float ElapsedSeconds = 0.0f);
+
+	// Called when the fire button is released to stop the automatic fire
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void StopFire();
+
+	// Returns the time between two shots of the automatic fire with the current laser power
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	float GetAutoFireInterval() const;
+
 	// Called when a player hits other actor or an obstacle
 	UFUNCTION(BlueprintNativeEvent, Category = ZynapsEvents)
 	void Hit(class UPrimitiveComponent* HitComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp,
@@ -94,14 +121,76 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Components)
 	UFly2DMovementComponent* MovementComponent;
 
+	// The mesh of the ship. It is loaded asynchronously and set on the mesh component if it has no mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UStaticMesh> ShipMesh;
+
+	// The particle system of the engine thrust. It is loaded asynchronously and set on the engine particle system
+	// component if it has no template.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UParticleSystem> EngineThrustTemplate;
+
+	// The particle system of the explosion. It is loaded asynchronously and used if ExplosionPartSystem is not set.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Assets)
+	TSoftObjectPtr<UParticleSystem> ExplosionTemplate;
+
 	// The type of projectile spawned when firing
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	TSubclassOf<class APlayerProjectile> ProjectileClass;
 
+	// Number of projectiles of ProjectileClass pre-spawned in the projectile pool
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	int32 ProjectilePoolCapacity;
+
+	// Whether the cannons keep firing at the automatic fire rate while the fire button is held. If false, each
+	// press fires a single shot.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	bool bAutoFire;
+
+	// Number of shots per second of the automatic fire with the laser power at its lowest level
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.1"))
+	float AutoFireRate;
+
+	// Number of shots per second added to the automatic fire by each laser power level
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.0"))
+	float AutoFireRatePerLaserPower;
+
+	// Maximum number of shots of the automatic fire in a single frame. The shots due beyond it are dropped.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "1"))
+	int32 MaxAutoFireShotsPerFrame;
+
+	// Minimum time between two launches of homing missiles while the power-up is active
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.0"))
+	float HomingMissileInterval;
+
+	// Vertical component of the launch direction of the homing missiles, relative to the forward component
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.0"))
+	float HomingMissileSpread;
+
+	// Minimum time between two launches of seeker missiles while the power-up is active
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.0"))
+	float SeekerMissileInterval;
+
+	// Minimum time between two plasma bombs while the power-up is active
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.0"))
+	float PlasmaBombInterval;
+
+	// Distance ahead of the ship at which the plasma bombs detonate
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor, meta = (ClampMin = "0.0"))
+	float PlasmaBombDistance;
+
 	// The explosion particle system spawned when the ship is hit
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	UParticleSystem* ExplosionPartSystem;
 
+	// Number of explosion effects pre-warmed in the effects pool
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	int32 ExplosionPoolCapacity;
+
+	// Maximum number of explosion effects played at the same time
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	int32 ExplosionPoolBudget;
+
 	// The type of camera shake used when the ship is destroyed
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	TSubclassOf<UCameraShake> CameraShakeClass;
@@ -126,18 +215,34 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	USoundBase* FireSound;
 
+	// Concurrency settings of the sound played when the player fires a cannon
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	FSoundCueSettings FireSoundSettings;
+
 	// The sound to be played when the player is destroyed
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	USoundBase* ExplosionSound;
 
+	// Concurrency settings of the sound played when the player is destroyed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	FSoundCueSettings ExplosionSoundSettings;
+
 	// The sound to be played when the selected power-up is shifted
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	USoundBase* ShiftPowerUpSound;
 
+	// Concurrency settings of the sound played when the selected power-up is shifted
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	FSoundCueSettings ShiftPowerUpSoundSettings;
+
 	// The sound to be played when the selected power-up is activated
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
 	USoundBase* ActivatePowerUpSound;
 
+	// Concurrency settings of the sound played when the selected power-up is activated
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Actor)
+	FSoundCueSettings ActivatePowerUpSoundSettings;
+
 protected:
 
 	// Returns the transform of a socket
@@ -166,8 +271,8 @@ private:
 	// Creates the component which manages the movement of the ship
 	UFly2DMovementComponent* CreateMovementComponent();
 
-	// Creates the explosion particle system
-	UParticleSystem* CreateExplosionParticleSystem();
+	// Called when the assets of the pawn are loaded to set up the components
+	void AssetsLoaded();
 
 	// Returns a reference to the instance of AZynapsPlayerState or NULL if it doesn't exist
 	AZynapsPlayerState* GetZynapsPlayerState() const;
@@ -175,11 +280,52 @@ private:
 	// Returns the game state
 	AZynapsGameState* GetZynapsGameState() const;
 
+	// Plays a gameplay sound through the audio manager. Returns false if the sound was throttled or dropped.
+	bool PlayGameplaySound(USoundBase* Sound);
+
+	// Called by the collision manager when the player begins overlapping with another actor
+	void BodyOverlap(AActor* OtherActor, UPrimitiveComponent* OtherComp);
+
+	// Fires the automatic shots due since the previous frame
+	void UpdateAutoFire();
+
+	// Returns the name of the socket of a cannon
+	FName GetCannonSocketName(uint8 Cannon) const;
+
+	// Shoots the next cannon from the given transform. ElapsedSeconds is the time passed since the moment of
+	// the shot, so the projectile is moved to where it would be now.
+	void FireCannon(const FTransform& CannonTransform, float ElapsedSeconds);
+
+	// Launches a pair of homing missiles if the power-up is active and the launch interval has passed
+	void LaunchHomingMissiles();
+
+	// Launches a pair of seeker missiles if the power-up is active and the launch interval has passed
+	void LaunchSeekerMissiles();
+
+	// Detonates a plasma bomb ahead of the ship if the power-up is active and the bomb interval has passed
+	void DetonatePlasmaBomb();
+
 	// The next cannon to be shot
 	uint8 NextCannon;
 
+	// Whether the automatic fire is running
+	bool bAutoFiring;
+
+	// Game time of the next shot of the automatic fire
+	double NextAutoFireTime;
+
+	// Game time from which the next homing missiles can be launched
+	double NextHomingMissileTime;
+
+	// Game time from which the next seeker missiles can be launched
+	double NextSeekerMissileTime;
+
+	// Game time from which the next plasma bomb can be detonated
+	double NextPlasmaBombTime;
+
 	// The dynamic material instance used to change the color of the ship during the power-up
-	// activation mode
+	// activation mode. It is created once the ship mesh is loaded.
+	UPROPERTY()  // Needed to ensure garbage collection
 	UMaterialInstanceDynamic* DynMaterial;
 
 	// Highlight direction
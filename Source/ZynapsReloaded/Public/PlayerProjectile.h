@@ -20,13 +20,75 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
 
+	// Called by the pool to place the projectile at the given transform and launch it
+	void ActivateFromPool(const FTransform& Transform);
+
+	// Called by the pool to hide the projectile and stop its simulation until it is acquired again
+	void DeactivateToPool();
+
+	// Moves the projectile along its launch velocity as if it had been fired the given seconds ago
+	void AdvanceSinceLaunch(float ElapsedSeconds);
+
+	// Sets the pool which owns the projectile
+	void SetOwningPool(class AProjectilePool* Pool);
+
+	// Returns whether the projectile is waiting in its pool to be acquired
+	bool IsInPool() const;
+
+	// Called when the projectile is taken from the pool
+	UFUNCTION(BlueprintNativeEvent, Category = ZynapsEvents)
+	void Launched();
+
+	// Called when the projectile is given back to the pool
+	UFUNCTION(BlueprintNativeEvent, Category = ZynapsEvents)
+	void Retired();
+
+	// Called when the collision manager detects that the projectile hit a target. By default the projectile
+	// is released.
+	UFUNCTION(BlueprintNativeEvent, Category = ZynapsEvents)
+	void TargetHit(AActor* Target, UPrimitiveComponent* TargetComp);
+
 protected:
 
 	// Checks that the projectile is within the viewport limits
 	UFUNCTION(BlueprintPure, meta = (BlueprintProtected), Category = Util)
 	bool IsVisibleOnScreen() const;
 
+	// Gives the projectile back to its pool or destroys it if it was not spawned by a pool
+	UFUNCTION(BlueprintCallable, meta = (BlueprintProtected), Category = ZynapsActions)
+	void ReleaseProjectile();
+
+private:
+
+	// Registers the projectile in the culling manager. Returns false if there is no culling manager, so the
+	// projectile must check its visibility by itself on each tick.
+	bool RegisterForCulling();
+
+	// Called by the culling manager when the projectile leaves the screen
+	void OffScreen(AActor* Actor);
+
+	// Called by the collision manager when the projectile begins overlapping with a target
+	void BodyOverlap(AActor* OtherActor, UPrimitiveComponent* OtherComp);
+
+	// Flag which indicates that the culling manager checks the visibility of the projectile
+	bool bCulledByManager;
+
+	// Flag which indicates that the projectile is waiting in its pool to be acquired
+	bool bInPool;
+
+	// The pool which owns the projectile
+	TWeakObjectPtr<class AProjectilePool> OwningPool;
+
+	// Movement component of the projectile, found once when the game starts
+	UPROPERTY()  // Needed to ensure garbage collection
+	class UProjectileMovementComponent* ProjectileMovement;
+
+	// Launch velocity of the projectile movement component relative to the projectile rotation
+	FVector LocalLaunchVelocity;
 };
@@ -0,0 +1,113 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "PlayerProjectile.h"
+#include "ProjectilePool.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogProjectilePool, Log, All);
+
+// Number of projectiles pre-warmed for a projectile class when no capacity is specified
+const int32 DefaultProjectilePoolCapacity = 16;
+
+/**
+ * Struct which stores the usage counters of the pool for a projectile class.
+ */
+USTRUCT(BlueprintType)
+struct FProjectilePoolStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of projectiles the pool was pre-warmed with
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Capacity;
+
+	// Number of projectiles currently in use
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 InUse;
+
+	// Maximum number of projectiles in use at the same time
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 HighWaterMark;
+
+	// Number of requests served with an already spawned projectile
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Hits;
+
+	// Number of requests which needed to spawn a new projectile because the pool was empty
+	UPROPERTY(BlueprintReadOnly, Category = Utility)
+	int32 Misses;
+
+	// Default constructor
+	FProjectilePoolStats()
+	{
+		Capacity = InUse = HighWaterMark = Hits = Misses = 0;
+	}
+};
+
+/**
+ * Struct which stores the projectiles available for a projectile class.
+ */
+USTRUCT()
+struct FProjectilePoolEntry
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Projectiles ready to be acquired
+	UPROPERTY()  // Needed to ensure garbage collection
+	TArray<APlayerProjectile*> FreeProjectiles;
+
+	// Usage counters
+	UPROPERTY()
+	FProjectilePoolStats Stats;
+};
+
+/**
+ * Actor which keeps pre-spawned projectiles ready to be reused, so firing doesn't need to spawn and destroy an
+ * actor for every shot.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AProjectilePool : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AProjectilePool();
+
+	// Called when the actor is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Returns the projectile pool of the specified world or nullptr if the game mode doesn't provide one
+	static AProjectilePool* GetProjectilePool(UWorld* World);
+
+	// Spawns projectiles of the given class until the pool holds at least the specified capacity. The default
+	// capacity matches DefaultProjectilePoolCapacity, the header tool only accepts literal defaults.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void Prewarm(TSubclassOf<APlayerProjectile> ProjectileClass, int32 Capacity = 16);
+
+	// Takes a projectile of the given class from the pool and places it at the given transform. A new projectile
+	// is spawned if none is available.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	APlayerProjectile* Acquire(TSubclassOf<APlayerProjectile> ProjectileClass, const FTransform& Transform);
+
+	// Returns a projectile to the pool. Releasing a projectile which is already in the pool does nothing.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void Release(APlayerProjectile* Projectile);
+
+	// Returns the usage counters for the given projectile class
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	FProjectilePoolStats GetStats(TSubclassOf<APlayerProjectile> ProjectileClass) const;
+
+private:
+
+	// Spawns a new projectile owned by the pool. It is returned inactive.
+	APlayerProjectile* SpawnProjectile(TSubclassOf<APlayerProjectile> ProjectileClass, const FTransform& Transform);
+
+	// Pooled projectiles by class
+	UPROPERTY()  // Needed to ensure garbage collection
+	TMap<UClass*, FProjectilePoolEntry> Entries;
+};
@@ -3,11 +3,73 @@
 #pragma once
 
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Camera/CameraTypes.h"
 #include "ProjectionUtil.generated.h"
 
 // Log category
 DECLARE_LOG_CATEGORY_EXTERN(LogProjectionUtil, Log, All);
 
+/**
+ * Struct which keeps the viewport bounds calculated for a camera view, so they are recalculated only when the
+ * view changes.
+ */
+struct FViewportBoundsCache
+{
+	// Frame in which the bounds were last validated
+	uint64 Frame;
+
+	// Flag which indicates that the cached bounds are valid
+	bool bValid;
+
+	// Camera location used to calculate the bounds
+	FVector CameraLocation;
+
+	// Camera rotation used to calculate the bounds
+	FRotator CameraRotation;
+
+	// Camera field of view used to calculate the bounds
+	float FOV;
+
+	// Camera ortho width used to calculate the bounds
+	float OrthoWidth;
+
+	// Camera aspect ratio used to calculate the bounds
+	float AspectRatio;
+
+	// Viewport aspect ratio used to calculate the bounds
+	float ViewportAspectRatio;
+
+	// Whether the view was letterboxed when the bounds were calculated
+	bool bConstrainAspectRatio;
+
+	// Camera projection mode used to calculate the bounds
+	TEnumAsByte<ECameraProjectionMode::Type> ProjectionMode;
+
+	// Cached top left bound
+	FVector TopLeftBound;
+
+	// Cached bottom right bound
+	FVector BottomRightBound;
+
+	// Default constructor
+	FViewportBoundsCache()
+	{
+		Frame = 0;
+		bValid = false;
+		CameraLocation = TopLeftBound = BottomRightBound = FVector::ZeroVector;
+		CameraRotation = FRotator::ZeroRotator;
+		FOV = OrthoWidth = AspectRatio = ViewportAspectRatio = 0.0f;
+		bConstrainAspectRatio = false;
+		ProjectionMode = ECameraProjectionMode::Perspective;
+	}
+
+	// Invalidates the cached bounds
+	void Invalidate()
+	{
+		bValid = false;
+	}
+};
+
 /**
  * A library of static functions to perform convertions from 3D world coordinates to 2D screen coordinates and
  * viceversa.
@@ -50,4 +112,22 @@ public:
 	UFUNCTION(BlueprintPure, Category = Utilities)
 	static bool CalculateViewportBounds(APlayerController* PlayerController, FVector& TopLeftBound,
 			FVector& BottomRightBound);
+
+	// Calculates the viewport bounds using only the camera view parameters, without deprojecting screen
+	// coordinates. The result is the same as CalculateViewportBounds: the corners of the viewport excluding the
+	// black bars, at the camera distance along their rays. Returns false on error.
+	UFUNCTION(BlueprintPure, Category = Utilities)
+	static bool CalculateViewportBoundsFromView(const FMinimalViewInfo& View, float ViewportAspectRatio,
+		FVector& TopLeftBound, FVector& BottomRightBound);
+
+	// Returns the viewport bounds of the player's camera. They are recalculated at most once per frame and only
+	// if the camera view or the viewport changed, so they can be queried freely. Returns false on error.
+	UFUNCTION(BlueprintPure, Category = Utilities)
+	static bool GetCachedViewportBounds(APlayerController* PlayerController, FVector& TopLeftBound,
+		FVector& BottomRightBound);
+
+	// Returns the viewport bounds using the given cache. They are recalculated at most once per frame and only
+	// if the camera view or the viewport changed. Returns false on error.
+	static bool GetViewportBoundsFromCache(APlayerController* PlayerController, FViewportBoundsCache& Cache,
+		FVector& TopLeftBound, FVector& BottomRightBound);
 };
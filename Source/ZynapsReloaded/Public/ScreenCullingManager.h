@@ -0,0 +1,78 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "ScreenCullingManager.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogScreenCullingManager, Log, All);
+
+// Delegate called when a registered actor leaves the screen
+DECLARE_DELEGATE_OneParam(FOnActorOffScreen, AActor*);
+
+/**
+ * Struct which stores an actor registered for off-screen culling.
+ */
+struct FCulledActor
+{
+	// The registered actor
+	TWeakObjectPtr<AActor> Actor;
+
+	// Raw pointer used as the lookup key. It is never dereferenced, so it stays valid as a key even if the
+	// actor is destroyed without being unregistered.
+	AActor* Key;
+
+	// Half size of the actor bounds. It is taken once when the actor is registered.
+	FVector Extent;
+
+	// Delegate called when the actor leaves the screen
+	FOnActorOffScreen OnOffScreen;
+};
+
+/**
+ * Actor which checks once per frame whether the registered transient actors have left the screen. The
+ * playfield bounds are calculated once and every actor is tested against them in a single pass, so the actors
+ * don't need to project themselves to the screen on each tick.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AScreenCullingManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AScreenCullingManager();
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the culling manager of the specified world or nullptr if the game mode doesn't provide one
+	static AScreenCullingManager* GetScreenCullingManager(UWorld* World);
+
+	// Registers an actor to be notified when it leaves the screen. The actor stays registered until it is
+	// unregistered or destroyed.
+	void Register(AActor* Actor, FOnActorOffScreen OnOffScreen);
+
+	// Unregisters an actor
+	void Unregister(AActor* Actor);
+
+	// Returns the number of registered actors
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 GetNumRegistered() const;
+
+private:
+
+	// Removes the entry at the given index keeping the index lookup consistent
+	void RemoveAt(int32 Index);
+
+	// Registered actors
+	TArray<FCulledActor> CulledActors;
+
+	// Index of each registered actor in CulledActors
+	TMap<AActor*, int32> ActorIndices;
+
+	// Actors found off screen during the current frame. Kept as a member to avoid allocations on each tick.
+	TArray<int32> OffScreenIndices;
+};
@@ -0,0 +1,56 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "HomingMissileSystem.h"
+#include "SeekerMissileSystem.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogSeekerMissileSystem, Log, All);
+
+/**
+ * Homing missile system whose missiles follow the terrain. The steering samples the distance field of the stage
+ * scenery: without a target the missiles are pulled towards the nearest surface and fly along it at the hug
+ * distance, and with or without a target they are pushed away from the scenery and never move into it. A missile
+ * which touches the scenery explodes.
+ *
+ * Each missile takes a few bilinear lookups per frame instead of traces against the physics scene.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API ASeekerMissileSystem : public AHomingMissileSystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	ASeekerMissileSystem();
+
+	// Returns the seeker missile system of the specified world or nullptr if the game mode doesn't provide one
+	static ASeekerMissileSystem* GetSeekerMissileSystem(UWorld* World);
+
+	// Distance to the scenery at which the missiles fly along it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float HugDistance;
+
+	// Distance to the scenery within which the missiles without a target are pulled towards it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float HugReach;
+
+	// Strength of the push away from the scenery when a missile is closer than the hug distance
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Missiles, meta = (ClampMin = "0.0"))
+	float AvoidanceStrength;
+
+protected:
+
+	// Turns the missiles towards their targets around the scenery and moves them
+	virtual void SteerMissiles(float DeltaSeconds, class AEnemySwarm* EnemySwarm) override;
+
+	// Damages the enemies hit by the missiles and explodes the missiles which touch the scenery
+	virtual void HitEnemies(class AEnemySwarm* EnemySwarm) override;
+
+private:
+
+	// Returns the distance field of the stage scenery or nullptr if it wasn't built
+	class UStageDistanceField* GetDistanceField() const;
+};
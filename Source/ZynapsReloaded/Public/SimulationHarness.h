@@ -0,0 +1,108 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "SimulationHarness.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogSimulationHarness, Log, All);
+
+// Default number of ticks simulated before quitting
+const int32 DefaultSimulationTicks = 3600;
+
+// Default simulation rate in ticks per second
+const float DefaultSimulationRate = 60.0f;
+
+/**
+ * Struct which stores a keyframe of the scripted input. The input mask is held from its tick until the next
+ * keyframe.
+ */
+struct FSimulationInputKey
+{
+	// Tick in which the input mask starts
+	int32 Tick;
+
+	// Mask of held buttons (see EZynapsInputBits)
+	uint8 InputMask;
+};
+
+/**
+ * Actor which runs the stage as a headless deterministic simulation. It is spawned by the stage game mode when
+ * the game is started with -ZynapsSim, e.g.:
+ *
+ *   UE4Editor ZynapsReloaded Stage_1 -game -nullrhi -nosound -ZynapsSim -SimTicks=7200 -SimInput=Run.txt
+ *
+ * Options:
+ *   -SimTicks=N       Number of ticks to simulate before quitting
+ *   -SimRate=R        Fixed ticks per second. Time advances by 1/R per tick regardless of the wall clock, so the
+ *                     simulation runs as fast as the machine allows.
+ *   -SimSeed=S        Seed of the random streams
+ *   -SimInput=File    Scripted input. Each line holds a tick and the input mask held from that tick, e.g.
+ *                     "120 0x18" for right and fire. Lines starting with # are ignored.
+ *   -SimHashes=File   Output file with the state hash of each tick
+ *
+ * Nothing in the simulation needs the renderer: the playfield bounds come from the camera view and the
+ * culling and collision managers don't project anything to the screen.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API ASimulationHarness : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	ASimulationHarness();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns true if the command line asks for a simulation run
+	static bool IsSimulationRequested();
+
+	// Returns the hash of the gameplay state
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 CalculateStateHash() const;
+
+private:
+
+	// Loads the scripted input. Returns false on error.
+	bool LoadInputScript(const FString& FileName);
+
+	// Returns the input mask for the current tick
+	uint8 GetScriptedInput();
+
+	// Makes sure the player's movement runs after the input is injected
+	void AddTickPrerequisites();
+
+	// Writes the hashes, logs the cost of the run and quits
+	void FinishSimulation();
+
+	// Number of ticks to simulate
+	int32 NumTicks;
+
+	// Current tick
+	int32 CurrentTick;
+
+	// Scripted input keyframes sorted by tick
+	TArray<FSimulationInputKey> InputKeys;
+
+	// Index of the current input keyframe
+	int32 InputCursor;
+
+	// Output file of the state hashes
+	FString HashesFileName;
+
+	// One line per tick with its state hash
+	FString HashesLog;
+
+	// Wall clock time in which the simulation started
+	double StartTime;
+
+	// Pawn whose movement already depends on the harness
+	TWeakObjectPtr<APawn> PrerequisitePawn;
+};
@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Default size of the cells of the spatial hash grid, in world units
+const float DefaultSpatialHashCellSize = 200.0f;
+
+// Default number of buckets of the spatial hash grid. It must be a power of two.
+const int32 DefaultSpatialHashNumBuckets = 256;
+
+/**
+ * Uniform grid hashed into a fixed number of buckets, used as a broadphase in the gameplay plane. Locations
+ * are 2D points where X is the world Y coordinate (horizontal scroll) and Y is the world Z coordinate.
+ *
+ * Items are identified by a dense index chosen by the caller, e.g. the position of the item in an array. The
+ * grid is meant to be rebuilt every frame: Reset() keeps the memory of the buckets, so it doesn't allocate once
+ * it has warmed up. Since the cells are hashed, the memory doesn't grow as the camera scrolls through the
+ * stage, and different cells sharing a bucket only produce extra candidates for the narrowphase.
+ */
+class ZYNAPSRELOADED_API FSpatialHashGrid
+{
+public:
+
+	// Creates a grid with the given cell size and number of buckets
+	FSpatialHashGrid(float InCellSize = DefaultSpatialHashCellSize,
+		int32 InNumBuckets = DefaultSpatialHashNumBuckets);
+
+	// Changes the cell size. It removes all the items.
+	void SetCellSize(float InCellSize);
+
+	// Returns the cell size
+	float GetCellSize() const;
+
+	// Removes all the items keeping the allocated memory
+	void Reset();
+
+	// Adds an item covering the given bounds
+	void Insert(int32 Item, const FBox2D& Bounds);
+
+	// Adds an item covering a circle
+	void Insert(int32 Item, const FVector2D& Center, float Radius);
+
+	// Appends to the output array the items whose cells overlap the given bounds. Each item is returned once.
+	void Query(const FBox2D& Bounds, TArray<int32>& OutItems) const;
+
+	// Appends to the output array the items whose cells overlap a circle. Each item is returned once.
+	void Query(const FVector2D& Center, float Radius, TArray<int32>& OutItems) const;
+
+	// Returns the number of items inserted since the last reset
+	int32 GetNumItems() const;
+
+private:
+
+	// Returns the cell containing a location
+	FIntPoint GetCell(const FVector2D& Location) const;
+
+	// Returns the bucket of a cell
+	int32 GetBucket(int32 CellX, int32 CellY) const;
+
+	// Size of the cells
+	float CellSize;
+
+	// Inverse of the cell size, to avoid divisions
+	float InvCellSize;
+
+	// Mask used to wrap the hash into the buckets
+	int32 BucketMask;
+
+	// Items by bucket
+	TArray<TArray<int32>> Buckets;
+
+	// Buckets holding any item, so only those need to be cleared on reset
+	TArray<int32> UsedBuckets;
+
+	// Number of items inserted since the last reset
+	int32 NumItems;
+
+	// Query stamp of each item, used to return every item once when it covers several cells
+	mutable TArray<uint32> ItemStamps;
+
+	// Stamp of the current query
+	mutable uint32 QueryStamp;
+};
@@ -0,0 +1,22 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "StageAssetManifest.generated.h"
+
+/**
+ * List of the assets a stage needs while playing. They are referenced softly, so nothing is loaded with the
+ * manifest itself; the stage asset preloader streams them in asynchronously while the stage is preparing.
+ */
+UCLASS(BlueprintType)
+class ZYNAPSRELOADED_API UStageAssetManifest : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	// Assets to be loaded before the stage starts
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Stage)
+	TArray<FSoftObjectPath> Assets;
+};
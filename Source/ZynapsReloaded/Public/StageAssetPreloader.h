@@ -0,0 +1,94 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Engine/StreamableManager.h"
+#include "StageAssetManifest.h"
+#include "StageAssetPreloader.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogStageAssetPreloader, Log, All);
+
+// Delegate called when all the requested assets are loaded
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnStageAssetsLoaded);
+
+/**
+ * Actor which streams in the assets of the stage asynchronously. The assets are gathered from the stage asset
+ * manifest and from the actors which reference them softly, and their load starts when the stage enters the
+ * Preparing state, so the level transition doesn't wait for them. The loaded assets are kept in memory until the
+ * stage ends.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AStageAssetPreloader : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AStageAssetPreloader();
+
+	// Returns the asset preloader of the specified world or nullptr if the game mode doesn't provide one
+	static AStageAssetPreloader* GetStageAssetPreloader(UWorld* World);
+
+	// Requests the given assets and calls the delegate once they are loaded. Without a preloader in the world the
+	// assets are loaded synchronously.
+	static void RequestAssets(UWorld* World, const TArray<FSoftObjectPath>& Assets, FSimpleDelegate OnLoaded);
+
+	// Adds assets to be loaded. Assets added once the preload has started are loaded right away.
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void AddAssets(const TArray<FSoftObjectPath>& Assets);
+
+	// Adds the assets of a manifest to be loaded
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void AddManifest(const UStageAssetManifest* Manifest);
+
+	// Starts loading the assets added so far
+	UFUNCTION(BlueprintCallable, Category = ZynapsActions)
+	void StartPreload();
+
+	// Returns whether the preload has started and all the requested assets are loaded
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	bool IsPreloadComplete() const;
+
+	// Returns the fraction between 0 and 1 of the requested assets which are loaded
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	float GetPreloadProgress() const;
+
+	// Calls the delegate once all the requested assets are loaded, or right away if they already are
+	void CallWhenLoaded(FSimpleDelegate OnLoaded);
+
+	// Called when all the requested assets are loaded
+	UPROPERTY(BlueprintAssignable, Category = ZynapsEvents)
+	FOnStageAssetsLoaded OnStageAssetsLoaded;
+
+private:
+
+	// Requests the async load of the pending assets
+	void RequestPendingAssets();
+
+	// Called when a batch of assets is loaded
+	void BatchLoaded();
+
+	// Loader of the soft references
+	FStreamableManager StreamableManager;
+
+	// Handles of the requested batches. They keep the loaded assets in memory.
+	TArray<TSharedPtr<FStreamableHandle>> Handles;
+
+	// Assets added and not requested yet
+	TArray<FSoftObjectPath> PendingAssets;
+
+	// Assets already added, to skip the duplicates
+	TSet<FSoftObjectPath> AddedAssets;
+
+	// Delegates waiting for the assets to be loaded
+	TArray<FSimpleDelegate> LoadedCallbacks;
+
+	// Flag which indicates that the preload has started
+	bool bPreloadStarted;
+
+	// Time at which the preload started
+	double PreloadStartTime;
+};
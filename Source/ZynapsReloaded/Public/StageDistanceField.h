@@ -0,0 +1,89 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "UObject/NoExportTypes.h"
+#include "StageDistanceField.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogStageDistanceField, Log, All);
+
+// Default size of the cells of the distance field, in world units
+const float DefaultDistanceFieldCellSize = 50.0f;
+
+/**
+ * Signed distance field of the stage scenery in the gameplay plane. It is a uniform grid over the YZ plane where
+ * each cell stores the distance from its center to the nearest scenery surface: positive in free space and
+ * negative inside the scenery. It is built once when the stage is loaded, from the baked terrain map of the
+ * stage or else by rasterizing the static collision which crosses the gameplay plane, and running a distance
+ * transform. It is sampled with bilinear lookups, so the gameplay systems can follow or avoid the terrain
+ * without tracing against the physics scene.
+ *
+ * Locations are 2D points where X is the world Y coordinate and Y is the world Z coordinate.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API UStageDistanceField : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Default constructor
+	UStageDistanceField();
+
+	// Builds the field from the static scenery of the world which crosses the gameplay plane. Returns false if
+	// there is no scenery.
+	bool Build(UWorld* World, float InCellSize = DefaultDistanceFieldCellSize);
+
+	// Builds the field from the baked terrain map of the stage, without probing the physics scene. Returns false
+	// if the map is not baked.
+	bool Build(const class UStageTerrainMap* TerrainMap);
+
+	// Returns whether the field has been built
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	bool IsBuilt() const;
+
+	// Returns the signed distance to the scenery at the given location. Locations beyond the field take the
+	// distance of its nearest border. Without a field, every location is far from the scenery.
+	float Sample(const FVector2D& Location) const;
+
+	// Returns the gradient of the distance at the given location, which points away from the nearest surface
+	FVector2D SampleGradient(const FVector2D& Location) const;
+
+	// Marches a circle of the given radius along a segment until it touches the scenery. Returns whether it
+	// does, with the fraction of the segment at which it happens.
+	bool SweepSegment(const FVector2D& Start, const FVector2D& End, float Radius, float& OutFraction) const;
+
+	// Returns the size of the cells
+	float GetCellSize() const;
+
+private:
+
+	// Computes the signed distance of each cell from the occupancy of the cells
+	void ComputeSignedDistances(const TArray<bool>& Occupied);
+
+	// Returns the distance from each cell to the nearest cell whose occupancy matches the given one, using a two
+	// pass chamfer transform
+	void ComputeDistances(const TArray<bool>& Occupied, bool bToOccupied, TArray<float>& OutDistances) const;
+
+	// Returns the stored distance of a cell clamping its coordinates to the field
+	float GetCellDistance(int32 CellY, int32 CellZ) const;
+
+	// Signed distance of each cell, stored by rows of constant Z
+	TArray<float> Distances;
+
+	// Location of the center of the first cell
+	FVector2D Origin;
+
+	// Size of the cells
+	float CellSize;
+
+	// Inverse of the cell size, to avoid divisions
+	float InvCellSize;
+
+	// Number of cells along the Y axis
+	int32 NumCellsY;
+
+	// Number of cells along the Z axis
+	int32 NumCellsZ;
+};
@@ -5,6 +5,22 @@
 #include "GameFramework/GameModeBase.h"
 #include "PlayerPawn.h"
 #include "ZynapsCameraManager.h"
+#include "ProjectilePool.h"
+#include "ScreenCullingManager.h"
+#include "CollisionManager.h"
+#include "GameplayAudioManager.h"
+#include "EffectsPool.h"
+#include "StageAssetPreloader.h"
+#include "StageStreamingManager.h"
+#include "GarbageCollectionScheduler.h"
+#include "EnemySwarm.h"
+#include "HomingMissileSystem.h"
+#include "SeekerMissileSystem.h"
+#include "PlasmaBombSystem.h"
+#include "LaserBeamSystem.h"
+#include "StageDistanceField.h"
+#include "SimulationHarness.h"
+#include "CheckpointIndex.h"
 #include "StageGameMode.generated.h"
 
 // Log category
@@ -19,6 +35,9 @@ const float PreparingDelay = 2.5f;
 // Game over delay
 const float GameOverDelay = 4.0f;
 
+// Interval between checks of the stage chunks around the camera before playing
+const float StreamingWaitInterval = 0.1f;
+
 /**
  * GameMode for a regular stage in the game.
  */
@@ -32,21 +51,93 @@ public:
 	// Sets default values for the GameMode
 	AStageGameMode(const FObjectInitializer& ObjectInitializer);
 
+	// Called before the components of the game mode are initialized
+	virtual void PreInitializeComponents() override;
+
 	// Called when the game starts
 	virtual void BeginPlay() override;
-	
-	// Called every frame
-	virtual void Tick(float DeltaSeconds) override;
 
 	// Implementation which returns the StageInit player start
 	AActor* ChoosePlayerStart_Implementation(AController* Controller) override;
 
+	// Returns the pool used to reuse the player projectiles
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AProjectilePool* GetProjectilePool() const;
+
+	// Returns the manager which checks whether transient actors have left the screen
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AScreenCullingManager* GetScreenCullingManager() const;
+
+	// Returns the manager which detects the overlaps between the gameplay actors
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	ACollisionManager* GetCollisionManager() const;
+
+	// Returns the manager which plays the gameplay sounds through pre-allocated voices
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AGameplayAudioManager* GetGameplayAudioManager() const;
+
+	// Returns the pool used to reuse the particle systems of the one-shot effects
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AEffectsPool* GetEffectsPool() const;
+
+	// Returns the preloader which streams in the assets of the stage
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AStageAssetPreloader* GetStageAssetPreloader() const;
+
+	// Returns the manager which streams the chunks of the stage as the camera scrolls
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AStageStreamingManager* GetStageStreamingManager() const;
+
+	// Returns the scheduler which keeps the garbage collection out of the action
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AGarbageCollectionScheduler* GetGarbageCollectionScheduler() const;
+
+	// Returns the system which simulates and draws the enemies
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AEnemySwarm* GetEnemySwarm() const;
+
+	// Returns the system which simulates and draws the homing missiles
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	AHomingMissileSystem* GetHomingMissileSystem() const;
+
+	// Returns the system which simulates and draws the seeker missiles
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	ASeekerMissileSystem* GetSeekerMissileSystem() const;
+
+	// Returns the system which simulates and draws the plasma bombs
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	APlasmaBombSystem* GetPlasmaBombSystem() const;
+
+	// Returns the system which simulates and draws the laser beams
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	ALaserBeamSystem* GetLaserBeamSystem() const;
+
+	// Returns the distance field of the stage scenery
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	UStageDistanceField* GetStageDistanceField() const;
+
+	// Returns the index which tracks the checkpoint reached by the camera
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	UCheckpointIndex* GetCheckpointIndex() const;
+
+	// The type of enemy swarm spawned for the stage. Blueprints of the swarm set the enemy assets.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Classes)
+	TSubclassOf<AEnemySwarm> EnemySwarmClass;
+
 protected:
 
-	// Called from Tick() to evaluate the player start to be used when the player is respawned
+	// Called before respawning the player to evaluate the player start to be used
 	UFUNCTION(BlueprintCallable, meta = (BlueprintProtected), Category = ZynapsState)
 	APlayerStart* EvaluatePlayerStartSpot();
 
+	// Called when the stage state changes
+	UFUNCTION(BlueprintCallable, meta = (BlueprintProtected), Category = ZynapsEvents)
+	void StageStateChanged(EStageState PreviousState, EStageState NewState);
+
+	// Called when the player state changes
+	UFUNCTION(BlueprintCallable, meta = (BlueprintProtected), Category = ZynapsEvents)
+	void PlayerStateChanged(EPlayerState PreviousState, EPlayerState NewState);
+
 	// Handles the Preparing state
 	UFUNCTION(BlueprintCallable, meta = (BlueprintProtected), Category = ZynapsState)
 	void HandlePreparingState(AZynapsGameState* ZynapsGameState, AZynapsPlayerState* ZynapsPlayerState,
@@ -108,4 +199,68 @@ private:
 	// Player start which marks the stage init
 	APlayerStart* StageInitPlayerStart;
 
+	// Pool of player projectiles
+	UPROPERTY()  // Needed to ensure garbage collection
+	AProjectilePool* ProjectilePool;
+
+	// Off-screen culling manager
+	UPROPERTY()  // Needed to ensure garbage collection
+	AScreenCullingManager* ScreenCullingManager;
+
+	// Collision manager
+	UPROPERTY()  // Needed to ensure garbage collection
+	ACollisionManager* CollisionManager;
+
+	// Manager of the gameplay sounds
+	UPROPERTY()  // Needed to ensure garbage collection
+	AGameplayAudioManager* GameplayAudioManager;
+
+	// Pool of particle systems
+	UPROPERTY()  // Needed to ensure garbage collection
+	AEffectsPool* EffectsPool;
+
+	// Preloader of the stage assets
+	UPROPERTY()  // Needed to ensure garbage collection
+	AStageAssetPreloader* StageAssetPreloader;
+
+	// Streaming manager of the stage chunks
+	UPROPERTY()  // Needed to ensure garbage collection
+	AStageStreamingManager* StageStreamingManager;
+
+	// Garbage collection scheduler
+	UPROPERTY()  // Needed to ensure garbage collection
+	AGarbageCollectionScheduler* GarbageCollectionScheduler;
+
+	// Enemy swarm
+	UPROPERTY()  // Needed to ensure garbage collection
+	AEnemySwarm* EnemySwarm;
+
+	// Homing missile system
+	UPROPERTY()  // Needed to ensure garbage collection
+	AHomingMissileSystem* HomingMissileSystem;
+
+	// Seeker missile system
+	UPROPERTY()  // Needed to ensure garbage collection
+	ASeekerMissileSystem* SeekerMissileSystem;
+
+	// Plasma bomb system
+	UPROPERTY()  // Needed to ensure garbage collection
+	APlasmaBombSystem* PlasmaBombSystem;
+
+	// Laser beam system
+	UPROPERTY()  // Needed to ensure garbage collection
+	ALaserBeamSystem* LaserBeamSystem;
+
+	// Headless simulation harness. Only spawned when the command line asks for a simulation run.
+	UPROPERTY()  // Needed to ensure garbage collection
+	ASimulationHarness* SimulationHarness;
+
+	// Index of the player starts used as checkpoints
+	UPROPERTY()  // Needed to ensure garbage collection
+	UCheckpointIndex* CheckpointIndex;
+
+	// Distance field of the stage scenery
+	UPROPERTY()  // Needed to ensure garbage collection
+	UStageDistanceField* StageDistanceField;
+
 };
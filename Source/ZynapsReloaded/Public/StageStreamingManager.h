@@ -0,0 +1,98 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "StageStreamingManager.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogStageStreamingManager, Log, All);
+
+/**
+ * Struct which describes a chunk of a stage: a streaming sublevel and the horizontal span it covers.
+ */
+USTRUCT(BlueprintType)
+struct FStageStreamingChunk
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Name of the streaming sublevel, as listed in the levels of the persistent level
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Streaming)
+	FName LevelName;
+
+	// Lowest Y coordinate covered by the chunk
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Streaming)
+	float MinY;
+
+	// Highest Y coordinate covered by the chunk
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Streaming)
+	float MaxY;
+
+	// Default constructor
+	FStageStreamingChunk()
+	{
+		LevelName = NAME_None;
+		MinY = MaxY = 0.0f;
+	}
+};
+
+/**
+ * Actor which streams the chunks of a stage in and out as the camera scrolls. The chunks are loaded ahead of the
+ * camera by the distance scrolled during the lead time, and unloaded once they are left behind by more than the
+ * unload margin, so a stage can be arbitrarily long while only a few chunks are kept in memory. The chunks and
+ * the streaming distances are set in the world settings.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API AStageStreamingManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values
+	AStageStreamingManager();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Returns the streaming manager of the specified world or nullptr if the game mode doesn't provide one
+	static AStageStreamingManager* GetStageStreamingManager(UWorld* World);
+
+	// Returns whether all the chunks within the viewport are loaded and visible
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	bool IsViewportAreaReady() const;
+
+	// Returns the number of chunks currently requested to be loaded
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	int32 GetNumLoadedChunks() const;
+
+private:
+
+	// Requests the load or the unload of a chunk
+	void StreamChunk(int32 Index, bool bLoad);
+
+	// Called when a chunk finishes loading or unloading
+	UFUNCTION()
+	void ChunkStreamed();
+
+	// Returns whether a chunk is loaded and visible
+	bool IsChunkVisible(int32 Index) const;
+
+	// Chunks of the stage sorted by their Y coordinate
+	TArray<FStageStreamingChunk> Chunks;
+
+	// Whether each chunk is requested to be loaded
+	TArray<bool> ChunkLoadRequested;
+
+	// Left edge of the viewport in the last update
+	float ViewMinY;
+
+	// Right edge of the viewport in the last update
+	float ViewMaxY;
+
+	// Identifier of the next latent streaming request
+	int32 NextRequestId;
+};
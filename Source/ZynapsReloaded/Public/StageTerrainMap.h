@@ -0,0 +1,113 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "StageTerrainMap.generated.h"
+
+// Log category
+DECLARE_LOG_CATEGORY_EXTERN(LogStageTerrainMap, Log, All);
+
+// Default size of the cells of the terrain map, in world units
+const float DefaultTerrainMapCellSize = 25.0f;
+
+// Maximum number of cells of a rasterized stage. The cell size is increased if the stage needs more.
+const int32 MaxTerrainCells = 4 * 1024 * 1024;
+
+// Half of the depth of the slab around the gameplay plane which is considered scenery
+const float TerrainProbeHalfDepth = 10.0f;
+
+// Number of cells along each side of the square tiles of the terrain map
+const int32 TerrainTileSize = 8;
+
+/**
+ * Collision map of the stage scenery in the gameplay plane, baked in the editor and saved as an asset referenced
+ * by the world settings of the stage. It is a bitmap over the YZ plane packed in square tiles of 8x8 cells, each
+ * tile a single 64 bit word, so the queries of a small shape only read a few words and the whole map loads as a
+ * flat array.
+ *
+ * Locations are 2D points where X is the world Y coordinate and Y is the world Z coordinate.
+ */
+UCLASS(BlueprintType)
+class ZYNAPSRELOADED_API UStageTerrainMap : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	// Default constructor
+	UStageTerrainMap();
+
+	// Returns the terrain map of the specified world or nullptr if its stage has no baked map
+	static UStageTerrainMap* GetStageTerrainMap(UWorld* World);
+
+	// Rasterizes the static scenery of the world which crosses the gameplay plane into a grid with a margin of
+	// free cells. The cell size is increased if the stage is too large. Returns false if there is no scenery.
+	static bool RasterizeScenery(UWorld* World, float& InOutCellSize, FVector2D& OutOrigin, int32& OutNumCellsY,
+		int32& OutNumCellsZ, TArray<bool>& OutOccupied);
+
+#if WITH_EDITOR
+	// Bakes the map from the static scenery of the world. Returns false if there is no scenery.
+	bool Bake(UWorld* World, float InCellSize = DefaultTerrainMapCellSize);
+#endif
+
+	// Returns whether the map has been baked
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	bool IsBaked() const;
+
+	// Returns whether a location is inside the scenery
+	UFUNCTION(BlueprintPure, Category = ZynapsState)
+	bool IsBlocked(const FVector2D& Location) const;
+
+	// Returns whether a box overlaps the scenery
+	bool OverlapsBox(const FBox2D& Box) const;
+
+	// Returns whether a capsule, given by its segment and radius, overlaps the scenery. A circle is a capsule
+	// whose segment has the same start and end. The cells are taken as circles of their inscribed radius.
+	bool OverlapsCapsule(const FVector2D& SegmentStart, const FVector2D& SegmentEnd, float Radius) const;
+
+	// Returns whether a cell is inside the scenery. The cells beyond the map are free.
+	bool IsCellBlocked(int32 CellY, int32 CellZ) const;
+
+	// Returns the location of the corner of the first cell, with the lowest coordinates
+	FVector2D GetOrigin() const;
+
+	// Returns the size of the cells
+	float GetCellSize() const;
+
+	// Returns the number of cells along the Y axis
+	int32 GetNumCellsY() const;
+
+	// Returns the number of cells along the Z axis
+	int32 GetNumCellsZ() const;
+
+private:
+
+	// Returns the range of cells which covers a box, clamped to the map. Returns false if it is outside the map.
+	bool GetCellRange(const FBox2D& Box, int32& OutMinY, int32& OutMinZ, int32& OutMaxY, int32& OutMaxZ) const;
+
+	// Bits of the cells, packed in tiles of 8x8 cells stored by rows of constant Z. The bit of a cell within its
+	// tile is its row times 8 plus its column.
+	UPROPERTY(VisibleAnywhere, Category = Terrain)
+	TArray<uint64> Tiles;
+
+	// Location of the corner of the first cell, with the lowest coordinates
+	UPROPERTY(VisibleAnywhere, Category = Terrain)
+	FVector2D Origin;
+
+	// Size of the cells
+	UPROPERTY(VisibleAnywhere, Category = Terrain)
+	float CellSize;
+
+	// Number of cells along the Y axis
+	UPROPERTY(VisibleAnywhere, Category = Terrain)
+	int32 NumCellsY;
+
+	// Number of cells along the Z axis
+	UPROPERTY(VisibleAnywhere, Category = Terrain)
+	int32 NumCellsZ;
+
+	// Number of tiles along the Y axis
+	UPROPERTY(VisibleAnywhere, Category = Terrain)
+	int32 NumTilesY;
+};
@@ -4,6 +4,7 @@
 
 #include "Camera/PlayerCameraManager.h"
 #include "ZynapsGameState.h"
+#include "ProjectionUtil.h"
 #include "ZynapsCameraManager.generated.h"
 
 // Log category
@@ -30,8 +31,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Camera)
 	void SetCameraLocationWithOffset(FVector Location);
 
+	// Returns the cache of the viewport bounds for this camera
+	FViewportBoundsCache& GetViewportBoundsCache();
+
 private:
 
+	// Viewport bounds calculated for the last camera view
+	FViewportBoundsCache ViewportBoundsCache;
+
 	// Returns the game state
 	AZynapsGameState* GetZynapsGameState() const;
 };
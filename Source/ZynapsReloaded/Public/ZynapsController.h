@@ -4,13 +4,43 @@
 
 #include "GameFramework/PlayerController.h"
 #include "PlayerPawn.h"
+#include "InputRecording.h"
+#include "InputTiming.h"
 #include "ZynapsController.generated.h"
 
 // Log category
 DECLARE_LOG_CATEGORY_EXTERN(LogZynapsController, Log, All);
 
 // Time to activate the power-up activation mode
-const double PowerUpActivationModeTime = 0.25;  // A quarter of second
+const double PowerUpActivationModeTime = 0.25;  // A quarter of second of game time
+
+// Tick rate forced while recording if the engine isn't using a fixed time step
+const float DefaultRecordingTickRate = 60.0f;
+
+/**
+ * Bits of the input masks injected into the controller. Each bit is a button held down.
+ */
+enum EZynapsInputBits : uint8
+{
+	ZynapsInput_Up = 1 << 0,
+	ZynapsInput_Down = 1 << 1,
+	ZynapsInput_Left = 1 << 2,
+	ZynapsInput_Right = 1 << 3,
+	ZynapsInput_Fire = 1 << 4
+};
+
+/**
+ * Enum defining what the controller does with the input recording.
+ */
+enum class EInputRecordingMode : uint8
+{
+	// The input is neither recorded nor replayed
+	None = 0,
+	// The input of each tick is recorded
+	Recording = 1,
+	// The input comes from a recording
+	Replaying = 2
+};
 
 /**
  * The default Player Controller used by StageGameMode.
@@ -28,11 +58,38 @@ public:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	// Called when the controller is removed from the level
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
 
+	// Processes the player input. It also records or replays the input.
+	virtual void PlayerTick(float DeltaTime) override;
+
 	// Returns true if the player has more lives available. false otherwise.
 	virtual bool CanRestartPlayer() override;
+
+	// Feeds a mask of held buttons (see EZynapsInputBits) through the same handlers as the player input. The
+	// fire button is pressed or released when its bit changes from the previous mask. The sub-frame alpha places
+	// the presses and releases within the last frame, from 0 (its start) to 1 (the current time).
+	void InjectInput(uint8 InputMask, float SubFrameAlpha = 1.0f);
+
+	// Returns the press and release times of the buttons, in game time
+	const FInputTiming& GetInputTiming() const;
+
+	// Starts recording the input of each tick. The recording is saved when it is stopped or the level ends.
+	UFUNCTION(Exec, BlueprintCallable, Category = ZynapsActions)
+	void ZynapsRecordInput(const FString& Name);
+
+	// Replays a recording through the same handlers as the player input. The player input is ignored until the
+	// recording ends or it is stopped.
+	UFUNCTION(Exec, BlueprintCallable, Category = ZynapsActions)
+	void ZynapsReplayInput(const FString& Name);
+
+	// Stops recording or replaying the input
+	UFUNCTION(Exec, BlueprintCallable, Category = ZynapsActions)
+	void ZynapsStopInput();
 	
 protected:
 
@@ -78,6 +135,48 @@ private:
 	// Returns the player state
 	AZynapsPlayerState* GetZynapsPlayerState() const;
 
-	// Time in which the fire button was pressed
-	double FirePressedTime;
+	// Returns the game time of the input being handled
+	double GetInputTime() const;
+
+	// Uses a fixed time step of the given tick rate, saving the previous time step settings to restore them later
+	void LockTimeStep(float TickRate);
+
+	// Restores the time step settings saved when the time step was locked
+	void RestoreTimeStep();
+
+	// Press and release times of the buttons
+	FInputTiming InputTiming;
+
+	// Position within the frame of the input being injected
+	float InputSubFrameAlpha;
+
+	// Mask of the buttons held during the current tick (see EZynapsInputBits)
+	uint8 CurrentInputMask;
+
+	// What is being done with the input recording
+	EInputRecordingMode InputRecordingMode;
+
+	// Recording being saved or replayed
+	FInputRecording InputRecording;
+
+	// File of the recording being saved
+	FString InputRecordingFileName;
+
+	// Tick being replayed
+	uint32 ReplayTick;
+
+	// Position of the replay in the recording
+	int32 ReplayCursor;
+
+	// Whether the time step is locked by the recording or the replay
+	bool bTimeStepLocked;
+
+	// Whether the engine used a fixed time step before it was locked
+	bool bSavedUseFixedTimeStep;
+
+	// Fixed delta time of the engine before the time step was locked
+	double SavedFixedDeltaTime;
+
+	// Handle of the delegate which draws the performance overlay
+	FDelegateHandle PerformanceOverlayHandle;
 };
@@ -19,6 +19,9 @@ enum class EStageState : uint8
 	GameOver = 2
 };
 
+// Delegate called when the stage state changes
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStageStateChanged, EStageState, PreviousState, EStageState, NewState);
+
 /**
  * Class which manages the state during a stage game mode.
  */
@@ -40,6 +43,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = ZynapsState)
 	void SetCurrentState(EStageState State);
 
+	// Called when the stage state changes
+	UPROPERTY(BlueprintAssignable, Category = ZynapsEvents)
+	FOnStageStateChanged OnStageStateChanged;
+
 private:
 
 	// Current game state
@@ -34,6 +34,9 @@ enum class EPlayerState : uint8
 	Destroyed = 1
 };
 
+// Delegate called when the player state changes
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPlayerStateChanged, EPlayerState, PreviousState, EPlayerState, NewState);
+
 /**
  * This class stores the player's state information.
  */
@@ -55,6 +58,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = ZynapsState)
 	void SetCurrentState(EPlayerState State);
 
+	// Called when the player state changes
+	UPROPERTY(BlueprintAssignable, Category = ZynapsEvents)
+	FOnPlayerStateChanged OnPlayerStateChanged;
+
 	// Returns the power-up activation mode
 	UFUNCTION(BlueprintPure, Category = ZynapsState)
 	bool GetPowerUpActivationMode() const;
@@ -0,0 +1,72 @@
+// Copyright (c) 2017 Bytecode Bits
+
+#pragma once
+
+#include "UObject/NoExportTypes.h"
+#include "ZynapsWorldContext.generated.h"
+
+class AZynapsWorldSettings;
+class AZynapsGameState;
+class AZynapsController;
+class AZynapsPlayerState;
+class AZynapsCameraManager;
+class AStageGameMode;
+class APlayerPawn;
+
+/**
+ * Per-world cache of the game framework objects used by the gameplay code. Each object is resolved and cast
+ * once and kept with a weak pointer, so it is resolved again only when it is destroyed or replaced, i.e. when
+ * the player is respawned. The getters check the cached objects on each query, so the cache never needs to be
+ * cleared. A level change creates a new world, which gets its own context.
+ */
+UCLASS()
+class ZYNAPSRELOADED_API UZynapsWorldContext : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	// Returns the context of the specified world or nullptr if the world doesn't use the Zynaps world settings
+	static UZynapsWorldContext* Get(UWorld* World);
+
+	// Returns the world settings
+	AZynapsWorldSettings* GetWorldSettings();
+
+	// Returns the game state
+	AZynapsGameState* GetGameState();
+
+	// Returns the stage game mode. It is only available on the server.
+	AStageGameMode* GetStageGameMode();
+
+	// Returns the player controller
+	AZynapsController* GetController();
+
+	// Returns the player state
+	AZynapsPlayerState* GetPlayerState();
+
+	// Returns the camera manager
+	AZynapsCameraManager* GetCameraManager();
+
+	// Returns the player's pawn
+	APlayerPawn* GetPlayerPawn();
+
+private:
+
+	// Cached game state
+	TWeakObjectPtr<AZynapsGameState> GameState;
+
+	// Cached stage game mode
+	TWeakObjectPtr<AStageGameMode> StageGameMode;
+
+	// Cached player controller
+	TWeakObjectPtr<AZynapsController> Controller;
+
+	// Cached player state
+	TWeakObjectPtr<AZynapsPlayerState> PlayerState;
+
+	// Cached camera manager
+	TWeakObjectPtr<AZynapsCameraManager> CameraManager;
+
+	// Cached player's pawn
+	TWeakObjectPtr<APlayerPawn> PlayerPawn;
+};
@@ -3,6 +3,12 @@
 #pragma once
 
 #include "GameFramework/WorldSettings.h"
+#include "ZynapsWorldContext.h"
+#include "StageAssetManifest.h"
+#include "StageStreamingManager.h"
+#include "EnemySwarm.h"
+#include "StageDistanceField.h"
+#include "StageTerrainMap.h"
 #include "ZynapsWorldSettings.generated.h"
 
 /**
@@ -21,6 +27,9 @@ public:
 	// Returns the world settings for the game for the specified world
 	static AZynapsWorldSettings* GetZynapsWorldSettings(UWorld* World);
 
+	// Returns the cache of the game framework objects of this world
+	UZynapsWorldContext* GetWorldContext();
+
 	// Scroll speed
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Stage)
 	float ScrollSpeed;
@@ -28,5 +37,49 @@ public:
 	// Fixed camera offset which is added to the camera location
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Camera)
 	FVector FixedCameraOffset;
-	
+
+	// Assets loaded asynchronously while the stage is preparing
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Stage)
+	UStageAssetManifest* AssetManifest;
+
+	// Chunks of the stage streamed in and out as the camera scrolls. Empty for a stage in a single level.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Streaming)
+	TArray<FStageStreamingChunk> StreamingChunks;
+
+	// Time ahead of the camera, at the scroll speed, in which the chunks are loaded
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Streaming, meta = (ClampMin = "0.0"))
+	float StreamingLeadTime;
+
+	// Distance beyond the streaming span at which the chunks are unloaded
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Streaming, meta = (ClampMin = "0.0"))
+	float StreamingUnloadMargin;
+
+	// Waves of enemies of the stage
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Enemies)
+	TArray<FEnemyWave> EnemyWaves;
+
+	// Size of the cells of the distance field built when the stage is loaded if it has no terrain map
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Terrain, meta = (ClampMin = "1.0"))
+	float DistanceFieldCellSize;
+
+	// Collision map of the stage scenery. When it is baked, the gameplay tests the terrain against it instead of
+	// the physics scene, so the scenery doesn't need to generate overlaps.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Terrain)
+	UStageTerrainMap* TerrainMap;
+
+	// Size of the cells of the terrain map
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Terrain, meta = (ClampMin = "1.0"))
+	float TerrainMapCellSize;
+
+#if WITH_EDITOR
+	// Bakes the scenery of the stage into the terrain map. The map asset must be saved afterwards.
+	UFUNCTION(CallInEditor, Category = Terrain)
+	void BakeTerrainMap();
+#endif
+
+private:
+
+	// Cache of the game framework objects of this world. It is created on demand.
+	UPROPERTY(Transient)
+	UZynapsWorldContext* WorldContext;
 };
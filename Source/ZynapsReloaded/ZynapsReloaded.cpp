@@ -7,3 +7,26 @@ IMPLEMENT_PRIMARY_GAME_MODULE(FDefaultGameModuleImpl, ZynapsReloaded, "ZynapsRel
 
 // Global log categories
 DEFINE_LOG_CATEGORY(LogZynaps);
+
+// Stats of the gameplay module
+DEFINE_STAT(STAT_ZynapsPlayerMovement);
+DEFINE_STAT(STAT_ZynapsCameraUpdate);
+DEFINE_STAT(STAT_ZynapsViewportBounds);
+DEFINE_STAT(STAT_ZynapsFire);
+DEFINE_STAT(STAT_ZynapsVisibilityChecks);
+DEFINE_STAT(STAT_ZynapsScreenCulling);
+DEFINE_STAT(STAT_ZynapsCollision);
+DEFINE_STAT(STAT_ZynapsAudio);
+DEFINE_STAT(STAT_ZynapsEffects);
+DEFINE_STAT(STAT_ZynapsStreaming);
+DEFINE_STAT(STAT_ZynapsEnemies);
+DEFINE_STAT(STAT_ZynapsMissiles);
+DEFINE_STAT(STAT_ZynapsPlasmaBombs);
+DEFINE_STAT(STAT_ZynapsLaserBeams);
+DEFINE_STAT(STAT_ZynapsLiveProjectiles);
+DEFINE_STAT(STAT_ZynapsLiveFuelCapsules);
+DEFINE_STAT(STAT_ZynapsLiveEnemies);
+DEFINE_STAT(STAT_ZynapsLiveMissiles);
+DEFINE_STAT(STAT_ZynapsSpawns);
+DEFINE_STAT(STAT_ZynapsGCPause);
+DEFINE_STAT(STAT_ZynapsGCWhilePlaying);
@@ -12,3 +12,33 @@
 
 // Global log categories
 DECLARE_LOG_CATEGORY_EXTERN(LogZynaps, Log, All);
+
+// Stat group of the gameplay module, shown with "stat zynaps"
+DECLARE_STATS_GROUP(TEXT("Zynaps"), STATGROUP_Zynaps, STATCAT_Advanced);
+
+// Cycle counters
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Player Movement"), STAT_ZynapsPlayerMovement, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera Update"), STAT_ZynapsCameraUpdate, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Viewport Bounds"), STAT_ZynapsViewportBounds, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fire"), STAT_ZynapsFire, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Visibility Checks"), STAT_ZynapsVisibilityChecks, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Screen Culling"), STAT_ZynapsScreenCulling, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision Detection"), STAT_ZynapsCollision, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gameplay Audio"), STAT_ZynapsAudio, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Effects"), STAT_ZynapsEffects, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Level Streaming"), STAT_ZynapsStreaming, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemies"), STAT_ZynapsEnemies, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Missiles"), STAT_ZynapsMissiles, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Plasma Bombs"), STAT_ZynapsPlasmaBombs, STATGROUP_Zynaps, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Laser Beams"), STAT_ZynapsLaserBeams, STATGROUP_Zynaps, );
+
+// Object counters
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Projectiles"), STAT_ZynapsLiveProjectiles, STATGROUP_Zynaps, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Fuel Capsules"), STAT_ZynapsLiveFuelCapsules, STATGROUP_Zynaps, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Enemies"), STAT_ZynapsLiveEnemies, STATGROUP_Zynaps, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Missiles"), STAT_ZynapsLiveMissiles, STATGROUP_Zynaps, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Actor Spawns"), STAT_ZynapsSpawns, STATGROUP_Zynaps, );
+
+// Garbage collection counters
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Last GC Pause (ms)"), STAT_ZynapsGCPause, STATGROUP_Zynaps, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("GC Passes While Playing"), STAT_ZynapsGCWhilePlaying, STATGROUP_Zynaps, );